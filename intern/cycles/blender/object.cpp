@@ -513,6 +513,7 @@ void BlenderSync::sync_procedural(BL::Object &b_ob,
 
   procedural->set_use_prefetch(cache_file.use_prefetch());
   procedural->set_prefetch_cache_size(cache_file.prefetch_cache_size());
+  procedural->set_prefetch_frames(cache_file.prefetch_frames());
 
   /* create or update existing AlembicObjects */
   ustring object_path = ustring(b_mesh_cache.object_path());
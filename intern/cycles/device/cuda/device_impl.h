@@ -74,6 +74,7 @@ class CUDADevice : public GPUDevice {
 
   void mem_alloc(device_memory &mem) override;
 
+  using GPUDevice::mem_copy_to;
   void mem_copy_to(device_memory &mem) override;
 
   void mem_copy_from(device_memory &mem, size_t y, size_t w, size_t h, size_t elem) override;
@@ -804,6 +804,34 @@ void GPUDevice::generic_copy_to(device_memory &mem)
   }
 }
 
+void GPUDevice::generic_copy_to(device_memory &mem, size_t size, size_t offset)
+{
+  if (!mem.host_pointer || !mem.device_pointer) {
+    return;
+  }
+
+  thread_scoped_lock lock(device_mem_map_mutex);
+  if (!device_mem_map[&mem].use_mapped_host || mem.host_pointer != mem.shared_pointer) {
+    const size_t offset_bytes = mem.memory_elements_size(offset);
+    copy_host_to_device((char *)mem.device_pointer + offset_bytes,
+                        (char *)mem.host_pointer + offset_bytes,
+                        mem.memory_elements_size(size));
+  }
+}
+
+void GPUDevice::mem_copy_to(device_memory &mem, size_t size, size_t offset)
+{
+  /* Only an existing allocation of the same size can be updated in place, anything else needs
+   * the full copy which (re)allocates device memory and updates kernel pointers. Textures are
+   * always fully recreated. */
+  if (mem.type == MEM_TEXTURE || !mem.device_pointer || mem.device_size != mem.memory_size()) {
+    mem_copy_to(mem);
+    return;
+  }
+
+  generic_copy_to(mem, size, offset);
+}
+
 /* DeviceInfo */
 
 CCL_NAMESPACE_END
@@ -313,6 +313,12 @@ class Device {
 
   virtual void mem_alloc(device_memory &mem) = 0;
   virtual void mem_copy_to(device_memory &mem) = 0;
+  /* Copy a range of elements of already allocated memory to the device. Devices that can not
+   * update part of an allocation fall back to copying the entire memory. */
+  virtual void mem_copy_to(device_memory &mem, size_t /*size*/, size_t /*offset*/)
+  {
+    mem_copy_to(mem);
+  }
   virtual void mem_copy_from(device_memory &mem, size_t y, size_t w, size_t h, size_t elem) = 0;
   virtual void mem_zero(device_memory &mem) = 0;
   virtual void mem_free(device_memory &mem) = 0;
@@ -363,6 +369,9 @@ class GPUDevice : public Device {
   /* Memory allocation, only accessed through device_memory. */
   friend class device_memory;
 
+  using Device::mem_copy_to;
+  void mem_copy_to(device_memory &mem, size_t size, size_t offset) override;
+
   bool can_map_host;
   size_t map_host_used;
   size_t map_host_limit;
@@ -395,6 +404,7 @@ class GPUDevice : public Device {
   virtual GPUDevice::Mem *generic_alloc(device_memory &mem, size_t pitch_padding = 0);
   virtual void generic_free(device_memory &mem);
   virtual void generic_copy_to(device_memory &mem);
+  virtual void generic_copy_to(device_memory &mem, size_t size, size_t offset);
 
   /* total - amount of device memory, free - amount of available device memory */
   virtual void get_device_memory_info(size_t &total, size_t &free) = 0;
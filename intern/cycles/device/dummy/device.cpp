@@ -28,6 +28,7 @@ class DummyDevice : public Device {
 
   virtual void mem_alloc(device_memory &) override {}
 
+  using Device::mem_copy_to;
   virtual void mem_copy_to(device_memory &) override {}
 
   virtual void mem_copy_from(device_memory &, size_t, size_t, size_t, size_t) override {}
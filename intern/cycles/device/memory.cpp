@@ -86,6 +86,13 @@ void device_memory::device_copy_to()
   }
 }
 
+void device_memory::device_copy_to(size_t size, size_t offset)
+{
+  if (host_pointer) {
+    device->mem_copy_to(*this, size, offset);
+  }
+}
+
 void device_memory::device_copy_from(size_t y, size_t w, size_t h, size_t elem)
 {
   assert(type != MEM_TEXTURE && type != MEM_READ_ONLY && type != MEM_GLOBAL);
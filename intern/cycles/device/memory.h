@@ -218,7 +218,7 @@ class device_memory {
   {
     return data_size * data_elements * datatype_size(data_type);
   }
-  size_t memory_elements_size(int elements)
+  size_t memory_elements_size(size_t elements)
   {
     return elements * data_elements * datatype_size(data_type);
   }
@@ -282,6 +282,7 @@ class device_memory {
   void device_alloc();
   void device_free();
   void device_copy_to();
+  void device_copy_to(size_t size, size_t offset);
   void device_copy_from(size_t y, size_t w, size_t h, size_t elem);
   void device_zero();
 
@@ -366,6 +367,7 @@ template<typename T> class device_vector : public device_memory {
     data_elements = device_type_traits<T>::num_elements;
     modified = true;
     need_realloc_ = true;
+    tag_modified_all();
 
     assert(data_elements > 0);
   }
@@ -385,6 +387,7 @@ template<typename T> class device_vector : public device_memory {
       host_free();
       host_pointer = host_alloc(sizeof(T) * new_size);
       modified = true;
+      tag_modified_all();
       assert(device_pointer == 0);
     }
 
@@ -464,6 +467,7 @@ template<typename T> class device_vector : public device_memory {
     host_pointer = 0;
     modified = true;
     need_realloc_ = true;
+    tag_modified_all();
     assert(device_pointer == 0);
   }
 
@@ -487,6 +491,26 @@ template<typename T> class device_vector : public device_memory {
   void tag_modified()
   {
     modified = true;
+    tag_modified_all();
+  }
+
+  /* Tag a range of elements as modified, so that only those are copied to the device by
+   * copy_to_device_if_modified(). Ranges tagged before the next copy are merged. */
+  void tag_modified(const size_t offset, const size_t size)
+  {
+    if (size == 0) {
+      return;
+    }
+
+    if (!modified) {
+      modified = true;
+      modified_begin_ = offset;
+      modified_end_ = offset + size;
+    }
+    else {
+      modified_begin_ = (offset < modified_begin_) ? offset : modified_begin_;
+      modified_end_ = (offset + size > modified_end_) ? offset + size : modified_end_;
+    }
   }
 
   void tag_realloc()
@@ -523,19 +547,37 @@ template<typename T> class device_vector : public device_memory {
     }
   }
 
+  void copy_to_device(const size_t size, const size_t offset)
+  {
+    if (size != 0) {
+      assert(offset + size <= data_size);
+      device_copy_to(size, offset);
+    }
+  }
+
   void copy_to_device_if_modified()
   {
     if (!modified) {
       return;
     }
 
-    copy_to_device();
+    if (need_realloc_ || device_pointer == 0 || modified_end_ > data_size) {
+      copy_to_device();
+    }
+    else if (modified_begin_ == 0 && modified_end_ == data_size) {
+      copy_to_device();
+    }
+    else {
+      copy_to_device(modified_end_ - modified_begin_, modified_begin_);
+    }
   }
 
   void clear_modified()
   {
     modified = false;
     need_realloc_ = false;
+    modified_begin_ = 0;
+    modified_end_ = 0;
   }
 
   void copy_from_device()
@@ -566,6 +608,16 @@ template<typename T> class device_vector : public device_memory {
   {
     return width * ((height == 0) ? 1 : height) * ((depth == 0) ? 1 : depth);
   }
+
+  void tag_modified_all()
+  {
+    modified_begin_ = 0;
+    modified_end_ = SIZE_MAX;
+  }
+
+  /* Range of elements to copy on the next copy_to_device_if_modified(). */
+  size_t modified_begin_;
+  size_t modified_end_;
 };
 
 /* Device Sub Memory
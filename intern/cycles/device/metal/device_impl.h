@@ -159,6 +159,7 @@ class MetalDevice : public Device {
 
   void mem_alloc(device_memory &mem) override;
 
+  using Device::mem_copy_to;
   void mem_copy_to(device_memory &mem) override;
 
   void mem_copy_from(device_memory &mem)
@@ -366,6 +366,42 @@ class MultiDevice : public Device {
     stats.mem_alloc(mem.device_size - existing_size);
   }
 
+  void mem_copy_to(device_memory &mem, size_t size, size_t offset) override
+  {
+    device_ptr existing_key = mem.device_pointer;
+    if (!existing_key || mem.type == MEM_TEXTURE) {
+      mem_copy_to(mem);
+      return;
+    }
+
+    size_t existing_size = mem.device_size;
+
+    foreach (const vector<SubDevice *> &island, peer_islands) {
+      SubDevice *owner_sub = find_suitable_mem_device(existing_key, island);
+      device_ptr existing_ptr = owner_sub->ptr_map[existing_key];
+      mem.device = owner_sub->device;
+      mem.device_pointer = existing_ptr;
+      mem.device_size = existing_size;
+
+      owner_sub->device->mem_copy_to(mem, size, offset);
+      owner_sub->ptr_map[existing_key] = mem.device_pointer;
+
+      /* The owner fell back to a full copy that moved the allocation, so the other devices in
+       * the island need to pick up the new pointer. */
+      if (mem.type == MEM_GLOBAL && mem.device_pointer != existing_ptr) {
+        foreach (SubDevice *island_sub, island) {
+          if (island_sub != owner_sub) {
+            island_sub->device->mem_copy_to(mem);
+          }
+        }
+      }
+    }
+
+    mem.device = this;
+    mem.device_pointer = existing_key;
+    stats.mem_alloc(mem.device_size - existing_size);
+  }
+
   void mem_copy_from(device_memory &mem, size_t y, size_t w, size_t h, size_t elem) override
   {
     device_ptr key = mem.device_pointer;
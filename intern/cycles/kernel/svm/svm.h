@@ -303,6 +303,9 @@ ccl_device void svm_eval_nodes(KernelGlobals kg,
       SVM_CASE(NODE_VALUE_V)
       offset = svm_node_value_v(kg, sd, stack, node.y, offset);
       break;
+      SVM_CASE(NODE_VALUE_BLOCK)
+      offset = svm_node_value_block(kg, stack, node.y, offset);
+      break;
       SVM_CASE(NODE_ATTR)
       svm_node_attr<node_feature_mask>(kg, sd, stack, node);
       break;
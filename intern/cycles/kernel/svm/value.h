@@ -32,4 +32,26 @@ ccl_device int svm_node_value_v(KernelGlobals kg,
   return offset;
 }
 
+/* Load a block of constant inputs, each of them being a float or float3 stored in its own node
+ * after the block header. */
+ccl_device int svm_node_value_block(KernelGlobals kg,
+                                    ccl_private float *stack,
+                                    uint num_values,
+                                    int offset)
+{
+  for (uint i = 0; i < num_values; i++) {
+    uint4 node = read_node(kg, &offset);
+    uint out_offset, size;
+    svm_unpack_node_uchar2(node.x, &out_offset, &size);
+
+    stack_store_float(stack, out_offset, __uint_as_float(node.y));
+    if (size == 3) {
+      stack_store_float(stack, out_offset + 1, __uint_as_float(node.z));
+      stack_store_float(stack, out_offset + 2, __uint_as_float(node.w));
+    }
+  }
+
+  return offset;
+}
+
 CCL_NAMESPACE_END
@@ -213,6 +213,35 @@ void CachedData::set_time_sampling(TimeSampling time_sampling)
   }
 }
 
+void CachedData::remove_data_before(double time)
+{
+  curve_first_key.remove_data_before(time);
+  curve_keys.remove_data_before(time);
+  curve_radius.remove_data_before(time);
+  curve_shader.remove_data_before(time);
+  num_ngons.remove_data_before(time);
+  shader.remove_data_before(time);
+  subd_creases_edge.remove_data_before(time);
+  subd_creases_weight.remove_data_before(time);
+  subd_face_corners.remove_data_before(time);
+  subd_num_corners.remove_data_before(time);
+  subd_ptex_offset.remove_data_before(time);
+  subd_smooth.remove_data_before(time);
+  subd_start_corner.remove_data_before(time);
+  subd_vertex_crease_indices.remove_data_before(time);
+  subd_vertex_crease_weights.remove_data_before(time);
+  triangles.remove_data_before(time);
+  uv_loops.remove_data_before(time);
+  vertices.remove_data_before(time);
+  points.remove_data_before(time);
+  radiuses.remove_data_before(time);
+  points_shader.remove_data_before(time);
+
+  for (CachedAttribute &attr : attributes) {
+    attr.data.remove_data_before(time);
+  }
+}
+
 size_t CachedData::memory_used() const
 {
   size_t mem_used = 0;
@@ -455,6 +484,39 @@ bool AlembicObject::has_data_loaded() const
   return data_loaded;
 }
 
+template<typename SchemaData>
+void AlembicObject::load_data_with_reader(CachedData &cached_data,
+                                          AlembicProcedural *proc,
+                                          const SchemaData &data,
+                                          const ICompoundProperty &arb_geom_params,
+                                          const IV2fGeomParam &default_uvs_param,
+                                          Progress &progress)
+{
+  read_data = [data,
+               arb_geom_params,
+               default_uvs_param,
+               requested_attributes = get_requested_attributes()](
+                  CachedData &cache, AlembicProcedural *proc, Progress &progress) {
+    read_geometry_data(proc, cache, data, progress);
+
+    if (progress.get_cancel()) {
+      return;
+    }
+
+    read_attributes(
+        proc, cache, arb_geom_params, default_uvs_param, requested_attributes, progress);
+  };
+
+  read_data(cached_data, proc, progress);
+
+  if (progress.get_cancel()) {
+    return;
+  }
+
+  cached_data.invalidate_last_loaded_time(true);
+  data_loaded = true;
+}
+
 void AlembicObject::load_data_in_cache(CachedData &cached_data,
                                        AlembicProcedural *proc,
                                        IPolyMeshSchema &schema,
@@ -477,23 +539,7 @@ void AlembicObject::load_data_in_cache(CachedData &cached_data,
   data.num_samples = schema.getNumSamples();
   data.shader_face_sets = parse_face_sets_for_shader_assignment(schema, get_used_shaders());
 
-  read_geometry_data(proc, cached_data, data, progress);
-
-  if (progress.get_cancel()) {
-    return;
-  }
-
-  /* Use the schema as the base compound property to also be able to look for top level properties.
-   */
-  read_attributes(
-      proc, cached_data, schema, schema.getUVsParam(), get_requested_attributes(), progress);
-
-  if (progress.get_cancel()) {
-    return;
-  }
-
-  cached_data.invalidate_last_loaded_time(true);
-  data_loaded = true;
+  load_data_with_reader(cached_data, proc, data, schema, schema.getUVsParam(), progress);
 }
 
 void AlembicObject::load_data_in_cache(CachedData &cached_data,
@@ -519,19 +565,7 @@ void AlembicObject::load_data_in_cache(CachedData &cached_data,
     data.velocities = schema.getVelocitiesProperty();
     data.shader_face_sets = parse_face_sets_for_shader_assignment(schema, get_used_shaders());
 
-    read_geometry_data(proc, cached_data, data, progress);
-
-    if (progress.get_cancel()) {
-      return;
-    }
-
-    /* Use the schema as the base compound property to also be able to look for top level
-     * properties. */
-    read_attributes(
-        proc, cached_data, schema, schema.getUVsParam(), get_requested_attributes(), progress);
-
-    cached_data.invalidate_last_loaded_time(true);
-    data_loaded = true;
+    load_data_with_reader(cached_data, proc, data, schema, schema.getUVsParam(), progress);
     return;
   }
 
@@ -555,19 +589,7 @@ void AlembicObject::load_data_in_cache(CachedData &cached_data,
   data.velocities = schema.getVelocitiesProperty();
   data.shader_face_sets = parse_face_sets_for_shader_assignment(schema, get_used_shaders());
 
-  read_geometry_data(proc, cached_data, data, progress);
-
-  if (progress.get_cancel()) {
-    return;
-  }
-
-  /* Use the schema as the base compound property to also be able to look for top level properties.
-   */
-  read_attributes(
-      proc, cached_data, schema, schema.getUVsParam(), get_requested_attributes(), progress);
-
-  cached_data.invalidate_last_loaded_time(true);
-  data_loaded = true;
+  load_data_with_reader(cached_data, proc, data, schema, schema.getUVsParam(), progress);
 }
 
 void AlembicObject::load_data_in_cache(CachedData &cached_data,
@@ -597,19 +619,7 @@ void AlembicObject::load_data_in_cache(CachedData &cached_data,
   data.default_radius = proc->get_default_radius();
   data.radius_scale = get_radius_scale();
 
-  read_geometry_data(proc, cached_data, data, progress);
-
-  if (progress.get_cancel()) {
-    return;
-  }
-
-  /* Use the schema as the base compound property to also be able to look for top level properties.
-   */
-  read_attributes(
-      proc, cached_data, schema, schema.getUVsParam(), get_requested_attributes(), progress);
-
-  cached_data.invalidate_last_loaded_time(true);
-  data_loaded = true;
+  load_data_with_reader(cached_data, proc, data, schema, schema.getUVsParam(), progress);
 }
 
 void AlembicObject::load_data_in_cache(CachedData &cached_data,
@@ -633,18 +643,7 @@ void AlembicObject::load_data_in_cache(CachedData &cached_data,
   data.default_radius = proc->get_default_radius();
   data.radius_scale = get_radius_scale();
 
-  read_geometry_data(proc, cached_data, data, progress);
-
-  if (progress.get_cancel()) {
-    return;
-  }
-
-  /* Use the schema as the base compound property to also be able to look for top level properties.
-   */
-  read_attributes(proc, cached_data, schema, {}, get_requested_attributes(), progress);
-
-  cached_data.invalidate_last_loaded_time(true);
-  data_loaded = true;
+  load_data_with_reader(cached_data, proc, data, schema, IV2fGeomParam(), progress);
 }
 
 void AlembicObject::setup_transform_cache(CachedData &cached_data, float scale)
@@ -780,6 +779,7 @@ NODE_DEFINE(AlembicProcedural)
 
   SOCKET_BOOLEAN(use_prefetch, "Use Prefetch", true);
   SOCKET_INT(prefetch_cache_size, "Prefetch Cache Size", 4096);
+  SOCKET_INT(prefetch_frames, "Prefetch Frames", 0);
 
   return type;
 }
@@ -792,6 +792,11 @@ AlembicProcedural::AlembicProcedural() : Procedural(get_node_type())
 
 AlembicProcedural::~AlembicProcedural()
 {
+  if (prefetch_thread_) {
+    prefetch_progress_.set_cancel("Alembic Procedural deleted");
+    prefetch_thread_->join();
+  }
+
   ccl::set<Geometry *> geometries_set;
   ccl::set<Object *> objects_set;
   ccl::set<AlembicObject *> abc_objects_set;
@@ -866,6 +871,9 @@ void AlembicProcedural::generate(Scene *scene, Progress &progress)
     return;
   }
 
+  /* The caches and the archive are only accessed after the background reading is done. */
+  wait_for_prefetch(frame - frame_offset);
+
   if (!archive.valid() || filepath_is_modified() || layers_is_modified()) {
     Alembic::AbcCoreFactory::IFactory factory;
     factory.setPolicy(Alembic::Abc::ErrorHandler::kQuietNoopPolicy);
@@ -911,13 +919,15 @@ void AlembicProcedural::generate(Scene *scene, Progress &progress)
     }
   }
 
-  if (use_prefetch_is_modified()) {
-    if (!use_prefetch) {
-      for (Node *node : objects) {
-        AlembicObject *object = static_cast<AlembicObject *>(node);
-        object->clear_cache();
-      }
+  if (use_prefetch_is_modified() || prefetch_frames_is_modified()) {
+    /* The caches either hold the current frame, a window of frames or the entire animation. */
+    for (Node *node : objects) {
+      AlembicObject *object = static_cast<AlembicObject *>(node);
+      object->clear_cache();
+      object->data_loaded = false;
     }
+
+    frame_window_valid_ = false;
   }
 
   if (prefetch_cache_size_is_modified()) {
@@ -930,9 +940,51 @@ void AlembicProcedural::generate(Scene *scene, Progress &progress)
     }
 
     if (memory_used > get_prefetch_cache_size_in_bytes()) {
-      progress.set_error("Error: Alembic Procedural memory limit reached");
-      return;
+      if (use_frame_window()) {
+        /* Only keep the current frame, the next ones will be read within the new limit. */
+        frame_window_valid_ = false;
+      }
+      else {
+        progress.set_error("Error: Alembic Procedural memory limit reached");
+        return;
+      }
+    }
+  }
+
+  if (use_frame_window()) {
+    const double window_frame = frame - frame_offset;
+
+    if (!frame_window_valid_ || need_shader_updates || window_frame < frame_window_start_ ||
+        window_frame > frame_window_end_)
+    {
+      /* Reload the caches starting at the current frame. */
+      for (Node *node : objects) {
+        AlembicObject *object = static_cast<AlembicObject *>(node);
+        object->clear_cache();
+        object->data_loaded = false;
+      }
+
+      frame_window_valid_ = true;
+      frame_window_start_ = window_frame;
+      frame_window_end_ = window_frame;
+    }
+    else {
+      /* Evict the frames we already moved past. */
+      for (Node *node : objects) {
+        AlembicObject *object = static_cast<AlembicObject *>(node);
+        object->get_cached_data().remove_data_before(frame_time);
+      }
+
+      frame_window_start_ = window_frame;
     }
+
+    frames_to_read_ = get_frame_range(frame_window_start_, frame_window_end_, false);
+  }
+  else if (use_prefetch) {
+    frames_to_read_ = get_frame_range(start_frame, end_frame, false);
+  }
+  else {
+    frames_to_read_ = get_frame_range(frame, frame, false);
   }
 
   build_caches(progress);
@@ -944,9 +996,9 @@ void AlembicProcedural::generate(Scene *scene, Progress &progress)
       return;
     }
 
-    /* skip constant objects */
+    /* skip constant objects, unless the cache only holds some of the frames */
     if (object->is_constant() && !object->is_modified() && !object->need_shader_update &&
-        !scale_is_modified())
+        !scale_is_modified() && !use_frame_window())
     {
       continue;
     }
@@ -968,9 +1020,124 @@ void AlembicProcedural::generate(Scene *scene, Progress &progress)
     object->clear_modified();
   }
 
+  if (use_frame_window() && !progress.get_cancel() && !progress.get_error()) {
+    start_prefetch();
+  }
+
   clear_modified();
 }
 
+AlembicProcedural::FrameRange AlembicProcedural::get_frame_range(double first_frame,
+                                                                 double last_frame,
+                                                                 bool append) const
+{
+  const double fps = static_cast<double>(frame_rate);
+
+  FrameRange range;
+  range.start_time = first_frame / fps;
+  range.end_time = (last_frame + 1.0) / fps;
+  range.append = append;
+  return range;
+}
+
+void AlembicProcedural::wait_for_prefetch(double window_frame)
+{
+  if (!prefetch_thread_) {
+    return;
+  }
+
+  /* No need to keep reading if we are going to reload the caches anyway. */
+  if (window_frame < frame_window_start_ || window_frame > prefetch_end_frame_) {
+    prefetch_progress_.set_cancel("Alembic Procedural frame out of prefetched range");
+  }
+
+  prefetch_thread_->join();
+  prefetch_thread_.reset();
+
+  /* The frame which was being read may only be partially in the caches. */
+  if (prefetch_progress_.get_cancel()) {
+    frame_window_valid_ = false;
+  }
+}
+
+void AlembicProcedural::start_prefetch()
+{
+  prefetch_end_frame_ = std::min(frame_window_start_ + prefetch_frames,
+                                 static_cast<double>(end_frame - frame_offset));
+
+  prefetch_ranges_.clear();
+  for (double window_frame = frame_window_end_ + 1.0; window_frame <= prefetch_end_frame_;
+       window_frame += 1.0)
+  {
+    prefetch_ranges_.push_back(get_frame_range(window_frame, window_frame, true));
+  }
+
+  if (prefetch_ranges_.empty()) {
+    return;
+  }
+
+  /* Gather the objects and the memory usage here, as the sockets may be modified while the
+   * background thread is running. */
+  vector<AlembicObject *> abc_objects;
+  size_t memory_used = 0;
+
+  for (Node *node : objects) {
+    AlembicObject *object = static_cast<AlembicObject *>(node);
+
+    if (object->read_data) {
+      abc_objects.push_back(object);
+      memory_used += object->get_cached_data().memory_used();
+    }
+  }
+
+  const size_t memory_limit = get_prefetch_cache_size_in_bytes();
+
+  prefetch_progress_.reset();
+  prefetch_thread_ = make_unique<thread>([this, abc_objects, memory_used, memory_limit]() {
+    prefetch(abc_objects, memory_used, memory_limit);
+  });
+}
+
+void AlembicProcedural::prefetch(const vector<AlembicObject *> &abc_objects,
+                                 size_t memory_used,
+                                 size_t memory_limit)
+{
+  size_t frame_memory_used = 0;
+
+  for (const FrameRange &range : prefetch_ranges_) {
+    /* Assume the next frame needs as much memory as the previous one. */
+    if (memory_used + frame_memory_used > memory_limit) {
+      break;
+    }
+
+    frames_to_read_ = range;
+
+    for (AlembicObject *object : abc_objects) {
+      if (prefetch_progress_.get_cancel()) {
+        return;
+      }
+
+      object->read_data(object->get_cached_data(), this, prefetch_progress_);
+    }
+
+    if (prefetch_progress_.get_cancel()) {
+      return;
+    }
+
+    size_t new_memory_used = 0;
+    for (AlembicObject *object : abc_objects) {
+      new_memory_used += object->get_cached_data().memory_used();
+    }
+
+    frame_memory_used = (new_memory_used > memory_used) ? new_memory_used - memory_used : 0;
+    memory_used = new_memory_used;
+    frame_window_end_ += 1.0;
+  }
+
+  VLOG_WORK << "AlembicProcedural prefetched up to frame " << frame_window_end_
+            << ", memory usage : " << string_human_readable_size(memory_used);
+}
+
 void AlembicProcedural::add_object(AlembicObject *object)
 {
   objects.push_back_slow(object);
@@ -1549,7 +1716,8 @@ void AlembicProcedural::build_caches(Progress &progress)
 
     memory_used += object->get_cached_data().memory_used();
 
-    if (use_prefetch) {
+    /* When prefetching a window of frames, the limit is enforced while reading ahead. */
+    if (use_prefetch && !use_frame_window()) {
       if (memory_used > get_prefetch_cache_size_in_bytes()) {
         progress.set_error("Error: Alembic Procedural memory limit reached");
         return;
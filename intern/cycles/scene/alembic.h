@@ -7,8 +7,13 @@
 #include "graph/node.h"
 #include "scene/attribute.h"
 #include "scene/procedural.h"
+#include "util/algorithm.h"
+#include "util/function.h"
+#include "util/progress.h"
 #include "util/set.h"
+#include "util/thread.h"
 #include "util/transform.h"
+#include "util/unique_ptr.h"
 #include "util/vector.h"
 
 #ifdef WITH_ALEMBIC
@@ -242,6 +247,54 @@ template<typename T> class DataStore {
     last_loaded_time = std::numeric_limits<double>::max();
   }
 
+  /* Remove the data for the times before the specified one, except for the entry that is still
+   * needed to look up the data at this time. */
+  void remove_data_before(double time)
+  {
+    size_t num_removed_entries = 0;
+    while (num_removed_entries + 1 < index_data_map.size() &&
+           index_data_map[num_removed_entries + 1].time <= time)
+    {
+      num_removed_entries++;
+    }
+
+    if (num_removed_entries == 0) {
+      return;
+    }
+
+    index_data_map.erase(index_data_map.begin(), index_data_map.begin() + num_removed_entries);
+
+    /* Data is added in chronological order, so the first referenced index is also the lowest. */
+    size_t num_removed_data = data.size();
+    for (const TimeIndexPair &pair : index_data_map) {
+      if (pair.index != -1ul) {
+        num_removed_data = pair.index;
+        break;
+      }
+    }
+
+    if (num_removed_data == 0) {
+      return;
+    }
+
+    for (size_t i = num_removed_data; i < data.size(); ++i) {
+      if constexpr (is_array<T>::value) {
+        data[i - num_removed_data].steal_data(data[i]);
+      }
+      else {
+        data[i - num_removed_data] = data[i];
+      }
+    }
+
+    data.resize(data.size() - num_removed_data);
+
+    for (TimeIndexPair &pair : index_data_map) {
+      if (pair.index != -1ul) {
+        pair.index -= num_removed_data;
+      }
+    }
+  }
+
   /* Copy the data for the specified time to the node's socket. If there is no
    * data for this time or it was already loaded, do nothing. */
   void copy_to_socket(double time, Node *node, const SocketType *socket)
@@ -274,11 +327,25 @@ template<typename T> class DataStore {
   }
 
  private:
+  /* Find the entry closest to the specified time. The entries do not necessarily start at the
+   * first sample of the time sampling, as the data may only be loaded for a range of frames. */
   const TimeIndexPair &get_index_for_time(double time) const
   {
-    std::pair<size_t, Alembic::Abc::chrono_t> index_pair;
-    index_pair = time_sampling.getNearIndex(time, index_data_map.size());
-    return index_data_map[index_pair.first];
+    auto it = std::lower_bound(
+        index_data_map.begin(),
+        index_data_map.end(),
+        time,
+        [](const TimeIndexPair &pair, double time_) { return pair.time < time_; });
+
+    if (it == index_data_map.end()) {
+      return index_data_map.back();
+    }
+
+    if (it != index_data_map.begin() && (time - (it - 1)->time) <= (it->time - time)) {
+      return *(it - 1);
+    }
+
+    return *it;
   }
 };
 
@@ -341,6 +408,10 @@ struct CachedData {
 
   void set_time_sampling(Alembic::AbcCoreAbstract::TimeSampling time_sampling);
 
+  /* Free the data for the times before the specified one. The transforms are kept as they are
+   * not read along with the frames. */
+  void remove_data_before(double time);
+
   size_t memory_used() const;
 };
 
@@ -402,8 +473,24 @@ class AlembicObject : public Node {
                           const Alembic::AbcGeom::IPointsSchema &schema,
                           Progress &progress);
 
+  /* Set up #read_data for the schema data and read the data of the procedural's frames with it.
+   * The schema is used as the base compound property of the attributes, to also be able to look
+   * for top level properties. */
+  template<typename SchemaData>
+  void load_data_with_reader(CachedData &cached_data,
+                             AlembicProcedural *proc,
+                             const SchemaData &data,
+                             const Alembic::AbcGeom::ICompoundProperty &arb_geom_params,
+                             const Alembic::AbcGeom::IV2fGeomParam &default_uvs_param,
+                             Progress &progress);
+
   bool has_data_loaded() const;
 
+  /* Read the data for the procedural's frames to read into the cache. This is set up when loading
+   * the cache and only holds copies of the settings it needs, so that it can be used to prefetch
+   * the data for the upcoming frames in a background thread. */
+  function<void(CachedData &, AlembicProcedural *, Progress &)> read_data;
+
   /* Enumeration used to speed up the discrimination of an IObject as IObject::matches() methods
    * are too expensive and show up in profiles. */
   enum AbcSchemaType {
@@ -459,6 +546,9 @@ class AlembicObject : public Node {
  * This procedural will load the data set for the entire animation in memory on the first frame,
  * and directly set the data for the new frames on the created Nodes if needed. This allows for
  * faster updates between frames as it avoids reseeking the data on disk.
+ *
+ * For animations that do not fit in memory, only a window of frames starting at the current one
+ * can be kept in memory, with the next frames being read in the background while rendering.
  */
 class AlembicProcedural : public Procedural {
   Alembic::AbcGeom::IArchive archive;
@@ -505,9 +595,14 @@ class AlembicProcedural : public Procedural {
   NODE_SOCKET_API(bool, use_prefetch)
 
   /* Memory limit for the cache, if the data does not fit within this limit, rendering is aborted.
-   */
+   * When prefetching a limited number of frames, reading ahead stops at this limit instead. */
   NODE_SOCKET_API(int, prefetch_cache_size)
 
+  /* Number of frames after the current one to read in a background thread while rendering, frames
+   * before the current one are evicted from the cache. If zero, the data for the entire animation
+   * is loaded at once. */
+  NODE_SOCKET_API(int, prefetch_frames)
+
   AlembicProcedural();
   ~AlembicProcedural();
 
@@ -528,7 +623,54 @@ class AlembicProcedural : public Procedural {
    * Returns a pointer to an existing or a newly created AlembicObject for the given path. */
   AlembicObject *get_or_create_object(const ustring &path);
 
+  /* Range of frames for which the data is read from the archive, and whether the data for the
+   * frames before this range is already in the caches. The times are in seconds, and the end time
+   * is that of the frame following the range. */
+  struct FrameRange {
+    double start_time = 0.0;
+    double end_time = 0.0;
+    bool append = false;
+  };
+
+  const FrameRange &get_frames_to_read() const
+  {
+    return frames_to_read_;
+  }
+
  private:
+  FrameRange frames_to_read_;
+
+  /* Frames whose data is in the caches when prefetching a limited number of frames. */
+  bool frame_window_valid_ = false;
+  double frame_window_start_ = 0.0;
+  double frame_window_end_ = 0.0;
+
+  /* Background reading of the upcoming frames, one range per frame. */
+  unique_ptr<thread> prefetch_thread_;
+  Progress prefetch_progress_;
+  vector<FrameRange> prefetch_ranges_;
+  double prefetch_end_frame_ = 0.0;
+
+  FrameRange get_frame_range(double first_frame, double last_frame, bool append) const;
+
+  bool use_frame_window() const
+  {
+    return use_prefetch && prefetch_frames > 0;
+  }
+
+  /* Wait for the data being read in the background, or cancel the reading if the given frame is
+   * not part of it. */
+  void wait_for_prefetch(double window_frame);
+
+  /* Start reading the data for the frames after the cached window in a background thread. */
+  void start_prefetch();
+
+  /* Read the data for the frames to prefetch, one frame at a time, until the memory limit is
+   * reached. This runs in the background thread. */
+  void prefetch(const vector<AlembicObject *> &abc_objects,
+                size_t memory_used,
+                size_t memory_limit);
+
   /* Add an object to our list of objects, and tag the socket as modified. */
   void add_object(AlembicObject *object);
 
@@ -20,38 +20,29 @@ static float3 make_float3_from_yup(const V3f &v)
   return make_float3(v.x, -v.z, v.y);
 }
 
-/* get the sample times to load data for the given the start and end frame of the procedural */
+/* get the sample times to load data for the frames to read of the procedural */
 static set<chrono_t> get_relevant_sample_times(AlembicProcedural *proc,
                                                const TimeSampling &time_sampling,
                                                size_t num_samples)
 {
   set<chrono_t> result;
 
+  const AlembicProcedural::FrameRange &frames = proc->get_frames_to_read();
+
   if (num_samples < 2) {
-    result.insert(0.0);
+    /* Constant data was already read with the previous frames. */
+    if (!frames.append) {
+      result.insert(0.0);
+    }
     return result;
   }
 
-  double start_frame;
-  double end_frame;
-
-  if (proc->get_use_prefetch()) {
-    // load the data for the entire animation
-    start_frame = static_cast<double>(proc->get_start_frame());
-    end_frame = static_cast<double>(proc->get_end_frame());
-  }
-  else {
-    // load the data for the current frame
-    start_frame = static_cast<double>(proc->get_frame());
-    end_frame = start_frame;
-  }
-
-  const double frame_rate = static_cast<double>(proc->get_frame_rate());
-  const double start_time = start_frame / frame_rate;
-  const double end_time = (end_frame + 1) / frame_rate;
-
-  const size_t start_index = time_sampling.getFloorIndex(start_time, num_samples).first;
-  const size_t end_index = time_sampling.getCeilIndex(end_time, num_samples).first;
+  /* When appending, start where the previous range ended, to neither skip nor duplicate samples.
+   */
+  const size_t start_index = frames.append ?
+                                 time_sampling.getCeilIndex(frames.start_time, num_samples).first :
+                                 time_sampling.getFloorIndex(frames.start_time, num_samples).first;
+  const size_t end_index = time_sampling.getCeilIndex(frames.end_time, num_samples).first;
 
   for (size_t i = start_index; i < end_index; ++i) {
     result.insert(time_sampling.getSampleTime(i));
@@ -547,55 +547,29 @@ void GeometryManager::device_update_preprocess(Device *device, Scene *scene, Pro
     dscene->attributes_map.tag_realloc();
     dscene->attributes_float.tag_realloc();
   }
-  else if (device_update_flags & ATTR_FLOAT_MODIFIED) {
-    dscene->attributes_float.tag_modified();
-  }
 
   if (device_update_flags & ATTR_FLOAT2_NEEDS_REALLOC) {
     dscene->attributes_map.tag_realloc();
     dscene->attributes_float2.tag_realloc();
   }
-  else if (device_update_flags & ATTR_FLOAT2_MODIFIED) {
-    dscene->attributes_float2.tag_modified();
-  }
 
   if (device_update_flags & ATTR_FLOAT3_NEEDS_REALLOC) {
     dscene->attributes_map.tag_realloc();
     dscene->attributes_float3.tag_realloc();
   }
-  else if (device_update_flags & ATTR_FLOAT3_MODIFIED) {
-    dscene->attributes_float3.tag_modified();
-  }
 
   if (device_update_flags & ATTR_FLOAT4_NEEDS_REALLOC) {
     dscene->attributes_map.tag_realloc();
     dscene->attributes_float4.tag_realloc();
   }
-  else if (device_update_flags & ATTR_FLOAT4_MODIFIED) {
-    dscene->attributes_float4.tag_modified();
-  }
 
   if (device_update_flags & ATTR_UCHAR4_NEEDS_REALLOC) {
     dscene->attributes_map.tag_realloc();
     dscene->attributes_uchar4.tag_realloc();
   }
-  else if (device_update_flags & ATTR_UCHAR4_MODIFIED) {
-    dscene->attributes_uchar4.tag_modified();
-  }
-
-  if (device_update_flags & DEVICE_MESH_DATA_MODIFIED) {
-    /* if anything else than vertices or shaders are modified, we would need to reallocate, so
-     * these are the only arrays that can be updated */
-    dscene->tri_verts.tag_modified();
-    dscene->tri_vnormal.tag_modified();
-    dscene->tri_shader.tag_modified();
-  }
 
-  if (device_update_flags & DEVICE_CURVE_DATA_MODIFIED) {
-    dscene->curve_keys.tag_modified();
-    dscene->curves.tag_modified();
-    dscene->curve_segments.tag_modified();
-  }
+  /* Modified attribute, mesh and curve data that does not need reallocation is tagged per
+   * geometry when it is packed, so that only the affected ranges are copied to the device. */
 
   if (device_update_flags & DEVICE_POINT_DATA_MODIFIED) {
     dscene->points.tag_modified();
@@ -106,14 +106,21 @@ void GeometryManager::device_update_mesh(Device *,
       if (geom->geometry_type == Geometry::MESH || geom->geometry_type == Geometry::VOLUME) {
         Mesh *mesh = static_cast<Mesh *>(geom);
 
+        const size_t mesh_vert_size = mesh->verts.size();
+        const size_t mesh_tri_size = mesh->num_triangles();
+
+        /* Only the slices belonging to modified meshes are tagged, so that the copy to the
+         * device is limited to the range of data that actually changed. */
         if (mesh->shader_is_modified() || mesh->smooth_is_modified() ||
             mesh->triangles_is_modified() || copy_all_data)
         {
           mesh->pack_shaders(scene, &tri_shader[mesh->prim_offset]);
+          dscene->tri_shader.tag_modified(mesh->prim_offset, mesh_tri_size);
         }
 
         if (mesh->verts_is_modified() || copy_all_data) {
           mesh->pack_normals(&vnormal[mesh->vert_offset]);
+          dscene->tri_vnormal.tag_modified(mesh->vert_offset, mesh_vert_size);
         }
 
         if (mesh->verts_is_modified() || mesh->triangles_is_modified() ||
@@ -123,6 +130,10 @@ void GeometryManager::device_update_mesh(Device *,
                            &tri_vindex[mesh->prim_offset],
                            &tri_patch[mesh->prim_offset],
                            &tri_patch_uv[mesh->vert_offset]);
+          dscene->tri_verts.tag_modified(mesh->vert_offset, mesh_vert_size);
+          dscene->tri_vindex.tag_modified(mesh->prim_offset, mesh_tri_size);
+          dscene->tri_patch.tag_modified(mesh->prim_offset, mesh_tri_size);
+          dscene->tri_patch_uv.tag_modified(mesh->vert_offset, mesh_vert_size);
         }
 
         if (progress.get_cancel()) {
@@ -170,6 +181,10 @@ void GeometryManager::device_update_mesh(Device *,
                           &curve_keys[hair->curve_key_offset],
                           &curves[hair->prim_offset],
                           &curve_segments[hair->curve_segment_offset]);
+        dscene->curve_keys.tag_modified(hair->curve_key_offset, hair->get_curve_keys().size());
+        dscene->curves.tag_modified(hair->prim_offset, hair->num_curves());
+        dscene->curve_segments.tag_modified(hair->curve_segment_offset, hair->num_segments());
+
         if (progress.get_cancel()) {
           return;
         }
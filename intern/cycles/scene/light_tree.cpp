@@ -499,6 +499,94 @@ void LightTree::recursive_build(const Child child,
   }
 }
 
+/* Buckets of all three split dimensions, filled in a single pass over the emitters. */
+using LightTreeBuckets = std::array<std::array<LightTreeBucket, LightTreeBucket::num_buckets>, 3>;
+
+/* Compute the bounding box of the emitter centroids, threaded when `grain_size` is non-zero. */
+static BoundBox compute_centroid_bbox(const LightTreeEmitter *emitters,
+                                      const int start,
+                                      const int end,
+                                      const int grain_size)
+{
+  auto grow_range = [emitters](const blocked_range<int> &range, BoundBox bbox) {
+    for (int i = range.begin(); i < range.end(); i++) {
+      bbox.grow(emitters[i].centroid);
+    }
+    return bbox;
+  };
+
+  if (grain_size == 0) {
+    return grow_range(blocked_range<int>(start, end), BoundBox::empty);
+  }
+
+  const blocked_range<int> range(start, end, grain_size);
+  return parallel_reduce(range, BoundBox(BoundBox::empty), grow_range, [](BoundBox a, BoundBox b) {
+    a.grow(b);
+    return a;
+  });
+}
+
+/* Place emitters into equally sized buckets along each dimension of the centroid bounds,
+ * threaded when `grain_size` is non-zero. */
+static void fill_buckets(const LightTreeEmitter *emitters,
+                         const int start,
+                         const int end,
+                         const BoundBox &centroid_bbox,
+                         const int grain_size,
+                         LightTreeBuckets &r_buckets)
+{
+  const float3 extent = centroid_bbox.size();
+
+  /* Dimension 0 is always binned since the node measure is computed from its buckets. Along
+   * a dimension with zero extent all emitters go into the first bucket. */
+  bool use_dim[3];
+  float inv_extent[3];
+  for (int dim = 0; dim < 3; dim++) {
+    use_dim[dim] = (dim == 0) || (extent[dim] != 0.0f);
+    inv_extent[dim] = (extent[dim] != 0.0f) ? 1.0f / extent[dim] : 0.0f;
+  }
+
+  auto fill_range = [&](const blocked_range<int> &range, LightTreeBuckets buckets) {
+    for (int i = range.begin(); i < range.end(); i++) {
+      const LightTreeEmitter &emitter = emitters[i];
+
+      for (int dim = 0; dim < 3; dim++) {
+        if (!use_dim[dim]) {
+          continue;
+        }
+
+        /* Place emitter into the appropriate bucket, where the centroid box is split into equal
+         * partitions. */
+        int bucket_idx = LightTreeBucket::num_buckets *
+                         (emitter.centroid[dim] - centroid_bbox.min[dim]) * inv_extent[dim];
+        bucket_idx = clamp(bucket_idx, 0, LightTreeBucket::num_buckets - 1);
+
+        buckets[dim][bucket_idx].add(emitter);
+      }
+    }
+    return buckets;
+  };
+
+  if (grain_size == 0) {
+    r_buckets = fill_range(blocked_range<int>(start, end), LightTreeBuckets());
+    return;
+  }
+
+  const blocked_range<int> range(start, end, grain_size);
+
+  /* Merging orientation bounds is not associative, use a deterministic reduction so that the
+   * resulting tree does not depend on thread scheduling. */
+  r_buckets = parallel_deterministic_reduce(
+      range, LightTreeBuckets(), fill_range, [](LightTreeBuckets a, const LightTreeBuckets &b) {
+        for (int dim = 0; dim < 3; dim++) {
+          for (int i = 0; i < LightTreeBucket::num_buckets; i++) {
+            a[dim][i] = a[dim][i] + b[dim][i];
+          }
+        }
+        return a;
+      });
+}
+
 bool LightTree::should_split(LightTreeEmitter *emitters,
                              const int start,
                              int &middle,
@@ -519,39 +607,31 @@ bool LightTree::should_split(LightTreeEmitter *emitters,
 
   middle = (start + end) / 2;
 
-  BoundBox centroid_bbox = BoundBox::empty;
-  for (int i = start; i < end; i++) {
-    centroid_bbox.grow((emitters + i)->centroid);
-  }
+  /* Nodes close to the root contain most of the emitters and are built before there is enough
+   * work to distribute subtrees over threads, so bin those in parallel as well. */
+  const int grain_size = (num_emitters > 2 * MIN_EMITTERS_PER_THREAD) ? MIN_EMITTERS_PER_THREAD :
+                                                                         0;
+
+  const BoundBox centroid_bbox = compute_centroid_bbox(emitters, start, end, grain_size);
 
   const float3 extent = centroid_bbox.size();
   const float max_extent = max4(extent.x, extent.y, extent.z, 0.0f);
 
+  LightTreeBuckets buckets_dims;
+  fill_buckets(emitters, start, end, centroid_bbox, grain_size, buckets_dims);
+
   /* Check each dimension to find the minimum splitting cost. */
   float total_cost = 0.0f;
   float min_cost = FLT_MAX;
   for (int dim = 0; dim < 3; dim++) {
     /* If the centroid bounding box is 0 along a given dimension and the node measure is already
      * computed, skip it. */
-    if (centroid_bbox.size()[dim] == 0.0f && dim != 0) {
+    if (extent[dim] == 0.0f && dim != 0) {
       continue;
     }
 
-    const float inv_extent = 1 / (centroid_bbox.size()[dim]);
-
-    /* Fill in buckets with emitters. */
-    std::array<LightTreeBucket, LightTreeBucket::num_buckets> buckets;
-    for (int i = start; i < end; i++) {
-      const LightTreeEmitter *emitter = emitters + i;
-
-      /* Place emitter into the appropriate bucket, where the centroid box is split into equal
-       * partitions. */
-      int bucket_idx = LightTreeBucket::num_buckets *
-                       (emitter->centroid[dim] - centroid_bbox.min[dim]) * inv_extent;
-      bucket_idx = clamp(bucket_idx, 0, LightTreeBucket::num_buckets - 1);
-
-      buckets[bucket_idx].add(*emitter);
-    }
+    const float inv_extent = 1 / extent[dim];
+    const std::array<LightTreeBucket, LightTreeBucket::num_buckets> &buckets = buckets_dims[dim];
 
     /* Precompute the left bucket measure cumulatively. */
     std::array<LightTreeBucket, LightTreeBucket::num_buckets - 1> left_buckets;
@@ -566,12 +646,12 @@ bool LightTree::should_split(LightTreeEmitter *emitters,
       light_link = left_buckets.back().light_link + buckets.back().light_link;
 
       /* Degenerate case with co-located emitters. */
-      if (is_zero(centroid_bbox.size())) {
+      if (is_zero(extent)) {
         break;
       }
 
       /* If the centroid bounding box is 0 along a given dimension, skip it. */
-      if (centroid_bbox.size()[dim] == 0.0f) {
+      if (extent[dim] == 0.0f) {
         continue;
       }
 
@@ -165,6 +165,7 @@ SVMCompiler::SVMCompiler(Scene *scene) : scene(scene)
   mix_weight_offset = SVM_STACK_INVALID;
   bump_state_offset = SVM_STACK_INVALID;
   compile_failed = false;
+  value_block_index = -1;
 
   /* This struct has one entry for every node, in order of ShaderNodeType definition. */
   svm_node_types_used = (std::atomic_int *)&scene->dscene.data.svm_usage;
@@ -261,19 +262,20 @@ int SVMCompiler::stack_assign(ShaderInput *input)
       input->stack_offset = stack_find_offset(input->type());
 
       if (input->type() == SocketType::FLOAT) {
-        add_node(NODE_VALUE_F,
-                 __float_as_int(node->get_float(input->socket_type)),
-                 input->stack_offset);
+        add_value(input->stack_offset, 1, __float_as_int(node->get_float(input->socket_type)));
       }
       else if (input->type() == SocketType::INT) {
-        add_node(NODE_VALUE_F, node->get_int(input->socket_type), input->stack_offset);
+        add_value(input->stack_offset, 1, node->get_int(input->socket_type));
       }
       else if (input->type() == SocketType::VECTOR || input->type() == SocketType::NORMAL ||
                input->type() == SocketType::POINT || input->type() == SocketType::COLOR)
       {
-
-        add_node(NODE_VALUE_V, input->stack_offset);
-        add_node(NODE_VALUE_V, node->get_float3(input->socket_type));
+        const float3 value = node->get_float3(input->socket_type);
+        add_value(input->stack_offset,
+                  3,
+                  __float_as_int(value.x),
+                  __float_as_int(value.y),
+                  __float_as_int(value.z));
       }
       else { /* should not get called for closure */
         assert(0);
@@ -409,6 +411,26 @@ void SVMCompiler::add_node(const float4 &f)
       __float_as_int(f.x), __float_as_int(f.y), __float_as_int(f.z), __float_as_int(f.w)));
 }
 
+void SVMCompiler::add_value(int offset, int size, int x, int y, int z)
+{
+  /* Start a new block if other nodes were added after the last constant. */
+  if (value_block_index == -1 ||
+      size_t(value_block_index + 1 + current_svm_nodes[value_block_index].y) !=
+          current_svm_nodes.size())
+  {
+    value_block_index = current_svm_nodes.size();
+    add_node(NODE_VALUE_BLOCK, 0);
+  }
+
+  current_svm_nodes[value_block_index].y++;
+  add_node(encode_uchar4(offset, size), x, y, z);
+}
+
+void SVMCompiler::end_value_block()
+{
+  value_block_index = -1;
+}
+
 uint SVMCompiler::attribute(ustring name)
 {
   return scene->shader_manager->get_attribute_id(name);
@@ -691,6 +713,9 @@ void SVMCompiler::generate_multi_closure(ShaderNode *root_node,
 
         generate_multi_closure(root_node, cl1in->link->parent, state);
 
+        /* Constants added after this point must not be skipped by the jump. */
+        end_value_block();
+
         /* Fill in jump instruction location to be after closure. */
         current_svm_nodes[node_jump_skip_index].y = current_svm_nodes.size() -
                                                     node_jump_skip_index - 1;
@@ -707,6 +732,9 @@ void SVMCompiler::generate_multi_closure(ShaderNode *root_node,
 
         generate_multi_closure(root_node, cl2in->link->parent, state);
 
+        /* Constants added after this point must not be skipped by the jump. */
+        end_value_block();
+
         /* Fill in jump instruction location to be after closure. */
         current_svm_nodes[node_jump_skip_index].y = current_svm_nodes.size() -
                                                     node_jump_skip_index - 1;
@@ -781,6 +809,7 @@ void SVMCompiler::compile_type(Shader *shader, ShaderGraph *graph, ShaderType ty
   /* clear all compiler state */
   memset((void *)&active_stack, 0, sizeof(active_stack));
   current_svm_nodes.clear();
+  end_value_block();
 
   foreach (ShaderNode *node, graph->nodes) {
     foreach (ShaderInput *input, node->inputs)
@@ -857,6 +886,7 @@ void SVMCompiler::compile_type(Shader *shader, ShaderGraph *graph, ShaderType ty
   /* if compile failed, generate empty shader */
   if (compile_failed) {
     current_svm_nodes.clear();
+    end_value_block();
     compile_failed = false;
   }
 
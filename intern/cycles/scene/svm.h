@@ -220,6 +220,11 @@ class SVMCompiler {
   /* compile */
   void compile_type(Shader *shader, ShaderGraph *graph, ShaderType type);
 
+  /* Constants loaded into the stack. Consecutive constants are added to the same
+   * NODE_VALUE_BLOCK, so that they are all loaded by a single node in the kernel. */
+  void add_value(int offset, int size, int x, int y = 0, int z = 0);
+  void end_value_block();
+
   std::atomic_int *svm_node_types_used;
   array<int4> current_svm_nodes;
   ShaderType current_type;
@@ -229,6 +234,7 @@ class SVMCompiler {
   uint mix_weight_offset;
   uint bump_state_offset;
   bool compile_failed;
+  int value_block_index;
 };
 
 CCL_NAMESPACE_END
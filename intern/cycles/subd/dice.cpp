@@ -8,6 +8,8 @@
 #include "subd/dice.h"
 #include "subd/patch.h"
 
+#include "util/tbb.h"
+
 CCL_NAMESPACE_BEGIN
 
 /* EdgeDice Base */
@@ -33,8 +35,14 @@ void EdgeDice::reserve(int num_verts, int num_triangles)
   vert_offset = mesh->get_verts().size();
   tri_offset = mesh->num_triangles();
 
-  mesh->resize_mesh(mesh->get_verts().size() + num_verts, mesh->num_triangles());
-  mesh->reserve_mesh(mesh->get_verts().size() + num_verts, mesh->num_triangles() + num_triangles);
+  /* Resize rather than reserve, so that subpatches can be diced in parallel with each of them
+   * writing to its own range of vertices and triangles. */
+  mesh->resize_mesh(vert_offset + num_verts, tri_offset + num_triangles);
+
+  mesh->tag_triangles_modified();
+  mesh->tag_shader_modified();
+  mesh->tag_smooth_modified();
+  mesh->tag_triangle_patch_modified();
 
   Attribute *attr_vN = mesh->attributes.add(ATTR_STD_VERTEX_NORMAL);
 
@@ -57,17 +65,22 @@ void EdgeDice::set_vert(Patch *patch, int index, float2 uv)
   params.mesh->vert_patch_uv[index + vert_offset] = make_float2(uv.x, uv.y);
 }
 
-void EdgeDice::add_triangle(Patch *patch, int v0, int v1, int v2)
+void EdgeDice::set_triangle(Patch *patch, int index, int v0, int v1, int v2)
 {
   Mesh *mesh = params.mesh;
+  const size_t tri = tri_offset + index;
 
-  mesh->add_triangle(v0 + vert_offset, v1 + vert_offset, v2 + vert_offset, patch->shader, true);
-  params.mesh->triangle_patch[params.mesh->num_triangles() - 1] = patch->patch_index;
+  assert(tri < mesh->num_triangles());
 
-  tri_offset++;
+  mesh->triangles[tri * 3 + 0] = v0 + vert_offset;
+  mesh->triangles[tri * 3 + 1] = v1 + vert_offset;
+  mesh->triangles[tri * 3 + 2] = v2 + vert_offset;
+  mesh->shader[tri] = patch->shader;
+  mesh->smooth[tri] = true;
+  mesh->triangle_patch[tri] = patch->patch_index;
 }
 
-void EdgeDice::stitch_triangles(Subpatch &sub, int edge)
+int EdgeDice::stitch_triangles(Subpatch &sub, int edge, int triangle_index)
 {
   int Mu = max(sub.edge_u0.T, sub.edge_u1.T);
   int Mv = max(sub.edge_v0.T, sub.edge_v1.T);
@@ -78,7 +91,7 @@ void EdgeDice::stitch_triangles(Subpatch &sub, int edge)
   int inner_T = ((edge % 2) == 0) ? Mv - 2 : Mu - 2;
 
   if (inner_T < 0 || outer_T < 0) {
-    return;  // XXX avoid crashes for Mu or Mv == 1, missing polygons
+    return triangle_index;  // XXX avoid crashes for Mu or Mv == 1, missing polygons
   }
 
   /* stitch together two arrays of verts with triangles. at each step,
@@ -113,8 +126,10 @@ void EdgeDice::stitch_triangles(Subpatch &sub, int edge)
       }
     }
 
-    add_triangle(sub.patch, v1, v0, v2);
+    set_triangle(sub.patch, triangle_index++, v1, v0, v2);
   }
+
+  return triangle_index;
 }
 
 /* QuadDice */
@@ -147,12 +162,17 @@ void QuadDice::set_vert(Subpatch &sub, int index, float u, float v)
   EdgeDice::set_vert(sub.patch, index, map_uv(sub, u, v));
 }
 
-void QuadDice::set_side(Subpatch &sub, int edge)
+void QuadDice::set_side(Subpatch &sub, int edge, int sub_index, const vector<int> &vert_owner)
 {
   int t = sub.edges[edge].T;
 
   /* set verts on the edge of the patch */
   for (int i = 0; i < t; i++) {
+    const int index = sub.get_vert_along_edge(edge, i);
+    if (vert_owner[index] != sub_index) {
+      continue;
+    }
+
     float f = i / (float)t;
 
     float u, v;
@@ -176,7 +196,7 @@ void QuadDice::set_side(Subpatch &sub, int edge)
         break;
     }
 
-    set_vert(sub, sub.get_vert_along_edge(edge, i), u, v);
+    set_vert(sub, index, u, v);
   }
 }
 
@@ -216,7 +236,7 @@ float QuadDice::scale_factor(Subpatch &sub, int Mu, int Mv)
   return S;
 }
 
-void QuadDice::add_grid(Subpatch &sub, int Mu, int Mv, int offset)
+void QuadDice::add_grid_verts(Subpatch &sub, int Mu, int Mv, int offset)
 {
   /* create inner grid */
   float du = 1.0f / (float)Mu;
@@ -228,25 +248,32 @@ void QuadDice::add_grid(Subpatch &sub, int Mu, int Mv, int offset)
       float v = j * dv;
 
       set_vert(sub, offset + (i - 1) + (j - 1) * (Mu - 1), u, v);
+    }
+  }
+}
 
-      if (i < Mu - 1 && j < Mv - 1) {
-        int i1 = offset + (i - 1) + (j - 1) * (Mu - 1);
-        int i2 = offset + i + (j - 1) * (Mu - 1);
-        int i3 = offset + i + j * (Mu - 1);
-        int i4 = offset + (i - 1) + j * (Mu - 1);
-
-        add_triangle(sub.patch, i1, i2, i3);
-        add_triangle(sub.patch, i1, i3, i4);
-      }
+int QuadDice::add_grid_triangles(Subpatch &sub, int Mu, int Mv, int offset, int triangle_index)
+{
+  for (int j = 1; j < Mv - 1; j++) {
+    for (int i = 1; i < Mu - 1; i++) {
+      int i1 = offset + (i - 1) + (j - 1) * (Mu - 1);
+      int i2 = offset + i + (j - 1) * (Mu - 1);
+      int i3 = offset + i + j * (Mu - 1);
+      int i4 = offset + (i - 1) + j * (Mu - 1);
+
+      set_triangle(sub.patch, triangle_index++, i1, i2, i3);
+      set_triangle(sub.patch, triangle_index++, i1, i3, i4);
     }
   }
+
+  return triangle_index;
 }
 
-void QuadDice::dice(Subpatch &sub)
+void QuadDice::calc_grid_size(Subpatch &sub, int &Mu, int &Mv)
 {
   /* compute inner grid size with scale factor */
-  int Mu = max(sub.edge_u0.T, sub.edge_u1.T);
-  int Mv = max(sub.edge_v0.T, sub.edge_v1.T);
+  Mu = max(sub.edge_u0.T, sub.edge_u1.T);
+  Mv = max(sub.edge_v0.T, sub.edge_v1.T);
 
 #if 0 /* Doesn't work very well, especially at grazing angles. */
   float S = scale_factor(sub, ef, Mu, Mv);
@@ -256,20 +283,70 @@ void QuadDice::dice(Subpatch &sub)
 
   Mu = max((int)ceilf(S * Mu), 2);  // XXX handle 0 & 1?
   Mv = max((int)ceilf(S * Mv), 2);  // XXX handle 0 & 1?
+}
+
+void QuadDice::dice_verts(Subpatch &sub, int sub_index, const vector<int> &vert_owner)
+{
+  int Mu, Mv;
+  calc_grid_size(sub, Mu, Mv);
 
   /* inner grid */
-  add_grid(sub, Mu, Mv, sub.inner_grid_vert_offset);
+  add_grid_verts(sub, Mu, Mv, sub.inner_grid_vert_offset);
 
   /* sides */
-  set_side(sub, 0);
-  set_side(sub, 1);
-  set_side(sub, 2);
-  set_side(sub, 3);
-
-  stitch_triangles(sub, 0);
-  stitch_triangles(sub, 1);
-  stitch_triangles(sub, 2);
-  stitch_triangles(sub, 3);
+  set_side(sub, 0, sub_index, vert_owner);
+  set_side(sub, 1, sub_index, vert_owner);
+  set_side(sub, 2, sub_index, vert_owner);
+  set_side(sub, 3, sub_index, vert_owner);
+}
+
+void QuadDice::dice_triangles(Subpatch &sub)
+{
+  int Mu, Mv;
+  calc_grid_size(sub, Mu, Mv);
+
+  int triangle_index = add_grid_triangles(
+      sub, Mu, Mv, sub.inner_grid_vert_offset, sub.triangle_offset);
+
+  triangle_index = stitch_triangles(sub, 0, triangle_index);
+  triangle_index = stitch_triangles(sub, 1, triangle_index);
+  triangle_index = stitch_triangles(sub, 2, triangle_index);
+  triangle_index = stitch_triangles(sub, 3, triangle_index);
+
+  assert(triangle_index == sub.triangle_offset + sub.calc_num_triangles());
+}
+
+void QuadDice::dice(vector<Subpatch> &subpatches, int num_verts)
+{
+  /* Vertices along edges are shared between adjacent subpatches, which evaluate them from their
+   * own patch and may get slightly different positions. Let the last subpatch touching a vertex
+   * be the only one to write it, which gives the same result as dicing subpatches in order. */
+  vector<int> vert_owner(num_verts, -1);
+  for (size_t i = 0; i < subpatches.size(); i++) {
+    const Subpatch &sub = subpatches[i];
+    for (int edge = 0; edge < 4; edge++) {
+      for (int n = 0; n < sub.edges[edge].T; n++) {
+        vert_owner[sub.get_vert_along_edge(edge, n)] = i;
+      }
+    }
+  }
+
+  /* Stitching depends on the positions of the edge vertices, so all vertices are set before
+   * triangles are created. */
+  static const int SUBPATCHES_PER_TASK = 16;
+  parallel_for(blocked_range<size_t>(0, subpatches.size(), SUBPATCHES_PER_TASK),
+               [&](const blocked_range<size_t> &r) {
+                 for (size_t i = r.begin(); i != r.end(); i++) {
+                   dice_verts(subpatches[i], i, vert_owner);
+                 }
+               });
+
+  parallel_for(blocked_range<size_t>(0, subpatches.size(), SUBPATCHES_PER_TASK),
+               [&](const blocked_range<size_t> &r) {
+                 for (size_t i = r.begin(); i != r.end(); i++) {
+                   dice_triangles(subpatches[i]);
+                 }
+               });
 }
 
 CCL_NAMESPACE_END
@@ -60,9 +60,10 @@ class EdgeDice {
   void reserve(int num_verts, int num_triangles);
 
   void set_vert(Patch *patch, int index, float2 uv);
-  void add_triangle(Patch *patch, int v0, int v1, int v2);
+  void set_triangle(Patch *patch, int index, int v0, int v1, int v2);
 
-  void stitch_triangles(Subpatch &sub, int edge);
+  /* Returns the index after the last triangle that was set. */
+  int stitch_triangles(Subpatch &sub, int edge, int triangle_index);
 };
 
 /* Quad EdgeDice */
@@ -76,14 +77,22 @@ class QuadDice : public EdgeDice {
   float2 map_uv(Subpatch &sub, float u, float v);
   void set_vert(Subpatch &sub, int index, float u, float v);
 
-  void add_grid(Subpatch &sub, int Mu, int Mv, int offset);
+  void add_grid_verts(Subpatch &sub, int Mu, int Mv, int offset);
+  int add_grid_triangles(Subpatch &sub, int Mu, int Mv, int offset, int triangle_index);
 
-  void set_side(Subpatch &sub, int edge);
+  void set_side(Subpatch &sub, int edge, int sub_index, const vector<int> &vert_owner);
 
   float quad_area(const float3 &a, const float3 &b, const float3 &c, const float3 &d);
   float scale_factor(Subpatch &sub, int Mu, int Mv);
 
-  void dice(Subpatch &sub);
+  void calc_grid_size(Subpatch &sub, int &Mu, int &Mv);
+
+  void dice_verts(Subpatch &sub, int sub_index, const vector<int> &vert_owner);
+  void dice_triangles(Subpatch &sub);
+
+  /* Dice all subpatches in parallel. Vertex and triangle offsets of the subpatches must be
+   * assigned and space for them reserved beforehand. */
+  void dice(vector<Subpatch> &subpatches, int num_verts);
 };
 
 CCL_NAMESPACE_END
@@ -709,14 +709,6 @@ void DiagSplit::post_split()
   int num_verts = num_alloced_verts;
   int num_triangles = 0;
 
-  for (size_t i = 0; i < subpatches.size(); i++) {
-    subpatches[i].inner_grid_vert_offset = num_verts;
-    num_verts += subpatches[i].calc_num_inner_verts();
-    num_triangles += subpatches[i].calc_num_triangles();
-  }
-
-  dice.reserve(num_verts, num_triangles);
-
   for (size_t i = 0; i < subpatches.size(); i++) {
     Subpatch &sub = subpatches[i];
 
@@ -725,9 +717,15 @@ void DiagSplit::post_split()
     sub.edge_v0.T = max(sub.edge_v0.T, 1);
     sub.edge_v1.T = max(sub.edge_v1.T, 1);
 
-    dice.dice(sub);
+    sub.inner_grid_vert_offset = num_verts;
+    sub.triangle_offset = num_triangles;
+    num_verts += sub.calc_num_inner_verts();
+    num_triangles += sub.calc_num_triangles();
   }
 
+  dice.reserve(num_verts, num_triangles);
+  dice.dice(subpatches, num_verts);
+
   /* Cleanup */
   subpatches.clear();
   edges.clear();
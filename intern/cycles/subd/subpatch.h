@@ -16,6 +16,7 @@ class Subpatch {
  public:
   class Patch *patch; /* Patch this is a subpatch of. */
   int inner_grid_vert_offset;
+  int triangle_offset; /* Index of the first triangle diced from this subpatch. */
 
   struct edge_t {
     int T;
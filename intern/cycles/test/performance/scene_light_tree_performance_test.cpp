@@ -0,0 +1,124 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "device/device.h"
+
+#include "scene/colorspace.h"
+#include "scene/light_tree.h"
+#include "scene/mesh.h"
+#include "scene/object.h"
+#include "scene/scene.h"
+#include "scene/shader.h"
+
+#include "util/hash.h"
+#include "util/progress.h"
+#include "util/stats.h"
+#include "util/time.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Build the light tree of scenes with many emissive triangles, as found in scenes with LED walls
+ * or city lights. The binary is not run as part of the regular tests, run it manually to compare
+ * build times. */
+
+/* Add `num_objects` objects, each with its own mesh of `triangles_per_object` randomly placed
+ * emissive triangles inside a unit cube. */
+static void add_emissive_meshes(Scene *scene,
+                                Shader *shader,
+                                const int num_objects,
+                                const int triangles_per_object)
+{
+  array<Node *> used_shaders;
+  used_shaders.push_back_slow(shader);
+
+  for (int object_index = 0; object_index < num_objects; object_index++) {
+    Mesh *mesh = scene->create_node<Mesh>();
+    mesh->set_used_shaders(used_shaders);
+    mesh->reserve_mesh(triangles_per_object * 3, triangles_per_object);
+
+    for (int i = 0; i < triangles_per_object; i++) {
+      const uint seed = object_index * triangles_per_object + i;
+      const float3 center = make_float3(hash_uint2_to_float(seed, 0),
+                                        hash_uint2_to_float(seed, 1),
+                                        hash_uint2_to_float(seed, 2));
+      const float size = 1e-3f;
+      mesh->add_vertex(center);
+      mesh->add_vertex(center + make_float3(size, 0.0f, 0.0f));
+      mesh->add_vertex(center + make_float3(0.0f, size, hash_uint2_to_float(seed, 3) * size));
+      mesh->add_triangle(i * 3, i * 3 + 1, i * 3 + 2, 0, false);
+    }
+
+    mesh->compute_bounds();
+
+    Object *object = scene->create_node<Object>();
+    object->set_geometry(mesh);
+    object->set_tfm(transform_identity());
+    object->compute_bounds(false);
+  }
+}
+
+static void benchmark_light_tree_build(const int num_objects, const int triangles_per_object)
+{
+  /* Avoid the warning about an uninitialized OCIO configuration. */
+  ColorSpaceManager::init_fallback_config();
+
+  Stats stats;
+  Profiler profiler;
+  DeviceInfo device_info;
+  Device *device = Device::create(device_info, stats, profiler, true);
+  SceneParams scene_params;
+  Scene *scene = new Scene(scene_params, device);
+
+  Shader *shader = scene->create_node<Shader>();
+  shader->emission_sampling = EMISSION_SAMPLING_FRONT_BACK;
+  shader->emission_estimate = one_float3();
+
+  add_emissive_meshes(scene, shader, num_objects, triangles_per_object);
+
+  DeviceScene *dscene = &scene->dscene;
+  dscene->data.integrator.num_lights = 0;
+  dscene->data.integrator.num_distant_lights = 0;
+
+  Progress progress;
+  double build_time;
+  int num_nodes, num_emitters;
+  {
+    scoped_timer timer(&build_time);
+    LightTree light_tree(scene, dscene, progress, 8);
+    light_tree.build(scene, dscene);
+    num_nodes = light_tree.num_nodes;
+    num_emitters = light_tree.num_emitters();
+  }
+
+  printf("%d object(s) with %d emissive triangles each: %d emitters, %d nodes, %.3f seconds\n",
+         num_objects,
+         triangles_per_object,
+         num_emitters,
+         num_nodes,
+         build_time);
+
+  EXPECT_EQ(num_emitters, num_objects * triangles_per_object + num_objects);
+
+  delete scene;
+  delete device;
+}
+
+TEST(light_tree_performance, single_mesh_1M_triangles)
+{
+  benchmark_light_tree_build(1, 1000000);
+}
+
+TEST(light_tree_performance, meshes_1k_objects_1k_triangles)
+{
+  benchmark_light_tree_build(1000, 1000);
+}
+
+TEST(light_tree_performance, meshes_100k_objects_10_triangles)
+{
+  benchmark_light_tree_build(100000, 10);
+}
+
+CCL_NAMESPACE_END
@@ -12,6 +12,7 @@
 #include <tbb/enumerable_thread_specific.h>
 #include <tbb/parallel_for.h>
 #include <tbb/parallel_for_each.h>
+#include <tbb/parallel_reduce.h>
 #include <tbb/task_arena.h>
 #include <tbb/task_group.h>
 
@@ -25,8 +26,10 @@ CCL_NAMESPACE_BEGIN
 
 using tbb::blocked_range;
 using tbb::enumerable_thread_specific;
+using tbb::parallel_deterministic_reduce;
 using tbb::parallel_for;
 using tbb::parallel_for_each;
+using tbb::parallel_reduce;
 
 static inline void thread_capture_fp_settings()
 {
@@ -264,6 +264,48 @@ void MEM_use_lockfree_allocator(void);
  */
 void MEM_use_guarded_allocator(void);
 
+/**
+ * Give the operating system hints about how to back large allocations of the lock-free
+ * allocator, which are mostly big arrays that are processed in parallel. Currently only used on
+ * Linux with glibc, ignored elsewhere and by the guarded allocator. To make sure the advice only
+ * applies to the large blocks themselves, this makes `malloc` give every large block its own
+ * memory mapping by lowering its `M_MMAP_THRESHOLD`.
+ *
+ * \param use_huge_pages: Back them with transparent huge pages, which reduces TLB misses when
+ * they are accessed randomly.
+ * \param use_numa_interleave: Spread their pages over all NUMA nodes, instead of placing them on
+ * the node of the thread that happens to touch them first.
+ *
+ * \note Only affects allocations made after the call.
+ */
+void MEM_use_large_allocation_advice(bool use_huge_pages, bool use_numa_interleave);
+
+/**
+ * Start recording about one allocation per \a sample_interval allocated bytes of the lock-free
+ * allocator, to estimate which allocation names use the most memory without the overhead of the
+ * guarded allocator. Blocks that are allocated while the profiler is running are taken into
+ * account until they are freed.
+ *
+ * \param heap_profile_filepath: When not null, the call stacks of the samples are recorded too
+ * (not supported on all platforms), for #MEM_sampling_profiler_write_heap_profile.
+ *
+ * \note Starting and stopping the profiler can only happen while no other thread allocates.
+ */
+void MEM_sampling_profiler_start(size_t sample_interval, const char *heap_profile_filepath);
+void MEM_sampling_profiler_stop(void);
+bool MEM_sampling_profiler_is_running(void);
+/** Estimated number of blocks and bytes currently allocated with the given name. */
+void MEM_sampling_profiler_stats(const char *name, size_t *r_blocks_num, size_t *r_bytes);
+/** Print the estimated memory usage per allocation name, also done by #MEM_printmemlist_stats. */
+void MEM_sampling_profiler_print_report(void);
+/**
+ * Write the recorded samples to the file passed to #MEM_sampling_profiler_start, in a heap
+ * profile format that `pprof` can read.
+ *
+ * \return false when no file could be written.
+ */
+bool MEM_sampling_profiler_write_heap_profile(void);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
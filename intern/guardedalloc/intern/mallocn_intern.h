@@ -117,6 +117,15 @@ size_t memory_usage_current(void);
 size_t memory_usage_peak(void);
 void memory_usage_peak_reset(void);
 
+/**
+ * Sampling profiler of the lock-free allocator, see `sampling_profiler.cc`.
+ * #sampling_profiler_alloc returns true when the block was sampled, only then
+ * #sampling_profiler_free has to be called when it is freed.
+ */
+extern bool sampling_profiler_is_running;
+bool sampling_profiler_alloc(const void *ptr, size_t len, const char *str);
+void sampling_profiler_free(const void *ptr);
+
 /**
  * Clear the listbase of allocated memory blocks.
  *
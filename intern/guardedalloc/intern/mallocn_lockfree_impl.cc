@@ -14,6 +14,13 @@
 #include <string.h> /* memcpy */
 #include <sys/types.h>
 
+#ifdef __linux__
+#  include <malloc.h>
+#  include <sys/mman.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
 #include "MEM_guardedalloc.h"
 
 /* Quiet warnings when dealing with allocated data written into the blend file.
@@ -44,17 +51,31 @@ static_assert(MEM_MIN_CPP_ALIGNMENT <= sizeof(MemHeadAligned), "Bad size of MemH
 
 static bool malloc_debug_memset = false;
 
+/** Allocations of at least this size get the advice set with #MEM_use_large_allocation_advice. */
+#define LARGE_ALLOC_ADVICE_MIN_LEN (size_t(4) << 20)
+
+static bool large_alloc_use_huge_pages = false;
+static bool large_alloc_use_numa_interleave = false;
+/** Nodes that large allocations are interleaved over, as a bit-mask for `mbind`. */
+static unsigned long large_alloc_numa_nodes = 0;
+/** Size of the pages of the system, advice is given for whole pages. */
+static size_t large_alloc_page_len = 4096;
+
 static void (*error_callback)(const char *) = nullptr;
 
 enum {
   MEMHEAD_ALIGN_FLAG = 1,
+  /** The block was sampled by the sampling profiler. */
+  MEMHEAD_SAMPLED_FLAG = 2,
 };
 
 #define MEMHEAD_FROM_PTR(ptr) (((MemHead *)ptr) - 1)
 #define PTR_FROM_MEMHEAD(memhead) (memhead + 1)
 #define MEMHEAD_ALIGNED_FROM_PTR(ptr) (((MemHeadAligned *)ptr) - 1)
 #define MEMHEAD_IS_ALIGNED(memhead) ((memhead)->len & size_t(MEMHEAD_ALIGN_FLAG))
-#define MEMHEAD_LEN(memhead) ((memhead)->len & ~size_t(MEMHEAD_ALIGN_FLAG))
+#define MEMHEAD_IS_SAMPLED(memhead) ((memhead)->len & size_t(MEMHEAD_SAMPLED_FLAG))
+#define MEMHEAD_LEN(memhead) \
+  ((memhead)->len & ~size_t(MEMHEAD_ALIGN_FLAG | MEMHEAD_SAMPLED_FLAG))
 
 #ifdef __GNUC__
 __attribute__((format(printf, 1, 2)))
@@ -103,6 +124,9 @@ void MEM_lockfree_freeN(void *vmemh)
 
   memory_usage_block_free(len);
 
+  if (UNLIKELY(MEMHEAD_IS_SAMPLED(memh))) {
+    sampling_profiler_free(vmemh);
+  }
   if (UNLIKELY(malloc_debug_memset && len)) {
     memset(memh + 1, 255, len);
   }
@@ -115,6 +139,44 @@ void MEM_lockfree_freeN(void *vmemh)
   }
 }
 
+static void large_alloc_advise(void *ptr, size_t len)
+{
+  if (len < LARGE_ALLOC_ADVICE_MIN_LEN) {
+    return;
+  }
+  if (!(large_alloc_use_huge_pages || large_alloc_use_numa_interleave)) {
+    return;
+  }
+#ifdef __linux__
+  /* The advice is only enabled when `malloc` gives every large block its own mapping, see
+   * #MEM_use_large_allocation_advice. So the advice covers the whole mapping, which doesn't split
+   * it into multiple VMAs, and it doesn't outlive the block because the mapping is removed when
+   * the block is freed. The kernel only uses huge pages for the aligned part of the range. */
+  const uintptr_t page_mask = uintptr_t(large_alloc_page_len - 1);
+  const uintptr_t begin = uintptr_t(ptr) & ~page_mask;
+  const uintptr_t end = (uintptr_t(ptr) + len + page_mask) & ~page_mask;
+  /* Both calls only change how pages are backed when they are touched for the first time, so
+   * this has to happen before the data is written. Fresh mappings are not touched by `calloc`
+   * either, because they are known to be zero. Errors are ignored on purpose, the advice is
+   * optional and the allocation is usable either way. */
+  if (large_alloc_use_huge_pages) {
+    madvise((void *)begin, size_t(end - begin), MADV_HUGEPAGE);
+  }
+  if (large_alloc_use_numa_interleave) {
+    const int mpol_interleave = 3; /* `MPOL_INTERLEAVE` from `numaif.h`. */
+    syscall(SYS_mbind,
+            begin,
+            size_t(end - begin),
+            mpol_interleave,
+            &large_alloc_numa_nodes,
+            sizeof(large_alloc_numa_nodes) * 8,
+            0);
+  }
+#else
+  (void)ptr;
+#endif
+}
+
 void *MEM_lockfree_dupallocN(const void *vmemh)
 {
   void *newp = nullptr;
@@ -143,11 +205,11 @@ void *MEM_lockfree_reallocN_id(void *vmemh, size_t len, const char *str)
     const size_t old_len = MEM_lockfree_allocN_len(vmemh);
 
     if (LIKELY(!MEMHEAD_IS_ALIGNED(memh))) {
-      newp = MEM_lockfree_mallocN(len, "realloc");
+      newp = MEM_lockfree_mallocN(len, str);
     }
     else {
       const MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
-      newp = MEM_lockfree_mallocN_aligned(len, size_t(memh_aligned->alignment), "realloc");
+      newp = MEM_lockfree_mallocN_aligned(len, size_t(memh_aligned->alignment), str);
     }
 
     if (newp) {
@@ -179,11 +241,11 @@ void *MEM_lockfree_recallocN_id(void *vmemh, size_t len, const char *str)
     const size_t old_len = MEM_lockfree_allocN_len(vmemh);
 
     if (LIKELY(!MEMHEAD_IS_ALIGNED(memh))) {
-      newp = MEM_lockfree_mallocN(len, "recalloc");
+      newp = MEM_lockfree_mallocN(len, str);
     }
     else {
       const MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
-      newp = MEM_lockfree_mallocN_aligned(len, size_t(memh_aligned->alignment), "recalloc");
+      newp = MEM_lockfree_mallocN_aligned(len, size_t(memh_aligned->alignment), str);
     }
 
     if (newp) {
@@ -220,7 +282,11 @@ void *MEM_lockfree_callocN(size_t len, const char *str)
   memh = (MemHead *)calloc(1, len + sizeof(MemHead));
 
   if (LIKELY(memh)) {
+    large_alloc_advise(memh + 1, len);
     memh->len = len;
+    if (UNLIKELY(sampling_profiler_is_running) && sampling_profiler_alloc(memh + 1, len, str)) {
+      memh->len |= size_t(MEMHEAD_SAMPLED_FLAG);
+    }
     memory_usage_block_alloc(len);
 
     return PTR_FROM_MEMHEAD(memh);
@@ -264,6 +330,7 @@ void *MEM_lockfree_mallocN(size_t len, const char *str)
   if (LIKELY(memh)) {
 
     if (LIKELY(len)) {
+      large_alloc_advise(memh + 1, len);
       if (UNLIKELY(malloc_debug_memset)) {
         memset(memh + 1, 255, len);
       }
@@ -278,6 +345,9 @@ void *MEM_lockfree_mallocN(size_t len, const char *str)
     }
 
     memh->len = len;
+    if (UNLIKELY(sampling_profiler_is_running) && sampling_profiler_alloc(memh + 1, len, str)) {
+      memh->len |= size_t(MEMHEAD_SAMPLED_FLAG);
+    }
     memory_usage_block_alloc(len);
 
     return PTR_FROM_MEMHEAD(memh);
@@ -345,6 +415,7 @@ void *MEM_lockfree_mallocN_aligned(size_t len, size_t alignment, const char *str
     memh = (MemHeadAligned *)((char *)memh + extra_padding);
 
     if (LIKELY(len)) {
+      large_alloc_advise(memh + 1, len);
       if (UNLIKELY(malloc_debug_memset)) {
         memset(memh + 1, 255, len);
       }
@@ -360,6 +431,9 @@ void *MEM_lockfree_mallocN_aligned(size_t len, size_t alignment, const char *str
 
     memh->len = len | size_t(MEMHEAD_ALIGN_FLAG);
     memh->alignment = short(alignment);
+    if (UNLIKELY(sampling_profiler_is_running) && sampling_profiler_alloc(memh + 1, len, str)) {
+      memh->len |= size_t(MEMHEAD_SAMPLED_FLAG);
+    }
     memory_usage_block_alloc(len);
 
     return PTR_FROM_MEMHEAD(memh);
@@ -417,9 +491,15 @@ void MEM_lockfree_printmemlist_stats()
 {
   printf("\ntotal memory len: %.3f MB\n", double(memory_usage_current()) / double(1024 * 1024));
   printf("peak memory len: %.3f MB\n", double(memory_usage_peak()) / double(1024 * 1024));
-  printf(
-      "\nFor more detailed per-block statistics run Blender with memory debugging command line "
-      "argument.\n");
+  if (sampling_profiler_is_running) {
+    MEM_sampling_profiler_print_report();
+    MEM_sampling_profiler_write_heap_profile();
+  }
+  else {
+    printf(
+        "\nFor more detailed per-block statistics run Blender with memory debugging command line "
+        "argument.\n");
+  }
 
 #ifdef HAVE_MALLOC_STATS
   printf("System Statistics:\n");
@@ -442,6 +522,48 @@ void MEM_lockfree_set_memory_debug()
   malloc_debug_memset = true;
 }
 
+void MEM_use_large_allocation_advice(bool use_huge_pages, bool use_numa_interleave)
+{
+  large_alloc_use_huge_pages = false;
+  large_alloc_use_numa_interleave = false;
+#if defined(__linux__) && defined(__GLIBC__)
+  if (!(use_huge_pages || use_numa_interleave)) {
+    return;
+  }
+  /* Blocks from the heap or an arena share their pages with other blocks, and their pages are
+   * reused for other blocks after they are freed, so advising them would leak the advice to
+   * unrelated allocations. Lowering the threshold also disables its dynamic adjustment, which
+   * would otherwise raise it up to 32 MB after freeing such blocks. In the rare case that `mmap`
+   * fails, `malloc` may still fall back to the heap. */
+  if (mallopt(M_MMAP_THRESHOLD, int(LARGE_ALLOC_ADVICE_MIN_LEN)) == 0) {
+    return;
+  }
+  large_alloc_page_len = size_t(sysconf(_SC_PAGESIZE));
+  large_alloc_use_huge_pages = use_huge_pages;
+  if (use_numa_interleave) {
+    /* Only interleave over the nodes this process may allocate from, passing nodes that don't
+     * exist makes `mbind` fail. */
+    const int mpol_f_mems_allowed = 1 << 2; /* `MPOL_F_MEMS_ALLOWED` from `numaif.h`. */
+    unsigned long nodes = 0;
+    if (syscall(SYS_get_mempolicy,
+                nullptr,
+                &nodes,
+                sizeof(nodes) * 8,
+                nullptr,
+                mpol_f_mems_allowed) == 0)
+    {
+      /* Interleaving over a single node is the same as the default policy. */
+      large_alloc_use_numa_interleave = (nodes & (nodes - 1)) != 0;
+      large_alloc_numa_nodes = nodes;
+    }
+  }
+#else
+  /* Other C libraries give no guarantee that large blocks have their own mapping. */
+  (void)use_huge_pages;
+  (void)use_numa_interleave;
+#endif
+}
+
 size_t MEM_lockfree_get_memory_in_use()
 {
   return memory_usage_current();
@@ -0,0 +1,334 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup intern_mem
+ *
+ * Sampling allocation profiler for the lock-free allocator.
+ *
+ * Instead of recording every allocation like the guarded allocator, only about one allocation
+ * per #sample_interval allocated bytes is recorded. The distance between samples is drawn from
+ * an exponential distribution, which makes the probability of sampling a block only depend on
+ * its size. The estimated memory usage is then obtained by weighting every sample with the
+ * inverse of that probability, like heap profilers of e.g. `tcmalloc` do.
+ *
+ * The overhead for allocations that are not sampled is a thread-local counter decrement, and
+ * freeing them is not affected at all, because sampled blocks are marked in their #MemHead.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+#  include <execinfo.h>
+#  define WITH_SAMPLING_PROFILER_STACKS
+#endif
+
+#include "MEM_guardedalloc.h"
+#include "mallocn_intern.h"
+
+#include "../../source/blender/blenlib/BLI_strict_flags.h"
+
+bool sampling_profiler_is_running = false;
+
+/**
+ * Incremented whenever the profiler is started, so that threads draw a new distance to their
+ * next sample with the current interval. Only changed while the profiler mutex is locked.
+ */
+static std::atomic<uint32_t> sampling_profiler_generation = 0;
+
+namespace {
+
+/** Maximum number of stack frames that are stored per sample. */
+constexpr int sample_stack_max_len = 32;
+
+struct Sample {
+  const char *name;
+  size_t len;
+  int stack_len;
+  void *stack[sample_stack_max_len];
+};
+
+struct Profiler {
+  /** Protects #samples, there are few enough samples for a single mutex. */
+  std::mutex mutex;
+  /** Currently allocated blocks that were sampled, by their pointer. */
+  std::unordered_map<const void *, Sample> samples;
+  /** Average number of allocated bytes between two samples. */
+  size_t sample_interval = 0;
+  /** File that #MEM_sampling_profiler_write_heap_profile writes to, empty if unused. */
+  std::string heap_profile_filepath;
+};
+
+struct LocalSampler {
+  /** Sample the allocation that brings this below zero. */
+  int64_t bytes_until_sample = 0;
+  /** The #sampling_profiler_generation that #bytes_until_sample was drawn for. */
+  uint32_t generation = 0;
+  uint64_t random_state = 0;
+  /** Set while a sample is recorded, to ignore allocations of the profiler itself. */
+  bool is_recording = false;
+};
+
+}  // namespace
+
+static Profiler &get_profiler()
+{
+  /* Never freed, blocks may be freed during destruction of other static variables. */
+  static Profiler *profiler = new Profiler();
+  return *profiler;
+}
+
+static LocalSampler &get_local_sampler()
+{
+  static thread_local LocalSampler sampler;
+  return sampler;
+}
+
+/** Draw the number of bytes until the next sample from an exponential distribution. */
+static int64_t next_sample_distance(LocalSampler &sampler, const size_t sample_interval)
+{
+  if (sampler.random_state == 0) {
+    sampler.random_state = uint64_t(uintptr_t(&sampler)) | 1;
+  }
+  /* Xorshift64*. */
+  sampler.random_state ^= sampler.random_state >> 12;
+  sampler.random_state ^= sampler.random_state << 25;
+  sampler.random_state ^= sampler.random_state >> 27;
+  const uint64_t random = sampler.random_state * 0x2545F4914F6CDD1Dull;
+  /* Uniform in (0, 1], so that the logarithm is finite. */
+  const double uniform = double((random >> 11) + 1) * (1.0 / 9007199254740992.0);
+  return int64_t(-std::log(uniform) * double(sample_interval)) + 1;
+}
+
+/** Inverse of the probability that a block of the given size is sampled. */
+static double sample_weight(const size_t len, const size_t sample_interval)
+{
+  const double probability = -std::expm1(-double(len) / double(sample_interval));
+  return probability > 0.0 ? 1.0 / probability : 0.0;
+}
+
+bool sampling_profiler_alloc(const void *ptr, const size_t len, const char *str)
+{
+  LocalSampler &sampler = get_local_sampler();
+  const uint32_t generation = sampling_profiler_generation.load(std::memory_order_acquire);
+  if (UNLIKELY(sampler.generation != generation)) {
+    /* Starting at zero would always sample the first block of every thread, and weighting it
+     * with the inverse probability would add about a whole interval to the estimate. */
+    sampler.generation = generation;
+    sampler.bytes_until_sample = next_sample_distance(sampler, get_profiler().sample_interval);
+  }
+  sampler.bytes_until_sample -= int64_t(len);
+  if (LIKELY(sampler.bytes_until_sample >= 0) || sampler.is_recording) {
+    return false;
+  }
+  Profiler &profiler = get_profiler();
+  sampler.is_recording = true;
+  sampler.bytes_until_sample = next_sample_distance(sampler, profiler.sample_interval);
+
+  Sample sample;
+  sample.name = str;
+  sample.len = len;
+  sample.stack_len = 0;
+#ifdef WITH_SAMPLING_PROFILER_STACKS
+  if (!profiler.heap_profile_filepath.empty()) {
+    sample.stack_len = backtrace(sample.stack, sample_stack_max_len);
+  }
+#endif
+  {
+    std::lock_guard lock{profiler.mutex};
+    profiler.samples.insert_or_assign(ptr, sample);
+  }
+  sampler.is_recording = false;
+  return true;
+}
+
+void sampling_profiler_free(const void *ptr)
+{
+  Profiler &profiler = get_profiler();
+  std::lock_guard lock{profiler.mutex};
+  /* The block may have been sampled by a profiler run that has been stopped since. */
+  profiler.samples.erase(ptr);
+}
+
+void MEM_sampling_profiler_start(const size_t sample_interval, const char *heap_profile_filepath)
+{
+  Profiler &profiler = get_profiler();
+  std::lock_guard lock{profiler.mutex};
+  profiler.samples.clear();
+  profiler.sample_interval = std::max<size_t>(sample_interval, 1);
+  profiler.heap_profile_filepath = heap_profile_filepath ? heap_profile_filepath : "";
+  sampling_profiler_generation.fetch_add(1, std::memory_order_release);
+  sampling_profiler_is_running = true;
+}
+
+void MEM_sampling_profiler_stop()
+{
+  Profiler &profiler = get_profiler();
+  std::lock_guard lock{profiler.mutex};
+  sampling_profiler_is_running = false;
+  profiler.samples.clear();
+}
+
+bool MEM_sampling_profiler_is_running()
+{
+  return sampling_profiler_is_running;
+}
+
+void MEM_sampling_profiler_stats(const char *name, size_t *r_blocks_num, size_t *r_bytes)
+{
+  Profiler &profiler = get_profiler();
+  std::lock_guard lock{profiler.mutex};
+  double blocks_num = 0.0;
+  double bytes = 0.0;
+  for (const auto &item : profiler.samples) {
+    const Sample &sample = item.second;
+    if (strcmp(sample.name, name) == 0) {
+      const double weight = sample_weight(sample.len, profiler.sample_interval);
+      blocks_num += weight;
+      bytes += weight * double(sample.len);
+    }
+  }
+  *r_blocks_num = size_t(std::round(blocks_num));
+  *r_bytes = size_t(std::round(bytes));
+}
+
+void MEM_sampling_profiler_print_report()
+{
+  struct NameStats {
+    std::string_view name;
+    double blocks_num = 0.0;
+    double bytes = 0.0;
+  };
+  LocalSampler &sampler = get_local_sampler();
+  /* Don't sample the allocations of the containers below, that would lock the mutex again. */
+  sampler.is_recording = true;
+  std::vector<NameStats> stats;
+  size_t samples_num;
+  {
+    Profiler &profiler = get_profiler();
+    std::lock_guard lock{profiler.mutex};
+    samples_num = profiler.samples.size();
+    /* Different pointers can have the same name, e.g. for string literals in different files. */
+    std::unordered_map<std::string_view, size_t> stats_index_by_name;
+    for (const auto &item : profiler.samples) {
+      const Sample &sample = item.second;
+      const auto [it, is_new] = stats_index_by_name.emplace(sample.name, stats.size());
+      if (is_new) {
+        stats.push_back({sample.name});
+      }
+      const double weight = sample_weight(sample.len, profiler.sample_interval);
+      stats[it->second].blocks_num += weight;
+      stats[it->second].bytes += weight * double(sample.len);
+    }
+  }
+  sampler.is_recording = false;
+  std::sort(stats.begin(), stats.end(), [](const NameStats &a, const NameStats &b) {
+    return a.bytes > b.bytes;
+  });
+
+  double total_bytes = 0.0;
+  for (const NameStats &item : stats) {
+    total_bytes += item.bytes;
+  }
+  printf("\nsampled memory usage by name (estimated from " SIZET_FORMAT " samples):\n",
+         SIZET_ARG(samples_num));
+  printf("%10s %10s %6s  %s\n", "MB", "blocks", "%", "name");
+  for (const NameStats &item : stats) {
+    printf("%10.3f %10.0f %6.2f  %.*s\n",
+           item.bytes / (1024.0 * 1024.0),
+           item.blocks_num,
+           total_bytes > 0.0 ? item.bytes / total_bytes * 100.0 : 0.0,
+           int(item.name.size()),
+           item.name.data());
+  }
+  printf("%10.3f MB total\n", total_bytes / (1024.0 * 1024.0));
+}
+
+bool MEM_sampling_profiler_write_heap_profile()
+{
+#ifdef WITH_SAMPLING_PROFILER_STACKS
+  LocalSampler &sampler = get_local_sampler();
+  Profiler &profiler = get_profiler();
+
+  /* Samples with the same stack are merged into one line. */
+  struct StackStats {
+    size_t blocks_num = 0;
+    size_t bytes = 0;
+  };
+  std::unordered_map<std::string_view, StackStats> stats_by_stack;
+  size_t total_blocks_num = 0;
+  size_t total_bytes = 0;
+
+  std::lock_guard lock{profiler.mutex};
+  if (profiler.heap_profile_filepath.empty()) {
+    return false;
+  }
+  /* Don't sample the allocations of the containers below, that would lock the mutex again. */
+  sampler.is_recording = true;
+  for (const auto &item : profiler.samples) {
+    const Sample &sample = item.second;
+    const std::string_view stack{reinterpret_cast<const char *>(sample.stack),
+                                 sizeof(void *) * size_t(sample.stack_len)};
+    StackStats &stats = stats_by_stack[stack];
+    stats.blocks_num++;
+    stats.bytes += sample.len;
+    total_blocks_num++;
+    total_bytes += sample.len;
+  }
+
+  FILE *file = fopen(profiler.heap_profile_filepath.c_str(), "w");
+  if (file) {
+    /* The legacy text format of `gperftools`, which `pprof` can read. The `heap_v2` header makes
+     * `pprof` scale the raw sample counts with the same exponential sampling model. */
+    fprintf(file,
+            "heap profile: " SIZET_FORMAT ": " SIZET_FORMAT " [" SIZET_FORMAT ": " SIZET_FORMAT
+            "] @ heap_v2/" SIZET_FORMAT "\n",
+            SIZET_ARG(total_blocks_num),
+            SIZET_ARG(total_bytes),
+            SIZET_ARG(total_blocks_num),
+            SIZET_ARG(total_bytes),
+            SIZET_ARG(profiler.sample_interval));
+    for (const auto &item : stats_by_stack) {
+      fprintf(file,
+              SIZET_FORMAT ": " SIZET_FORMAT " [" SIZET_FORMAT ": " SIZET_FORMAT "] @",
+              SIZET_ARG(item.second.blocks_num),
+              SIZET_ARG(item.second.bytes),
+              SIZET_ARG(item.second.blocks_num),
+              SIZET_ARG(item.second.bytes));
+      const void *const *stack = reinterpret_cast<const void *const *>(item.first.data());
+      const size_t stack_len = item.first.size() / sizeof(void *);
+      for (size_t i = 0; i < stack_len; i++) {
+        fprintf(file, " %p", stack[i]);
+      }
+      fprintf(file, "\n");
+    }
+#  ifdef __linux__
+    /* Needed by `pprof` to map the addresses to symbols. */
+    fprintf(file, "\nMAPPED_LIBRARIES:\n");
+    if (FILE *maps = fopen("/proc/self/maps", "r")) {
+      char buf[4096];
+      size_t buf_len;
+      while ((buf_len = fread(buf, 1, sizeof(buf), maps)) > 0) {
+        fwrite(buf, 1, buf_len, file);
+      }
+      fclose(maps);
+    }
+#  endif
+    fclose(file);
+  }
+  sampler.is_recording = false;
+  return file != nullptr;
+#else
+  return false;
+#endif
+}
@@ -0,0 +1,107 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include <thread>
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "guardedalloc_test_base.h"
+
+TEST_F(LockFreeAllocatorTest, sampling_profiler_all_samples)
+{
+  /* With an interval of one byte, every block is sampled with a weight of one. */
+  MEM_sampling_profiler_start(1, nullptr);
+  EXPECT_TRUE(MEM_sampling_profiler_is_running());
+
+  void *blocks[4];
+  blocks[0] = MEM_mallocN(1000, "sampling_test");
+  blocks[1] = MEM_callocN(1000, "sampling_test");
+  blocks[2] = MEM_mallocN_aligned(1000, 64, "sampling_test");
+  blocks[3] = MEM_mallocN(2000, "sampling_test_other");
+
+  size_t blocks_num, bytes;
+  MEM_sampling_profiler_stats("sampling_test", &blocks_num, &bytes);
+  EXPECT_EQ(blocks_num, 3);
+  EXPECT_EQ(bytes, 3000);
+  MEM_sampling_profiler_stats("sampling_test_other", &blocks_num, &bytes);
+  EXPECT_EQ(blocks_num, 1);
+  EXPECT_EQ(bytes, 2000);
+
+  /* The sample flag must not change the length of the blocks. */
+  EXPECT_EQ(MEM_allocN_len(blocks[0]), 1000);
+  EXPECT_EQ(MEM_allocN_len(blocks[2]), 1000);
+
+  blocks[0] = MEM_reallocN_id(blocks[0], 500, "sampling_test_realloc");
+  MEM_freeN(blocks[1]);
+  MEM_sampling_profiler_stats("sampling_test", &blocks_num, &bytes);
+  EXPECT_EQ(blocks_num, 1);
+  EXPECT_EQ(bytes, 1000);
+  MEM_sampling_profiler_stats("sampling_test_realloc", &blocks_num, &bytes);
+  EXPECT_EQ(blocks_num, 1);
+  EXPECT_EQ(bytes, 500);
+
+  MEM_sampling_profiler_stop();
+  EXPECT_FALSE(MEM_sampling_profiler_is_running());
+  MEM_sampling_profiler_stats("sampling_test", &blocks_num, &bytes);
+  EXPECT_EQ(blocks_num, 0);
+
+  /* Blocks that were sampled by a stopped profiler can still be freed. */
+  MEM_freeN(blocks[0]);
+  MEM_freeN(blocks[2]);
+  MEM_freeN(blocks[3]);
+}
+
+TEST_F(LockFreeAllocatorTest, sampling_profiler_estimate)
+{
+  MEM_sampling_profiler_start(64 * 1024, nullptr);
+
+  const int blocks_num = 100000;
+  const size_t block_len = 1024;
+  void **blocks = static_cast<void **>(malloc(sizeof(void *) * blocks_num));
+  for (int i = 0; i < blocks_num; i++) {
+    blocks[i] = MEM_mallocN(block_len, "sampling_estimate");
+  }
+
+  size_t estimated_blocks_num, estimated_bytes;
+  MEM_sampling_profiler_stats("sampling_estimate", &estimated_blocks_num, &estimated_bytes);
+  /* About 1600 samples, so the estimate is well within 20% of the real usage. */
+  EXPECT_NEAR(double(estimated_bytes), double(blocks_num * block_len), blocks_num * block_len / 5);
+  EXPECT_NEAR(double(estimated_blocks_num), double(blocks_num), blocks_num / 5);
+
+  MEM_sampling_profiler_stop();
+  for (int i = 0; i < blocks_num; i++) {
+    MEM_freeN(blocks[i]);
+  }
+  free(blocks);
+}
+
+/** Allocate a small block and check that it was not sampled. */
+static void expect_small_block_not_sampled()
+{
+  void *block = MEM_mallocN(16, "sampling_first_block");
+  size_t blocks_num, bytes;
+  MEM_sampling_profiler_stats("sampling_first_block", &blocks_num, &bytes);
+  EXPECT_EQ(blocks_num, 0);
+  EXPECT_EQ(bytes, 0);
+  MEM_freeN(block);
+}
+
+TEST_F(LockFreeAllocatorTest, sampling_profiler_first_block_unbiased)
+{
+  /* The first small block after starting the profiler, or on a new thread, should almost never
+   * be sampled. If it was sampled anyway, it would be counted as about a whole interval. */
+  for (int i = 0; i < 100; i++) {
+    /* Leave a short distance to the next sample from a run with a small interval. */
+    MEM_sampling_profiler_start(1, nullptr);
+    MEM_freeN(MEM_mallocN(16, "sampling_previous_run"));
+
+    MEM_sampling_profiler_start(64 * 1024 * 1024, nullptr);
+    expect_small_block_not_sampled();
+    std::thread thread(expect_small_block_not_sampled);
+    thread.join();
+    MEM_sampling_profiler_stop();
+  }
+}
@@ -1072,6 +1072,9 @@ class CompositorPerformanceButtonsPanel:
         row = col.row()
         row.prop(rd, "compositor_device", text="Device", expand=True)
         col.prop(rd, "compositor_precision", text="Precision")
+        sub = col.column()
+        sub.active = rd.compositor_device == 'CPU'
+        sub.prop(rd, "compositor_memory_limit", text="Memory Limit")
 
 
 class RENDER_PT_eevee_performance_compositor(RenderButtonsPanel, CompositorPerformanceButtonsPanel, Panel):
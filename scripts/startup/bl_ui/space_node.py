@@ -845,6 +845,9 @@ class NODE_PT_quality(bpy.types.Panel):
         col = layout.column()
         col.prop(rd, "compositor_device", text="Device")
         col.prop(rd, "compositor_precision", text="Precision")
+        sub = col.column()
+        sub.active = rd.compositor_device == 'CPU'
+        sub.prop(rd, "compositor_memory_limit", text="Memory Limit")
 
         col = layout.column()
         col.prop(tree, "use_viewer_border")
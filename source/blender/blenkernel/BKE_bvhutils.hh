@@ -16,6 +16,7 @@
 #include "BLI_kdopbvh.h"
 #include "BLI_math_vector_types.hh"
 #include "BLI_span.hh"
+#include "BLI_virtual_array_fwd.hh"
 
 struct BVHCache;
 struct BVHTree;
@@ -147,6 +148,37 @@ void BKE_bvhtree_from_mesh_verts_init(const Mesh &mesh,
  */
 void free_bvhtree_from_mesh(BVHTreeFromMesh *data);
 
+/**
+ * Find the nearest element of the tree for every position in the mask. The queries are sorted
+ * along a space filling curve and each one first tests the nearest element of the previous query,
+ * which usually prunes most of the tree traversal when neighboring positions are close.
+ *
+ * \param r_nearest: One result for every index in the mask, in the same order. The `dist_sq`
+ * must be initialized to the maximum squared distance to search, `index` is set to -1 when no
+ * element closer than that is found.
+ */
+void BKE_bvhtree_find_nearest_batch(const BVHTree *tree,
+                                    BVHTree_NearestPointCallback callback,
+                                    void *userdata,
+                                    const blender::IndexMask &mask,
+                                    const blender::VArray<blender::float3> &positions,
+                                    blender::MutableSpan<BVHTreeNearest> r_nearest);
+
+/**
+ * Ray-cast every ray in the mask, see #BKE_bvhtree_find_nearest_batch. Each ray first tests the
+ * element hit by the previous ray, which usually shortens the ray before traversing the tree.
+ *
+ * \param r_hits: One result for every index in the mask, in the same order. The `dist` must be
+ * initialized to the length of the ray, `index` is set to -1 when nothing is hit.
+ */
+void BKE_bvhtree_ray_cast_batch(const BVHTree *tree,
+                                BVHTree_RayCastCallback callback,
+                                void *userdata,
+                                const blender::IndexMask &mask,
+                                const blender::VArray<blender::float3> &origins,
+                                const blender::VArray<blender::float3> &directions,
+                                blender::MutableSpan<BVHTreeRayHit> r_hits);
+
 /**
  * Math functions used by callbacks
  */
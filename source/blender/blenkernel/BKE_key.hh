@@ -100,6 +100,16 @@ KeyBlock *BKE_keyblock_find_uid(Key *key, int uid);
  * \brief copy shape-key attributes, but not key data or name/UID.
  */
 void BKE_keyblock_copy_settings(KeyBlock *kb_dst, const KeyBlock *kb_src);
+/**
+ * Free the data array of the shape-key, or only release the reference to it when it is shared
+ * with evaluated copies of the key.
+ */
+void BKE_keyblock_data_free(KeyBlock *kb);
+/**
+ * Make sure the data array of the shape-key is not shared with evaluated copies of the key.
+ * Must be called before modifying the array in place.
+ */
+void BKE_keyblock_data_ensure_mutable(KeyBlock *kb);
 /**
  * Get RNA-Path for 'value' setting of the given shape-key.
  * \note the user needs to free the returned string once they're finished with it.
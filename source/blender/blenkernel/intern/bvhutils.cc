@@ -9,19 +9,28 @@
 #include "DNA_meshdata_types.h"
 #include "DNA_pointcloud_types.h"
 
+#include "BLI_array.hh"
+#include "BLI_array_utils.hh"
+#include "BLI_bounds.hh"
 #include "BLI_math_geom.h"
+#include "BLI_math_vector.hh"
+#include "BLI_sort.hh"
 #include "BLI_task.h"
+#include "BLI_task.hh"
 
 #include "BKE_attribute.hh"
 #include "BKE_bvhutils.hh"
 #include "BKE_editmesh.hh"
 #include "BKE_mesh.hh"
 
+using blender::Array;
 using blender::BitSpan;
 using blender::BitVector;
 using blender::float3;
+using blender::IndexMask;
 using blender::IndexRange;
 using blender::int3;
+using blender::MutableSpan;
 using blender::Span;
 using blender::VArray;
 
@@ -1168,6 +1177,131 @@ void free_bvhtree_from_mesh(BVHTreeFromMesh *data)
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Batched Queries
+ * \{ */
+
+/** Spread the lower 21 bits of the value, with two zero bits between each of them. */
+static uint64_t morton_expand_bits(uint64_t v)
+{
+  v &= 0x1fffff;
+  v = (v | v << 32) & 0x1f00000000ffff;
+  v = (v | v << 16) & 0x1f0000ff0000ff;
+  v = (v | v << 8) & 0x100f00f00f00f00f;
+  v = (v | v << 4) & 0x10c30c30c30c30c3;
+  v = (v | v << 2) & 0x1249249249249249;
+  return v;
+}
+
+/**
+ * Order the queries along a Morton curve of their positions, so that consecutive queries are
+ * close to each other and traverse the same parts of the tree.
+ *
+ * \return The order of the queries, as indices into \a r_positions.
+ */
+static Array<int> sort_queries_spatially(const IndexMask &mask,
+                                         const VArray<float3> &positions,
+                                         Array<float3> &r_positions)
+{
+  using namespace blender;
+  r_positions.reinitialize(mask.size());
+  positions.materialize_compressed(mask, r_positions);
+
+  Array<int> order(mask.size());
+  array_utils::fill_index_range<int>(order);
+
+  const std::optional<Bounds<float3>> bounds = bounds::min_max(r_positions.as_span());
+  if (!bounds) {
+    return order;
+  }
+  const float max_coord = float((1 << 21) - 1);
+  const float3 scale = math::safe_divide(float3(max_coord), bounds->max - bounds->min);
+
+  Array<uint64_t> codes(mask.size());
+  threading::parallel_for(codes.index_range(), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      const float3 co = math::clamp((r_positions[i] - bounds->min) * scale, 0.0f, max_coord);
+      codes[i] = morton_expand_bits(uint64_t(co.x)) | (morton_expand_bits(uint64_t(co.y)) << 1) |
+                 (morton_expand_bits(uint64_t(co.z)) << 2);
+    }
+  });
+  parallel_sort(
+      order.begin(), order.end(), [&](const int a, const int b) { return codes[a] < codes[b]; });
+  return order;
+}
+
+void BKE_bvhtree_find_nearest_batch(const BVHTree *tree,
+                                    BVHTree_NearestPointCallback callback,
+                                    void *userdata,
+                                    const IndexMask &mask,
+                                    const VArray<float3> &positions,
+                                    MutableSpan<BVHTreeNearest> r_nearest)
+{
+  BLI_assert(r_nearest.size() == mask.size());
+  Array<float3> mask_positions;
+  const Array<int> order = sort_queries_spatially(mask, positions, mask_positions);
+
+  blender::threading::parallel_for(order.index_range(), 512, [&](const IndexRange range) {
+    int prev_index = -1;
+    for (const int i : order.as_span().slice(range)) {
+      const float3 &co = mask_positions[i];
+      BVHTreeNearest &nearest = r_nearest[i];
+      nearest.index = -1;
+      /* Without callback, the distance to an element is only known by the tree. */
+      if (prev_index != -1 && callback) {
+        callback(userdata, prev_index, co, &nearest);
+      }
+      BLI_bvhtree_find_nearest(tree, co, &nearest, callback, userdata);
+      if (nearest.index != -1) {
+        prev_index = nearest.index;
+      }
+    }
+  });
+}
+
+void BKE_bvhtree_ray_cast_batch(const BVHTree *tree,
+                                BVHTree_RayCastCallback callback,
+                                void *userdata,
+                                const IndexMask &mask,
+                                const VArray<float3> &origins,
+                                const VArray<float3> &directions,
+                                MutableSpan<BVHTreeRayHit> r_hits)
+{
+  BLI_assert(r_hits.size() == mask.size());
+  Array<float3> mask_origins;
+  const Array<int> order = sort_queries_spatially(mask, origins, mask_origins);
+  Array<float3> mask_directions(mask.size());
+  directions.materialize_compressed(mask, mask_directions.as_mutable_span());
+
+  blender::threading::parallel_for(order.index_range(), 512, [&](const IndexRange range) {
+    int prev_index = -1;
+    for (const int i : order.as_span().slice(range)) {
+      BVHTreeRayHit &hit = r_hits[i];
+      hit.index = -1;
+      if (prev_index != -1 && callback) {
+        /* Same ray as the one passed to callbacks by #BLI_bvhtree_ray_cast. */
+        BVHTreeRay ray;
+        copy_v3_v3(ray.origin, mask_origins[i]);
+        copy_v3_v3(ray.direction, mask_directions[i]);
+        ray.radius = 0.0f;
+#ifdef USE_KDOPBVH_WATERTIGHT
+        IsectRayPrecalc isect_precalc;
+        isect_ray_tri_watertight_v3_precalc(&isect_precalc, ray.direction);
+        ray.isect_precalc = &isect_precalc;
+#endif
+        callback(userdata, prev_index, &ray, &hit);
+      }
+      BLI_bvhtree_ray_cast(
+          tree, mask_origins[i], mask_directions[i], 0.0f, &hit, callback, userdata);
+      if (hit.index != -1) {
+        prev_index = hit.index;
+      }
+    }
+  });
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Point Cloud BVH Building
  * \{ */
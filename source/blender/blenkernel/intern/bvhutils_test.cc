@@ -0,0 +1,234 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_index_mask.hh"
+#include "BLI_math_geom.h"
+#include "BLI_math_vector.hh"
+#include "BLI_rand.hh"
+#include "BLI_vector.hh"
+#include "BLI_virtual_array.hh"
+
+#include "BKE_bvhutils.hh"
+
+namespace blender::bke::tests {
+
+/** Random small triangles in a unit sphere, with a tree of their bounds. */
+class BVHTreeBatchTest : public testing::Test {
+ protected:
+  Array<float3> tri_positions;
+  BVHTree *tree = nullptr;
+
+  void SetUp() override
+  {
+    RandomNumberGenerator rng(42);
+    const int tris_num = 2000;
+    tri_positions.reinitialize(tris_num * 3);
+    tree = BLI_bvhtree_new(tris_num, 0.0f, 4, 6);
+    for (const int i : IndexRange(tris_num)) {
+      const float3 center = rng.get_unit_float3() * rng.get_float();
+      for (const int j : IndexRange(3)) {
+        tri_positions[i * 3 + j] = center + rng.get_unit_float3() * 0.05f;
+      }
+      BLI_bvhtree_insert(tree, i, reinterpret_cast<float *>(&tri_positions[i * 3]), 3);
+    }
+    BLI_bvhtree_balance(tree);
+  }
+
+  void TearDown() override
+  {
+    BLI_bvhtree_free(tree);
+  }
+
+  static void nearest_callback(void *userdata,
+                               const int index,
+                               const float co[3],
+                               BVHTreeNearest *nearest)
+  {
+    const float3 *tri = &static_cast<const float3 *>(userdata)[index * 3];
+    float3 closest;
+    closest_on_tri_to_point_v3(closest, co, tri[0], tri[1], tri[2]);
+    const float dist_sq = math::distance_squared(float3(co), closest);
+    if (dist_sq < nearest->dist_sq) {
+      nearest->index = index;
+      nearest->dist_sq = dist_sq;
+      copy_v3_v3(nearest->co, closest);
+    }
+  }
+
+  static void raycast_callback(void *userdata,
+                               const int index,
+                               const BVHTreeRay *ray,
+                               BVHTreeRayHit *hit)
+  {
+    const float3 *tri = &static_cast<const float3 *>(userdata)[index * 3];
+    float dist;
+    if (isect_ray_tri_v3(ray->origin, ray->direction, tri[0], tri[1], tri[2], &dist, nullptr) &&
+        dist < hit->dist)
+    {
+      hit->index = index;
+      hit->dist = dist;
+      madd_v3_v3v3fl(hit->co, ray->origin, ray->direction, dist);
+    }
+  }
+};
+
+static Array<float3> random_positions(const int size, const uint32_t seed)
+{
+  RandomNumberGenerator rng(seed);
+  Array<float3> positions(size);
+  for (float3 &position : positions) {
+    position = rng.get_unit_float3() * rng.get_float() * 1.2f;
+  }
+  return positions;
+}
+
+/** Full, non-contiguous and randomly sampled masks of the queries. */
+static Vector<IndexMask> test_masks(const int size, IndexMaskMemory &memory)
+{
+  RandomNumberGenerator rng(7);
+  Vector<IndexMask> masks;
+  masks.append(IndexMask(size));
+  masks.append(IndexMask::from_predicate(
+      IndexRange(size), GrainSize(512), memory, [](const int i) { return i % 3 != 0; }));
+  masks.append(IndexMask::from_predicate(IndexRange(size), GrainSize(512), memory, [&](int) {
+    return rng.get_float() < 0.1f;
+  }));
+  return masks;
+}
+
+TEST_F(BVHTreeBatchTest, find_nearest)
+{
+  const Array<float3> positions = random_positions(5000, 1);
+  /* Read through a function, like a field that isn't stored in an array. */
+  const VArray<float3> positions_varray = VArray<float3>::ForFunc(
+      positions.size(), [&](const int64_t i) { return positions[i]; });
+  IndexMaskMemory memory;
+  for (const IndexMask &mask : test_masks(positions.size(), memory)) {
+    /* Only search around some of the positions, the others find nothing. */
+    const auto max_dist_sq = [](const int i) { return i % 5 == 0 ? 0.001f : FLT_MAX; };
+
+    Array<BVHTreeNearest> nearest(mask.size());
+    mask.foreach_index([&](const int i, const int pos) { nearest[pos].dist_sq = max_dist_sq(i); });
+    BKE_bvhtree_find_nearest_batch(
+        tree, nearest_callback, tri_positions.data(), mask, positions_varray, nearest);
+
+    mask.foreach_index([&](const int i, const int pos) {
+      BVHTreeNearest expected;
+      expected.index = -1;
+      expected.dist_sq = max_dist_sq(i);
+      BLI_bvhtree_find_nearest(
+          tree, positions[i], &expected, nearest_callback, tri_positions.data());
+      EXPECT_EQ(nearest[pos].index, expected.index) << "query " << i;
+      if (expected.index != -1) {
+        EXPECT_EQ(nearest[pos].dist_sq, expected.dist_sq);
+        EXPECT_EQ(float3(nearest[pos].co), float3(expected.co));
+      }
+    });
+  }
+}
+
+TEST_F(BVHTreeBatchTest, find_nearest_without_callback)
+{
+  const Array<float3> positions = random_positions(5000, 2);
+  const VArray<float3> positions_varray = VArray<float3>::ForSpan(positions);
+  IndexMaskMemory memory;
+  for (const IndexMask &mask : test_masks(positions.size(), memory)) {
+    Array<BVHTreeNearest> nearest(mask.size());
+    for (BVHTreeNearest &item : nearest) {
+      item.dist_sq = FLT_MAX;
+    }
+    BKE_bvhtree_find_nearest_batch(tree, nullptr, nullptr, mask, positions_varray, nearest);
+
+    mask.foreach_index([&](const int i, const int pos) {
+      BVHTreeNearest expected;
+      expected.index = -1;
+      expected.dist_sq = FLT_MAX;
+      BLI_bvhtree_find_nearest(tree, positions[i], &expected, nullptr, nullptr);
+      EXPECT_EQ(nearest[pos].index, expected.index) << "query " << i;
+      EXPECT_EQ(nearest[pos].dist_sq, expected.dist_sq);
+    });
+  }
+}
+
+TEST_F(BVHTreeBatchTest, ray_cast)
+{
+  const Array<float3> origins = random_positions(5000, 3);
+  Array<float3> directions = random_positions(origins.size(), 4);
+  for (float3 &direction : directions) {
+    direction = math::normalize(direction);
+  }
+  const VArray<float3> origins_varray = VArray<float3>::ForFunc(
+      origins.size(), [&](const int64_t i) { return origins[i]; });
+  const VArray<float3> directions_varray = VArray<float3>::ForSpan(directions);
+  IndexMaskMemory memory;
+  for (const IndexMask &mask : test_masks(origins.size(), memory)) {
+    /* Rays of different lengths, the short ones often hit nothing. */
+    const auto ray_length = [](const int i) { return i % 4 == 0 ? 0.1f : BVH_RAYCAST_DIST_MAX; };
+
+    Array<BVHTreeRayHit> hits(mask.size());
+    mask.foreach_index([&](const int i, const int pos) { hits[pos].dist = ray_length(i); });
+    BKE_bvhtree_ray_cast_batch(tree,
+                               raycast_callback,
+                               tri_positions.data(),
+                               mask,
+                               origins_varray,
+                               directions_varray,
+                               hits);
+
+    mask.foreach_index([&](const int i, const int pos) {
+      BVHTreeRayHit expected;
+      expected.index = -1;
+      expected.dist = ray_length(i);
+      BLI_bvhtree_ray_cast(tree,
+                           origins[i],
+                           directions[i],
+                           0.0f,
+                           &expected,
+                           raycast_callback,
+                           tri_positions.data());
+      EXPECT_EQ(hits[pos].index, expected.index) << "ray " << i;
+      EXPECT_EQ(hits[pos].dist, expected.dist);
+      if (expected.index != -1) {
+        EXPECT_EQ(float3(hits[pos].co), float3(expected.co));
+      }
+    });
+  }
+}
+
+TEST_F(BVHTreeBatchTest, ray_cast_single_direction)
+{
+  const Array<float3> origins = random_positions(5000, 5);
+  const VArray<float3> origins_varray = VArray<float3>::ForSpan(origins);
+  const float3 direction = math::normalize(float3(0.3f, -1.0f, 0.2f));
+  const VArray<float3> directions_varray = VArray<float3>::ForSingle(direction, origins.size());
+  IndexMaskMemory memory;
+  for (const IndexMask &mask : test_masks(origins.size(), memory)) {
+    Array<BVHTreeRayHit> hits(mask.size());
+    for (BVHTreeRayHit &hit : hits) {
+      hit.dist = BVH_RAYCAST_DIST_MAX;
+    }
+    BKE_bvhtree_ray_cast_batch(tree,
+                               raycast_callback,
+                               tri_positions.data(),
+                               mask,
+                               origins_varray,
+                               directions_varray,
+                               hits);
+
+    mask.foreach_index([&](const int i, const int pos) {
+      BVHTreeRayHit expected;
+      expected.index = -1;
+      expected.dist = BVH_RAYCAST_DIST_MAX;
+      BLI_bvhtree_ray_cast(
+          tree, origins[i], direction, 0.0f, &expected, raycast_callback, tri_positions.data());
+      EXPECT_EQ(hits[pos].index, expected.index) << "ray " << i;
+      EXPECT_EQ(hits[pos].dist, expected.dist);
+    });
+  }
+}
+
+}  // namespace blender::bke::tests
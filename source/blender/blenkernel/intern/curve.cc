@@ -5207,6 +5207,7 @@ void BKE_curve_transform_ex(Curve *cu,
 
   if (do_keys && cu->key) {
     LISTBASE_FOREACH (KeyBlock *, kb, &cu->key->block) {
+      BKE_keyblock_data_ensure_mutable(kb);
       float *fp = (float *)kb->data;
       int n = kb->totelem;
 
@@ -5265,6 +5266,7 @@ void BKE_curve_translate(Curve *cu, const float offset[3], const bool do_keys)
 
   if (do_keys && cu->key) {
     LISTBASE_FOREACH (KeyBlock *, kb, &cu->key->block) {
+      BKE_keyblock_data_ensure_mutable(kb);
       float *fp = (float *)kb->data;
       int n = kb->totelem;
 
@@ -109,9 +109,7 @@ void BKE_editlattice_load(Object *obedit)
     /* active key: vertices */
     tot = editlt->pntsu * editlt->pntsv * editlt->pntsw;
 
-    if (actkey->data) {
-      MEM_freeN(actkey->data);
-    }
+    BKE_keyblock_data_free(actkey);
 
     fp = static_cast<float *>(actkey->data = MEM_callocN(lt->key->elemsize * tot, "actkey->data"));
     actkey->totelem = tot;
@@ -9,12 +9,14 @@
 #include <cmath>
 #include <cstddef>
 #include <cstring>
+#include <mutex>
 #include <optional>
 
 #include "MEM_guardedalloc.h"
 
 #include "BLI_blenlib.h"
 #include "BLI_endian_switch.h"
+#include "BLI_implicit_sharing.hh"
 #include "BLI_math_matrix.h"
 #include "BLI_math_vector.h"
 #include "BLI_string_utils.hh"
@@ -55,24 +57,56 @@
 
 #include "BLO_read_write.hh"
 
+/**
+ * Make the data array of an original key block shareable. This is done lazily, as there are many
+ * places that allocate the array, and most keys are never copied.
+ */
+static const blender::ImplicitSharingInfo *keyblock_data_sharing_info_ensure(const KeyBlock *kb)
+{
+  BLI_assert(kb->data != nullptr);
+  /* Multiple depsgraphs might make evaluated copies of the same key at the same time. The pointer
+   * is a plain DNA member, so it is only read under the lock. Otherwise another thread could see
+   * it before the sharing info it points to is fully constructed. */
+  static std::mutex mutex;
+  std::lock_guard lock(mutex);
+  if (kb->data_sharing_info == nullptr) {
+    const_cast<KeyBlock *>(kb)->data_sharing_info = blender::implicit_sharing::info_for_mem_free(
+        kb->data);
+  }
+  return kb->data_sharing_info;
+}
+
 static void shapekey_copy_data(Main * /*bmain*/,
                                std::optional<Library *> /*owner_library*/,
                                ID *id_dst,
                                const ID *id_src,
-                               const int /*flag*/)
+                               const int flag)
 {
   Key *key_dst = (Key *)id_dst;
   const Key *key_src = (const Key *)id_src;
   BLI_duplicatelist(&key_dst->block, &key_src->block);
 
+  /* Evaluated copies only read the shape data, so it is shared with the source instead of being
+   * duplicated. Modifications of the original data make it mutable first. */
+  const bool share_data = (flag & LIB_ID_COPY_SET_COPIED_ON_WRITE) != 0;
+
   KeyBlock *kb_dst, *kb_src;
   for (kb_src = static_cast<KeyBlock *>(key_src->block.first),
       kb_dst = static_cast<KeyBlock *>(key_dst->block.first);
        kb_dst;
        kb_src = kb_src->next, kb_dst = kb_dst->next)
   {
+    kb_dst->data_sharing_info = nullptr;
     if (kb_dst->data) {
-      kb_dst->data = MEM_dupallocN(kb_dst->data);
+      if (share_data) {
+        blender::implicit_sharing::copy_shared_pointer(kb_src->data,
+                                                       keyblock_data_sharing_info_ensure(kb_src),
+                                                       &kb_dst->data,
+                                                       &kb_dst->data_sharing_info);
+      }
+      else {
+        kb_dst->data = MEM_dupallocN(kb_dst->data);
+      }
     }
     if (kb_src == key_src->refkey) {
       key_dst->refkey = kb_dst;
@@ -84,9 +118,7 @@ static void shapekey_free_data(ID *id)
 {
   Key *key = (Key *)id;
   while (KeyBlock *kb = static_cast<KeyBlock *>(BLI_pophead(&key->block))) {
-    if (kb->data) {
-      MEM_freeN(kb->data);
-    }
+    BKE_keyblock_data_free(kb);
     MEM_freeN(kb);
   }
 }
@@ -132,6 +164,7 @@ static void shapekey_blend_write(BlendWriter *writer, ID *id, const void *id_add
       tmp_kb.totelem = 0;
       tmp_kb.data = nullptr;
     }
+    tmp_kb.data_sharing_info = nullptr;
     BLO_write_struct_at_address(writer, KeyBlock, kb, &tmp_kb);
     if (tmp_kb.data != nullptr) {
       BLO_write_raw(writer, tmp_kb.totelem * key->elemsize, tmp_kb.data);
@@ -180,6 +213,7 @@ static void shapekey_blend_read_data(BlendDataReader *reader, ID *id)
 
   LISTBASE_FOREACH (KeyBlock *, kb, &key->block) {
     BLO_read_data_address(reader, &kb->data);
+    kb->data_sharing_info = nullptr;
 
     if (BLO_read_requires_endian_switch(reader)) {
       switch_endian_keyblock(key, kb);
@@ -246,9 +280,7 @@ void BKE_key_free_data(Key *key)
 void BKE_key_free_nolib(Key *key)
 {
   while (KeyBlock *kb = static_cast<KeyBlock *>(BLI_pophead(&key->block))) {
-    if (kb->data) {
-      MEM_freeN(kb->data);
-    }
+    BKE_keyblock_data_free(kb);
     MEM_freeN(kb);
   }
 }
@@ -1719,6 +1751,7 @@ void BKE_keyblock_data_set_with_mat4(Key *key,
   for (KeyBlock *kb = static_cast<KeyBlock *>(key->block.first); kb; kb = kb->next, index++) {
     if (ELEM(shape_index, -1, index)) {
       const int block_elem_len = kb->totelem;
+      BKE_keyblock_data_ensure_mutable(kb);
       float(*block_data)[3] = (float(*)[3])kb->data;
       for (int data_offset = 0; data_offset < block_elem_len; ++data_offset) {
         const float *src_data = (const float *)(elements + data_offset);
@@ -1739,6 +1772,7 @@ void BKE_keyblock_curve_data_set_with_mat4(
   for (KeyBlock *kb = static_cast<KeyBlock *>(key->block.first); kb; kb = kb->next, index++) {
     if (ELEM(shape_index, -1, index)) {
       const int block_elem_size = kb->totelem * key->elemsize;
+      BKE_keyblock_data_ensure_mutable(kb);
       BKE_keyblock_curve_data_transform(nurb, mat, elements, kb->data);
       elements += block_elem_size;
     }
@@ -1752,6 +1786,7 @@ void BKE_keyblock_data_set(Key *key, const int shape_index, const void *data)
   for (KeyBlock *kb = static_cast<KeyBlock *>(key->block.first); kb; kb = kb->next, index++) {
     if (ELEM(shape_index, -1, index)) {
       const int block_elem_size = kb->totelem * key->elemsize;
+      BKE_keyblock_data_ensure_mutable(kb);
       memcpy(kb->data, elements, block_elem_size);
       elements += block_elem_size;
     }
@@ -1955,6 +1990,27 @@ void BKE_keyblock_copy_settings(KeyBlock *kb_dst, const KeyBlock *kb_src)
   kb_dst->slidermax = kb_src->slidermax;
 }
 
+void BKE_keyblock_data_free(KeyBlock *kb)
+{
+  if (kb->data_sharing_info) {
+    blender::implicit_sharing::free_shared_data(&kb->data, &kb->data_sharing_info);
+  }
+  else {
+    MEM_SAFE_FREE(kb->data);
+  }
+}
+
+void BKE_keyblock_data_ensure_mutable(KeyBlock *kb)
+{
+  if (kb->data_sharing_info == nullptr) {
+    return;
+  }
+  char *data = static_cast<char *>(kb->data);
+  blender::implicit_sharing::make_trivial_data_mutable(
+      &data, &kb->data_sharing_info, int64_t(MEM_allocN_len(kb->data)));
+  kb->data = data;
+}
+
 std::optional<std::string> BKE_keyblock_curval_rnapath_get(const Key *key, const KeyBlock *kb)
 {
   if (ELEM(nullptr, key, kb)) {
@@ -1982,6 +2038,7 @@ void BKE_keyblock_update_from_lattice(const Lattice *lt, KeyBlock *kb)
     return;
   }
 
+  BKE_keyblock_data_ensure_mutable(kb);
   bp = lt->def;
   fp = static_cast<float(*)[3]>(kb->data);
   for (a = 0; a < kb->totelem; a++, fp++, bp++) {
@@ -1998,7 +2055,7 @@ void BKE_keyblock_convert_from_lattice(const Lattice *lt, KeyBlock *kb)
     return;
   }
 
-  MEM_SAFE_FREE(kb->data);
+  BKE_keyblock_data_free(kb);
 
   kb->data = MEM_mallocN(lt->key->elemsize * tot, __func__);
   kb->totelem = tot;
@@ -2060,6 +2117,7 @@ void BKE_keyblock_update_from_curve(const Curve * /*cu*/, KeyBlock *kb, const Li
     return;
   }
 
+  BKE_keyblock_data_ensure_mutable(kb);
   fp = static_cast<float *>(kb->data);
   LISTBASE_FOREACH (Nurb *, nu, nurb) {
     if (nu->bezt) {
@@ -2124,7 +2182,7 @@ void BKE_keyblock_convert_from_curve(const Curve *cu, KeyBlock *kb, const ListBa
     return;
   }
 
-  MEM_SAFE_FREE(kb->data);
+  BKE_keyblock_data_free(kb);
 
   kb->data = MEM_mallocN(cu->key->elemsize * tot, __func__);
   kb->totelem = tot;
@@ -2180,6 +2238,7 @@ void BKE_keyblock_update_from_mesh(const Mesh *mesh, KeyBlock *kb)
   }
 
   const blender::Span<blender::float3> positions = mesh->vert_positions();
+  BKE_keyblock_data_ensure_mutable(kb);
   memcpy(kb->data, positions.data(), sizeof(float[3]) * tot);
 }
 
@@ -2191,7 +2250,7 @@ void BKE_keyblock_convert_from_mesh(const Mesh *mesh, const Key *key, KeyBlock *
     return;
   }
 
-  MEM_SAFE_FREE(kb->data);
+  BKE_keyblock_data_free(kb);
 
   kb->data = MEM_malloc_arrayN(size_t(len), size_t(key->elemsize), __func__);
   kb->totelem = len;
@@ -2297,6 +2356,7 @@ void BKE_keyblock_mesh_calc_normals(const KeyBlock *kb,
 void BKE_keyblock_update_from_vertcos(const Object *ob, KeyBlock *kb, const float (*vertCos)[3])
 {
   const float(*co)[3] = vertCos;
+  BKE_keyblock_data_ensure_mutable(kb);
   float *fp = static_cast<float *>(kb->data);
   int tot, a;
 
@@ -2357,7 +2417,7 @@ void BKE_keyblock_convert_from_vertcos(const Object *ob, KeyBlock *kb, const flo
 {
   int tot = 0, elemsize;
 
-  MEM_SAFE_FREE(kb->data);
+  BKE_keyblock_data_free(kb);
 
   /* Count of vertex coords in array */
   if (ob->type == OB_MESH) {
@@ -2447,6 +2507,7 @@ float (*BKE_keyblock_convert_to_vertcos(const Object *ob, const KeyBlock *kb))[3
 void BKE_keyblock_update_from_offset(const Object *ob, KeyBlock *kb, const float (*ofs)[3])
 {
   int a;
+  BKE_keyblock_data_ensure_mutable(kb);
   float *fp = static_cast<float *>(kb->data);
 
   if (ELEM(ob->type, OB_MESH, OB_LATTICE)) {
@@ -1250,6 +1250,7 @@ void BKE_mesh_transform(Mesh *mesh, const float mat[4][4], bool do_keys)
 
   if (do_keys && mesh->key) {
     LISTBASE_FOREACH (KeyBlock *, kb, &mesh->key->block) {
+      BKE_keyblock_data_ensure_mutable(kb);
       float *fp = (float *)kb->data;
       for (int i = kb->totelem; i--; fp += 3) {
         mul_m4_v3(mat, fp);
@@ -1285,6 +1286,7 @@ void BKE_mesh_translate(Mesh *mesh, const float offset[3], const bool do_keys)
   translate_positions(mesh->vert_positions_for_write(), offset);
   if (do_keys && mesh->key) {
     LISTBASE_FOREACH (KeyBlock *, kb, &mesh->key->block) {
+      BKE_keyblock_data_ensure_mutable(kb);
       translate_positions({static_cast<float3 *>(kb->data), kb->totelem}, offset);
     }
   }
@@ -1025,7 +1025,7 @@ static void move_shapekey_layers_to_keyblocks(const Mesh &mesh,
     const CustomDataLayer &layer = custom_data.layers[layer_index];
 
     KeyBlock *kb = keyblock_ensure_from_uid(key_dst, layer.uid, layer.name);
-    MEM_SAFE_FREE(kb->data);
+    BKE_keyblock_data_free(kb);
 
     kb->totelem = mesh.verts_num;
     kb->data = MEM_malloc_arrayN(kb->totelem, sizeof(float3), __func__);
@@ -1040,7 +1040,7 @@ static void move_shapekey_layers_to_keyblocks(const Mesh &mesh,
 
   LISTBASE_FOREACH (KeyBlock *, kb, &key_dst.block) {
     if (kb->totelem != mesh.verts_num) {
-      MEM_SAFE_FREE(kb->data);
+      BKE_keyblock_data_free(kb);
       kb->totelem = mesh.verts_num;
       kb->data = MEM_cnew_array<float3>(kb->totelem, __func__);
       CLOG_ERROR(&LOG, "Data for shape key '%s' on mesh missing from evaluated mesh ", kb->name);
@@ -1117,9 +1117,7 @@ void BKE_mesh_nomain_to_meshkey(Mesh *mesh_src, Mesh *mesh_dst, KeyBlock *kb)
     return;
   }
 
-  if (kb->data) {
-    MEM_freeN(kb->data);
-  }
+  BKE_keyblock_data_free(kb);
   kb->data = MEM_malloc_arrayN(mesh_dst->key->elemsize, mesh_dst->verts_num, "kb->data");
   kb->totelem = totvert;
   MutableSpan(static_cast<float3 *>(kb->data), kb->totelem).copy_from(mesh_src->vert_positions());
@@ -42,6 +42,7 @@
 #include "BLI_string.h"
 #include "BLI_string_utf8.h"
 #include "BLI_string_utils.hh"
+#include "BLI_time.h"
 #include "BLI_utildefines.h"
 
 #include "BLT_translation.hh"
@@ -69,6 +70,7 @@
 /* end */
 
 #include "DEG_depsgraph.hh"
+#include "DEG_depsgraph_debug.hh"
 #include "DEG_depsgraph_query.hh"
 
 #include "MOD_modifiertypes.hh"
@@ -1461,6 +1463,11 @@ ScopedModifierTimer::~ScopedModifierTimer()
   const double end_time = get_current_time_in_seconds();
   const double duration = end_time - start_time_;
   md_.execution_time = duration;
+  if (DEG_debug_trace_is_enabled()) {
+    /* The trace uses the time base of #BLI_time_now_seconds. */
+    const double trace_end_time = BLI_time_now_seconds();
+    DEG_debug_trace_add_span("modifier", md_.name, trace_end_time - duration, trace_end_time);
+  }
 }
 
 }  // namespace blender::bke
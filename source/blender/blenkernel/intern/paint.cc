@@ -1664,6 +1664,13 @@ static void sculpt_update_object(Depsgraph *depsgraph,
   ss->scene = scene;
 
   ss->shapekey_active = (mmd == nullptr) ? BKE_keyblock_from_object(ob) : nullptr;
+  if (ss->shapekey_active) {
+    /* Brushes write to the shape-keys from multiple threads and keep pointers to their data, so
+     * make sure it is not shared with evaluated copies of the key beforehand. */
+    LISTBASE_FOREACH (KeyBlock *, kb, &mesh_orig->key->block) {
+      BKE_keyblock_data_ensure_mutable(kb);
+    }
+  }
 
   /* NOTE: Weight pPaint require mesh info for loop lookup, but it never uses multires code path,
    * so no extra checks is needed here. */
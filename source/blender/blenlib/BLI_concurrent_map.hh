@@ -0,0 +1,303 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * A `blender::ConcurrentMap<Key, Value>` is an unordered associative container that can be
+ * modified from multiple threads at the same time. It is the #Map counterpart of
+ * #ConcurrentSet, see BLI_concurrent_set.hh for how the sharding works.
+ *
+ * Some noteworthy information:
+ * - All methods that only take keys and values are thread-safe. Methods that give access to the
+ *   shards, like #shard and #size, must not be used while other threads modify the map.
+ * - Values are returned by copy, because references could be invalidated by other threads at
+ *   any time. Use #add_or_modify to change a value in place.
+ * - Use #add_multiple when adding many items at once, e.g. a range of items in `parallel_for`.
+ */
+
+#include <mutex>
+#include <optional>
+
+#include "BLI_array.hh"
+#include "BLI_hash_tables.hh"
+#include "BLI_map.hh"
+#include "BLI_utility_mixins.hh"
+
+namespace blender {
+
+template<
+    /** Type of the keys stored in the map. */
+    typename Key,
+    /** Type of the values stored in the map. */
+    typename Value,
+    /** The strategy used to deal with collisions in the shards. See BLI_probing_strategies.hh. */
+    typename ProbingStrategy = DefaultProbingStrategy,
+    /** The hash function used to choose the shard and the slot of a key. See BLI_hash.hh. */
+    typename Hash = DefaultHash<Key>,
+    /** The equality operator used to compare keys. */
+    typename IsEqual = DefaultEquality<Key>,
+    /** What is stored in the hash table arrays of the shards. See BLI_map_slots.hh. */
+    typename Slot = typename DefaultMapSlot<Key, Value>::type,
+    /** The allocator used by the shards. */
+    typename Allocator = GuardedAllocator>
+class ConcurrentMap : NonCopyable, NonMovable {
+ public:
+  using MapType = Map<Key, Value, 0, ProbingStrategy, Hash, IsEqual, Slot, Allocator>;
+
+ private:
+  /** Aligned to avoid false sharing between the mutexes of different shards. */
+  struct alignas(64) Shard {
+    mutable std::mutex mutex;
+    MapType map;
+  };
+
+  int shard_bits_;
+  Array<Shard, 0> shards_;
+
+  BLI_NO_UNIQUE_ADDRESS Hash hash_;
+
+ public:
+  /**
+   * Create an empty map. The number of shards is rounded up to a power of two. Using more shards
+   * than threads reduces the time spent waiting for other threads.
+   */
+  explicit ConcurrentMap(const int64_t shards_num = 64)
+      : shard_bits_(shard_bits_for_shards_num(shards_num)), shards_(int64_t(1) << shard_bits_)
+  {
+  }
+
+  /**
+   * Add a key-value pair to the map. Nothing is changed when the key exists already. Returns
+   * true when the pair was added.
+   * This is thread-safe.
+   */
+  bool add(const Key &key, const Value &value)
+  {
+    return this->add_as(key, value);
+  }
+  bool add(Key &&key, Value &&value)
+  {
+    return this->add_as(std::move(key), std::move(value));
+  }
+  template<typename ForwardKey, typename... ForwardValue>
+  bool add_as(ForwardKey &&key, ForwardValue &&...value)
+  {
+    Shard &shard = shards_[this->shard_index(key)];
+    std::lock_guard lock{shard.mutex};
+    return shard.map.add_as(std::forward<ForwardKey>(key), std::forward<ForwardValue>(value)...);
+  }
+
+  /**
+   * Add a key-value pair to the map, overwriting the value of an existing key. Returns true when
+   * the key did not exist before.
+   * This is thread-safe.
+   */
+  bool add_overwrite(const Key &key, const Value &value)
+  {
+    return this->add_overwrite_as(key, value);
+  }
+  bool add_overwrite(Key &&key, Value &&value)
+  {
+    return this->add_overwrite_as(std::move(key), std::move(value));
+  }
+  template<typename ForwardKey, typename... ForwardValue>
+  bool add_overwrite_as(ForwardKey &&key, ForwardValue &&...value)
+  {
+    Shard &shard = shards_[this->shard_index(key)];
+    std::lock_guard lock{shard.mutex};
+    return shard.map.add_overwrite_as(std::forward<ForwardKey>(key),
+                                      std::forward<ForwardValue>(value)...);
+  }
+
+  /**
+   * Same as #Map::add_or_modify. The callbacks are called while the shard of the key is locked,
+   * so they should be cheap and must not access the map.
+   * This is thread-safe.
+   */
+  template<typename CreateValueF, typename ModifyValueF>
+  auto add_or_modify(const Key &key,
+                     const CreateValueF &create_value,
+                     const ModifyValueF &modify_value) -> decltype(create_value(nullptr))
+  {
+    Shard &shard = shards_[this->shard_index(key)];
+    std::lock_guard lock{shard.mutex};
+    return shard.map.add_or_modify(key, create_value, modify_value);
+  }
+
+  /**
+   * Add all key-value pairs. Keys that exist already keep their value.
+   * This is thread-safe, and meant to be called with a chunk of items from every task of a
+   * parallel loop.
+   */
+  void add_multiple(const Span<Key> keys, const Span<Value> values)
+  {
+    BLI_assert(keys.size() == values.size());
+    if (keys.size() < shards_.size()) {
+      for (const int64_t i : keys.index_range()) {
+        this->add(keys[i], values[i]);
+      }
+      return;
+    }
+    /* Group the items by shard with a counting sort, to lock every shard only once. */
+    Array<int64_t> key_shards(keys.size());
+    Array<int64_t> shard_offsets(shards_.size() + 1, 0);
+    for (const int64_t i : keys.index_range()) {
+      key_shards[i] = this->shard_index(keys[i]);
+      shard_offsets[key_shards[i] + 1]++;
+    }
+    for (const int64_t shard_i : shards_.index_range()) {
+      shard_offsets[shard_i + 1] += shard_offsets[shard_i];
+    }
+    Array<int64_t> sorted_items(keys.size());
+    {
+      Array<int64_t> fill = shard_offsets.as_span().drop_back(1);
+      for (const int64_t i : keys.index_range()) {
+        sorted_items[fill[key_shards[i]]++] = i;
+      }
+    }
+    for (const int64_t shard_i : shards_.index_range()) {
+      const IndexRange range = IndexRange::from_begin_end(shard_offsets[shard_i],
+                                                          shard_offsets[shard_i + 1]);
+      if (range.is_empty()) {
+        continue;
+      }
+      Shard &shard = shards_[shard_i];
+      std::lock_guard lock{shard.mutex};
+      for (const int64_t i : sorted_items.as_span().slice(range)) {
+        shard.map.add(keys[i], values[i]);
+      }
+    }
+  }
+
+  /**
+   * Returns a copy of the value that corresponds to the given key, or nothing when the key is
+   * not in the map.
+   * This is thread-safe.
+   */
+  std::optional<Value> lookup_try(const Key &key) const
+  {
+    return this->lookup_try_as(key);
+  }
+  template<typename ForwardKey> std::optional<Value> lookup_try_as(const ForwardKey &key) const
+  {
+    const Shard &shard = shards_[this->shard_index(key)];
+    std::lock_guard lock{shard.mutex};
+    if (const Value *value = shard.map.lookup_ptr_as(key)) {
+      return *value;
+    }
+    return std::nullopt;
+  }
+
+  /**
+   * Returns a copy of the value that corresponds to the given key, or the default value when
+   * the key is not in the map.
+   * This is thread-safe.
+   */
+  Value lookup_default(const Key &key, const Value &default_value) const
+  {
+    const Shard &shard = shards_[this->shard_index(key)];
+    std::lock_guard lock{shard.mutex};
+    return shard.map.lookup_default(key, default_value);
+  }
+
+  /**
+   * Returns true if there is a key in the map that compares equal to the given key.
+   * This is thread-safe.
+   */
+  bool contains(const Key &key) const
+  {
+    return this->contains_as(key);
+  }
+  template<typename ForwardKey> bool contains_as(const ForwardKey &key) const
+  {
+    const Shard &shard = shards_[this->shard_index(key)];
+    std::lock_guard lock{shard.mutex};
+    return shard.map.contains_as(key);
+  }
+
+  /**
+   * Remove the key from the map. Returns true when the key existed before.
+   * This is thread-safe.
+   */
+  bool remove(const Key &key)
+  {
+    return this->remove_as(key);
+  }
+  template<typename ForwardKey> bool remove_as(const ForwardKey &key)
+  {
+    Shard &shard = shards_[this->shard_index(key)];
+    std::lock_guard lock{shard.mutex};
+    return shard.map.remove_as(key);
+  }
+
+  /**
+   * Make sure that about the given number of keys can be added without growing the shards.
+   * This is not thread-safe.
+   */
+  void reserve(const int64_t n)
+  {
+    const int64_t n_per_shard = ceil_division<int64_t>(n, shards_.size());
+    for (Shard &shard : shards_) {
+      shard.map.reserve(n_per_shard);
+    }
+  }
+
+  /**
+   * Returns the number of key-value pairs stored in the map.
+   * This is not thread-safe.
+   */
+  int64_t size() const
+  {
+    int64_t size = 0;
+    for (const Shard &shard : shards_) {
+      size += shard.map.size();
+    }
+    return size;
+  }
+
+  bool is_empty() const
+  {
+    return this->size() == 0;
+  }
+
+  /**
+   * Remove all key-value pairs from the map.
+   * This is not thread-safe.
+   */
+  void clear()
+  {
+    for (Shard &shard : shards_) {
+      shard.map.clear();
+    }
+  }
+
+  IndexRange shard_range() const
+  {
+    return shards_.index_range();
+  }
+
+  /**
+   * Access the items of one shard, e.g. to process the items in parallel over the shards.
+   * This is not thread-safe with concurrent modification of the map.
+   */
+  const MapType &shard(const int64_t index) const
+  {
+    return shards_[index].map;
+  }
+  MapType &shard(const int64_t index)
+  {
+    return shards_[index].map;
+  }
+
+ private:
+  template<typename ForwardKey> int64_t shard_index(const ForwardKey &key) const
+  {
+    return hash_to_shard_index(hash_(key), shard_bits_);
+  }
+};
+
+}  // namespace blender
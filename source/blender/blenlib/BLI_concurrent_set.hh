@@ -0,0 +1,237 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * A `blender::ConcurrentSet<Key>` is an unordered container for unique elements of type `Key`
+ * that can be modified from multiple threads at the same time. It is meant for parallel
+ * algorithms that would otherwise have to partition their keys manually in order to build one
+ * #Set per task.
+ *
+ * The set is split into a power-of-two number of shards. Each shard is a #Set protected by its
+ * own mutex, so threads only wait for each other when they access the same shard at the same
+ * time. The shards use the same probing strategies, hash functions and slot types as #Set.
+ *
+ * Some noteworthy information:
+ * - All methods that only take keys are thread-safe. Methods that give access to the shards,
+ *   like #shard and #size, must not be used while other threads modify the set.
+ * - There are no pointers or references to keys in the API, because they could be invalidated
+ *   by other threads at any time.
+ * - Use #add_multiple when adding many keys at once, e.g. a range of keys in `parallel_for`. It
+ *   groups the keys by shard first, so that every shard is locked only once.
+ * - The keys in different shards are independent, so iterating over them afterwards can be done
+ *   in parallel over the shard indices.
+ */
+
+#include <mutex>
+
+#include "BLI_array.hh"
+#include "BLI_hash_tables.hh"
+#include "BLI_set.hh"
+#include "BLI_utility_mixins.hh"
+
+namespace blender {
+
+template<
+    /** Type of the elements that are stored in this set. */
+    typename Key,
+    /** The strategy used to deal with collisions in the shards. See BLI_probing_strategies.hh. */
+    typename ProbingStrategy = DefaultProbingStrategy,
+    /** The hash function used to choose the shard and the slot of a key. See BLI_hash.hh. */
+    typename Hash = DefaultHash<Key>,
+    /** The equality operator used to compare keys. */
+    typename IsEqual = DefaultEquality<Key>,
+    /** What is stored in the hash table arrays of the shards. See BLI_set_slots.hh. */
+    typename Slot = typename DefaultSetSlot<Key>::type,
+    /** The allocator used by the shards. */
+    typename Allocator = GuardedAllocator>
+class ConcurrentSet : NonCopyable, NonMovable {
+ public:
+  using SetType = Set<Key, 0, ProbingStrategy, Hash, IsEqual, Slot, Allocator>;
+
+ private:
+  /** Aligned to avoid false sharing between the mutexes of different shards. */
+  struct alignas(64) Shard {
+    mutable std::mutex mutex;
+    SetType set;
+  };
+
+  int shard_bits_;
+  Array<Shard, 0> shards_;
+
+  BLI_NO_UNIQUE_ADDRESS Hash hash_;
+
+ public:
+  /**
+   * Create an empty set. The number of shards is rounded up to a power of two. Using more shards
+   * than threads reduces the time spent waiting for other threads.
+   */
+  explicit ConcurrentSet(const int64_t shards_num = 64)
+      : shard_bits_(shard_bits_for_shards_num(shards_num)), shards_(int64_t(1) << shard_bits_)
+  {
+  }
+
+  /**
+   * Add a key to the set. Returns true when the key did not exist before.
+   * This is thread-safe.
+   */
+  bool add(const Key &key)
+  {
+    return this->add_as(key);
+  }
+  bool add(Key &&key)
+  {
+    return this->add_as(std::move(key));
+  }
+  template<typename ForwardKey> bool add_as(ForwardKey &&key)
+  {
+    Shard &shard = shards_[this->shard_index(key)];
+    std::lock_guard lock{shard.mutex};
+    return shard.set.add_as(std::forward<ForwardKey>(key));
+  }
+
+  /**
+   * Add all keys in the span. Keys that exist already are ignored.
+   * This is thread-safe, and meant to be called with a chunk of keys from every task of a
+   * parallel loop.
+   */
+  void add_multiple(const Span<Key> keys)
+  {
+    if (keys.size() < shards_.size()) {
+      for (const Key &key : keys) {
+        this->add(key);
+      }
+      return;
+    }
+    /* Group the keys by shard with a counting sort, to lock every shard only once. */
+    Array<int64_t> key_shards(keys.size());
+    Array<int64_t> shard_offsets(shards_.size() + 1, 0);
+    for (const int64_t i : keys.index_range()) {
+      key_shards[i] = this->shard_index(keys[i]);
+      shard_offsets[key_shards[i] + 1]++;
+    }
+    for (const int64_t shard_i : shards_.index_range()) {
+      shard_offsets[shard_i + 1] += shard_offsets[shard_i];
+    }
+    Array<int64_t> sorted_keys(keys.size());
+    {
+      Array<int64_t> fill = shard_offsets.as_span().drop_back(1);
+      for (const int64_t i : keys.index_range()) {
+        sorted_keys[fill[key_shards[i]]++] = i;
+      }
+    }
+    for (const int64_t shard_i : shards_.index_range()) {
+      const IndexRange range = IndexRange::from_begin_end(shard_offsets[shard_i],
+                                                          shard_offsets[shard_i + 1]);
+      if (range.is_empty()) {
+        continue;
+      }
+      Shard &shard = shards_[shard_i];
+      std::lock_guard lock{shard.mutex};
+      for (const int64_t i : sorted_keys.as_span().slice(range)) {
+        shard.set.add(keys[i]);
+      }
+    }
+  }
+
+  /**
+   * Returns true if the key is in the set.
+   * This is thread-safe.
+   */
+  bool contains(const Key &key) const
+  {
+    return this->contains_as(key);
+  }
+  template<typename ForwardKey> bool contains_as(const ForwardKey &key) const
+  {
+    const Shard &shard = shards_[this->shard_index(key)];
+    std::lock_guard lock{shard.mutex};
+    return shard.set.contains_as(key);
+  }
+
+  /**
+   * Remove the key from the set. Returns true when the key existed before.
+   * This is thread-safe.
+   */
+  bool remove(const Key &key)
+  {
+    return this->remove_as(key);
+  }
+  template<typename ForwardKey> bool remove_as(const ForwardKey &key)
+  {
+    Shard &shard = shards_[this->shard_index(key)];
+    std::lock_guard lock{shard.mutex};
+    return shard.set.remove_as(key);
+  }
+
+  /**
+   * Make sure that about the given number of keys can be added without growing the shards.
+   * This is not thread-safe.
+   */
+  void reserve(const int64_t n)
+  {
+    const int64_t n_per_shard = ceil_division<int64_t>(n, shards_.size());
+    for (Shard &shard : shards_) {
+      shard.set.reserve(n_per_shard);
+    }
+  }
+
+  /**
+   * Returns the number of keys stored in the set.
+   * This is not thread-safe.
+   */
+  int64_t size() const
+  {
+    int64_t size = 0;
+    for (const Shard &shard : shards_) {
+      size += shard.set.size();
+    }
+    return size;
+  }
+
+  bool is_empty() const
+  {
+    return this->size() == 0;
+  }
+
+  /**
+   * Remove all keys from the set.
+   * This is not thread-safe.
+   */
+  void clear()
+  {
+    for (Shard &shard : shards_) {
+      shard.set.clear();
+    }
+  }
+
+  IndexRange shard_range() const
+  {
+    return shards_.index_range();
+  }
+
+  /**
+   * Access the keys of one shard, e.g. to process the keys in parallel over the shards.
+   * This is not thread-safe with concurrent modification of the set.
+   */
+  const SetType &shard(const int64_t index) const
+  {
+    return shards_[index].set;
+  }
+  SetType &shard(const int64_t index)
+  {
+    return shards_[index].set;
+  }
+
+ private:
+  template<typename ForwardKey> int64_t shard_index(const ForwardKey &key) const
+  {
+    return hash_to_shard_index(hash_(key), shard_bits_);
+  }
+};
+
+}  // namespace blender
@@ -63,6 +63,39 @@ inline constexpr int64_t total_slot_amount_for_usable_slots(
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Shards
+ *
+ * Concurrent hash tables are split into a power-of-two number of shards, which are hash tables
+ * protected by their own mutex. The shard of a key is chosen from its hash.
+ * \{ */
+
+/** Number of bits needed to index the given number of shards, rounded up to a power of two. */
+inline int shard_bits_for_shards_num(const int64_t shards_num)
+{
+  int shard_bits = 0;
+  while ((int64_t(1) << shard_bits) < shards_num) {
+    shard_bits++;
+  }
+  return shard_bits;
+}
+
+/**
+ * Map a hash to one of `2^shard_bits` shards. The hash tables in the shards find slots with the
+ * low bits of the hash, so the shard is chosen from a multiplicative mix of all bits instead.
+ * Otherwise all keys of a shard would share their low bits and collide in its slot array.
+ */
+inline int64_t hash_to_shard_index(const uint64_t hash, const int shard_bits)
+{
+  BLI_assert(shard_bits >= 0 && shard_bits < 64);
+  if (shard_bits == 0) {
+    return 0;
+  }
+  return int64_t((hash * uint64_t(0x9E3779B97F4A7C15)) >> (64 - shard_bits));
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Load Factor
  *
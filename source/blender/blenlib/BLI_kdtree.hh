@@ -0,0 +1,56 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * Batched queries on a #KDTree_3d, running many nearest neighbor or range searches in parallel
+ * and returning the found points of all queries in a single contiguous array.
+ */
+
+#include "BLI_array.hh"
+#include "BLI_kdtree.h"
+#include "BLI_math_vector_types.hh"
+#include "BLI_offset_indices.hh"
+
+namespace blender::kdtree {
+
+/**
+ * The points found for a batch of queries, grouped by query.
+ */
+struct NearestGroups {
+  /** Offsets into #nearest for every query, see #offsets(). */
+  Array<int> offset_data;
+  /** The found points of all queries, sorted by distance for every query. */
+  Array<KDTreeNearest_3d> nearest;
+
+  OffsetIndices<int> offsets() const
+  {
+    return this->offset_data.as_span();
+  }
+
+  /** The points found for a single query. */
+  Span<KDTreeNearest_3d> operator[](const int query) const
+  {
+    return this->nearest.as_span().slice(this->offsets()[query]);
+  }
+};
+
+/**
+ * Find up to \a nearest_len_max of the closest points in the tree for every position,
+ * like #BLI_kdtree_3d_find_nearest_n.
+ */
+NearestGroups find_nearest_n_batch(const KDTree_3d &tree,
+                                   Span<float3> positions,
+                                   int nearest_len_max);
+
+/**
+ * Find all points in the tree within \a range of every position, like
+ * #BLI_kdtree_3d_range_search.
+ */
+NearestGroups range_search_batch(const KDTree_3d &tree, Span<float3> positions, float range);
+
+}  // namespace blender::kdtree
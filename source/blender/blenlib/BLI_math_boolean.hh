@@ -44,6 +44,28 @@ int insphere(
 int insphere_fast(
     const double3 &a, const double3 &b, const double3 &c, const double3 &d, const double3 &e);
 
+/**
+ * Try to find the sign of #orient3d of exact coordinates using double approximations of them,
+ * like the ones from #mpq_class::get_d(). Return +1 or -1 when the sign is certain, and 0 when
+ * the exact predicate is needed to decide.
+ *
+ * The error bound is first taken from \a static_error_bound, computed once with
+ * #orient3d_static_error_bound for all coordinates of a mesh, and otherwise calculated for the
+ * given coordinates.
+ */
+int orient3d_filter(const double3 &a, const double3 &b, const double3 &c, const double3 &d);
+int orient3d_filter(const double3 &a,
+                    const double3 &b,
+                    const double3 &c,
+                    const double3 &d,
+                    double static_error_bound);
+
+/**
+ * An error bound for #orient3d_filter that is valid for all coordinates with an absolute value
+ * of at most \a max_abs_coord.
+ */
+double orient3d_static_error_bound(double max_abs_coord);
+
 #ifdef WITH_GMP
 /**
  * Return +1 if a, b, c are in CCW order around a circle in the plane.
@@ -0,0 +1,41 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * Conversion between 32-bit floats and IEEE 754 16-bit half floats, stored as `uint16_t`.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+namespace blender::math {
+
+/**
+ * Converts a float to a half float, rounding to the nearest even value. Values above the half
+ * float range become infinity, NaN is preserved.
+ */
+uint16_t float_to_half(float v);
+
+/**
+ * Converts a half float to a float. The conversion is exact.
+ */
+float half_to_float(uint16_t v);
+
+/**
+ * Converts an array of floats to half floats, using the F16C or NEON conversion instructions
+ * when the CPU supports them. Gives the same results as #float_to_half.
+ */
+void float_to_half_array(const float *src, uint16_t *dst, size_t length);
+
+/**
+ * Converts an array of half floats to floats, using the F16C or NEON conversion instructions
+ * when the CPU supports them. Gives the same results as #half_to_float.
+ */
+void half_to_float_array(const uint16_t *src, float *dst, size_t length);
+
+}  // namespace blender::math
@@ -65,6 +65,13 @@ IMesh boolean_trimesh(IMesh &tm_in,
                       bool hole_tolerant,
                       IMeshArena *arena);
 
+/**
+ * Upper bound of the resolution of the grid splitting the triangle mesh topology of the boolean
+ * into partitions built in parallel. A value of one builds it in a single partition, this is only
+ * meant to be changed by tests.
+ */
+extern int boolean_topology_max_grid_resolution;
+
 }  // namespace blender::meshintersect
 
 #endif /* WITH_GMP */
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "BLI_math_vector_types.hh"
+#include "BLI_span.hh"
 
 namespace blender::noise {
 
@@ -72,6 +73,14 @@ float perlin(float2 position);
 float perlin(float3 position);
 float perlin(float4 position);
 
+/* Evaluate #perlin_signed at many positions at once, which is faster than calling it for every
+ * position separately. The results are exactly the same. */
+
+void perlin_signed(Span<float> positions, MutableSpan<float> r_values);
+void perlin_signed(Span<float2> positions, MutableSpan<float> r_values);
+void perlin_signed(Span<float3> positions, MutableSpan<float> r_values);
+void perlin_signed(Span<float4> positions, MutableSpan<float> r_values);
+
 /* Perlin fractal Brownian motion. */
 
 template<typename T>
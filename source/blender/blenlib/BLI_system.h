@@ -16,6 +16,8 @@ extern "C" {
 
 int BLI_cpu_support_sse2(void);
 int BLI_cpu_support_sse42(void);
+/** Whether the CPU and OS support the F16C half float conversion instructions. */
+int BLI_cpu_support_f16c(void);
 void BLI_system_backtrace(FILE *fp);
 
 /** Get CPU brand, result is to be MEM_freeN()-ed. */
@@ -31,8 +31,15 @@
 #include "BLI_math_geom.h"
 #include "BLI_stack.h"
 #include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
+#include "atomic_ops.h"
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 #include "BLI_strict_flags.h" /* Keep last. */
 
 /* used for iterative_raycast */
@@ -44,6 +51,9 @@
 /* Check tree is valid. */
 // #define USE_VERIFY_TREE
 
+/* Flattened wide tree used by ray-cast and nearest queries. */
+#define USE_WIDE_BVH
+
 #define MAX_TREETYPE 32
 
 /* Setting zero so we can catch bugs in BLI_task/KDOPBVH.
@@ -55,6 +65,13 @@
 #  define KDOPBVH_THREAD_LEAF_THRESHOLD 1024
 #endif
 
+#ifdef USE_WIDE_BVH
+/** Number of children of wide tree nodes, tested together during traversal. */
+#  define BVH_WIDE_WIDTH 4
+/** Wide tree depth is bounded by the depth of the implicit tree, at most 32 levels. */
+#  define BVH_WIDE_STACK_SIZE (32 * (BVH_WIDE_WIDTH - 1) + 1)
+#endif
+
 /* -------------------------------------------------------------------- */
 /** \name Struct Definitions
  * \{ */
@@ -73,6 +90,25 @@ typedef struct BVHNode {
   char main_axis; /* Axis used to split this node */
 } BVHNode;
 
+#ifdef USE_WIDE_BVH
+/**
+ * Node of the flattened wide tree. The axis aligned bounds of all children are stored as
+ * structure of arrays, so that a ray or point can be tested against all of them at once.
+ *
+ * The wide tree is built from the k-DOP tree on the first ray-cast or nearest query, so that trees
+ * only used for overlap and range queries don't pay for it. Grand-children are pulled up into
+ * free slots of binary trees and the children of trees wider than #BVH_WIDE_WIDTH are grouped.
+ * Only the X, Y and Z slabs are used, like the scalar ray-cast and nearest queries do.
+ */
+typedef struct BVHWideNode {
+  /** Minimum and maximum along the X, Y and Z axes, for each child. */
+  float bounds[6][BVH_WIDE_WIDTH];
+  /** Index of the child wide node, or `-1 - i` for the leaf `tree->nodearray[i]`. */
+  int children[BVH_WIDE_WIDTH];
+  int children_num;
+} BVHWideNode;
+#endif
+
 /* keep under 26 bytes for speed purposes */
 struct BVHTree {
   BVHNode **nodes;
@@ -85,11 +121,15 @@ struct BVHTree {
   axis_t start_axis, stop_axis; /* bvhtree_kdop_axes array indices according to axis */
   axis_t axis;                  /* KDOP type (6 => OBB, 7 => AABB, ...) */
   char tree_type;               /* type of tree (4 => quad-tree). */
+#ifdef USE_WIDE_BVH
+  BVHWideNode *wide_nodes; /* flattened tree for queries built on demand, the root is first */
+  int wide_nodes_num;
+#endif
 };
 
 /* optimization, ensure we stay small */
-BLI_STATIC_ASSERT((sizeof(void *) == 8 && sizeof(BVHTree) <= 48) ||
-                      (sizeof(void *) == 4 && sizeof(BVHTree) <= 32),
+BLI_STATIC_ASSERT((sizeof(void *) == 8 && sizeof(BVHTree) <= 64) ||
+                      (sizeof(void *) == 4 && sizeof(BVHTree) <= 40),
                   "over sized")
 
 /* avoid duplicating vars in BVHOverlapData_Thread */
@@ -856,6 +896,227 @@ static void non_recursive_bvh_div_nodes(const BVHTree *tree,
 
 /** \} */
 
+#ifdef USE_WIDE_BVH
+
+/* -------------------------------------------------------------------- */
+/** \name Wide Tree Build
+ * \{ */
+
+static float bvh_node_surface_area(const BVHNode *node)
+{
+  const float *bv = node->bv;
+  const float size[3] = {bv[1] - bv[0], bv[3] - bv[2], bv[5] - bv[4]};
+  return size[0] * size[1] + size[1] * size[2] + size[2] * size[0];
+}
+
+/** Wide tree being built, only stored in the #BVHTree once it is complete. */
+typedef struct BVHWideBuildData {
+  BVHWideNode *nodes;
+  int nodes_num;
+  /** Allocated length of #nodes. */
+  int nodes_len;
+} BVHWideBuildData;
+
+static int bvhtree_wide_node_add(BVHWideBuildData *build)
+{
+  if (build->nodes_num == build->nodes_len) {
+    build->nodes_len *= 2;
+    build->nodes = MEM_reallocN(build->nodes, sizeof(BVHWideNode) * (size_t)build->nodes_len);
+  }
+  return build->nodes_num++;
+}
+
+/**
+ * Build a wide node with the given k-DOP nodes as children, and recursively its children.
+ * Returns the index of the wide node.
+ */
+static int bvhtree_wide_build_recursive(const BVHTree *tree,
+                                        BVHWideBuildData *build,
+                                        BVHNode *const *nodes,
+                                        const int nodes_num)
+{
+  BVHNode *lanes[MAX_TREETYPE];
+  int lanes_num = nodes_num;
+  memcpy(lanes, nodes, sizeof(*lanes) * (size_t)nodes_num);
+
+  /* Fill free lanes with the children of the largest branches. */
+  while (lanes_num < BVH_WIDE_WIDTH) {
+    int best_lane = -1;
+    float best_area = -FLT_MAX;
+    for (int i = 0; i < lanes_num; i++) {
+      if (lanes[i]->node_num == 0 || lanes_num - 1 + lanes[i]->node_num > BVH_WIDE_WIDTH) {
+        continue;
+      }
+      const float area = bvh_node_surface_area(lanes[i]);
+      if (area > best_area) {
+        best_lane = i;
+        best_area = area;
+      }
+    }
+    if (best_lane == -1) {
+      break;
+    }
+    /* Insert the children in place, siblings are sorted along the split axis. */
+    const BVHNode *branch = lanes[best_lane];
+    memmove(&lanes[best_lane + branch->node_num],
+            &lanes[best_lane + 1],
+            sizeof(*lanes) * (size_t)(lanes_num - best_lane - 1));
+    memcpy(&lanes[best_lane], branch->children, sizeof(*lanes) * (size_t)branch->node_num);
+    lanes_num += branch->node_num - 1;
+  }
+
+  const int wide_index = bvhtree_wide_node_add(build);
+
+  /* Children of trees wider than the wide nodes are split in groups of neighbors. */
+  const int groups_num = min_ii(lanes_num, BVH_WIDE_WIDTH);
+  for (int group = 0; group < groups_num; group++) {
+    const int begin = group * lanes_num / groups_num;
+    const int end = (group + 1) * lanes_num / groups_num;
+    int child;
+    if (end - begin > 1) {
+      child = bvhtree_wide_build_recursive(tree, build, &lanes[begin], end - begin);
+    }
+    else if (lanes[begin]->node_num == 0) {
+      child = -1 - (int)(lanes[begin] - tree->nodearray);
+    }
+    else {
+      child = bvhtree_wide_build_recursive(
+          tree, build, lanes[begin]->children, lanes[begin]->node_num);
+    }
+    /* The array may have been reallocated. */
+    build->nodes[wide_index].children[group] = child;
+  }
+  build->nodes[wide_index].children_num = groups_num;
+
+  return wide_index;
+}
+
+/**
+ * Update the bounds of the wide tree from the k-DOP leaves.
+ */
+static void bvhtree_wide_refit(const BVHTree *tree,
+                               BVHWideNode *wide_nodes,
+                               const int wide_nodes_num)
+{
+  /* Children are always stored after their parent. */
+  for (int i = wide_nodes_num - 1; i >= 0; i--) {
+    BVHWideNode *node = &wide_nodes[i];
+    for (int lane = 0; lane < BVH_WIDE_WIDTH; lane++) {
+      if (lane >= node->children_num) {
+        /* Inverted bounds are never hit. */
+        for (int axis = 0; axis < 3; axis++) {
+          node->bounds[2 * axis][lane] = FLT_MAX;
+          node->bounds[2 * axis + 1][lane] = -FLT_MAX;
+        }
+        continue;
+      }
+
+      const int child = node->children[lane];
+      if (child < 0) {
+        const float *bv = tree->nodearray[-1 - child].bv;
+        for (int j = 0; j < 6; j++) {
+          node->bounds[j][lane] = bv[j];
+        }
+        continue;
+      }
+
+      const BVHWideNode *child_node = &wide_nodes[child];
+      for (int axis = 0; axis < 3; axis++) {
+        float min = FLT_MAX;
+        float max = -FLT_MAX;
+        for (int j = 0; j < child_node->children_num; j++) {
+          min = min_ff(min, child_node->bounds[2 * axis][j]);
+          max = max_ff(max, child_node->bounds[2 * axis + 1][j]);
+        }
+        node->bounds[2 * axis][lane] = min;
+        node->bounds[2 * axis + 1][lane] = max;
+      }
+    }
+  }
+}
+
+static ThreadMutex bvhtree_wide_build_lock = BLI_MUTEX_INITIALIZER;
+
+/**
+ * Return the wide tree, building it on first use, or null when the tree doesn't support it.
+ * Queries can run from multiple threads, so the wide tree is only stored once it is complete.
+ */
+static const BVHWideNode *bvhtree_wide_ensure(const BVHTree *tree)
+{
+  /* The X, Y and Z slabs are only available when the first axes are used. */
+  const BVHNode *root = tree->nodes[tree->leaf_num];
+  if (tree->leaf_num == 0 || tree->start_axis != 0 || root->node_num == 0) {
+    return NULL;
+  }
+
+  BVHWideNode *wide_nodes = atomic_load_ptr((void *const *)&tree->wide_nodes);
+  if (wide_nodes) {
+    return wide_nodes;
+  }
+
+  BLI_mutex_lock(&bvhtree_wide_build_lock);
+  wide_nodes = tree->wide_nodes;
+  if (wide_nodes == NULL) {
+    BVHWideBuildData build;
+    build.nodes_num = 0;
+    build.nodes_len = max_ii(1, tree->branch_num);
+    build.nodes = MEM_mallocN(sizeof(BVHWideNode) * (size_t)build.nodes_len, __func__);
+    bvhtree_wide_build_recursive(tree, &build, root->children, root->node_num);
+    bvhtree_wide_refit(tree, build.nodes, build.nodes_num);
+
+    /* Building the wide tree doesn't change the results of the queries. */
+    BVHTree *tree_mut = (BVHTree *)tree;
+    tree_mut->wide_nodes_num = build.nodes_num;
+    atomic_store_ptr((void **)&tree_mut->wide_nodes, build.nodes);
+    wide_nodes = build.nodes;
+  }
+  BLI_mutex_unlock(&bvhtree_wide_build_lock);
+  return wide_nodes;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Wide Tree Traversal
+ * \{ */
+
+typedef struct BVHWideStackItem {
+  /** Same encoding as #BVHWideNode.children. */
+  int child;
+  /** Distance to the bounds of the child, used to skip it when a closer hit was found since. */
+  float dist;
+} BVHWideStackItem;
+
+/**
+ * Push the children in the `mask` on the stack, the closest one last so it's visited first.
+ */
+static int bvhtree_wide_stack_push(BVHWideStackItem *stack,
+                                   int stack_len,
+                                   const BVHWideNode *node,
+                                   const float dist[BVH_WIDE_WIDTH],
+                                   const int mask)
+{
+  BLI_assert(stack_len + BVH_WIDE_WIDTH <= BVH_WIDE_STACK_SIZE);
+  const int stack_begin = stack_len;
+  for (int lane = 0; lane < BVH_WIDE_WIDTH; lane++) {
+    if ((mask & (1 << lane)) == 0) {
+      continue;
+    }
+    /* Insertion sort, furthest first. */
+    int i = stack_len++;
+    for (; i > stack_begin && stack[i - 1].dist < dist[lane]; i--) {
+      stack[i] = stack[i - 1];
+    }
+    stack[i].child = node->children[lane];
+    stack[i].dist = dist[lane];
+  }
+  return stack_len;
+}
+
+/** \} */
+
+#endif /* USE_WIDE_BVH */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_bvhtree API
  * \{ */
@@ -939,6 +1200,9 @@ void BLI_bvhtree_free(BVHTree *tree)
     MEM_SAFE_FREE(tree->nodearray);
     MEM_SAFE_FREE(tree->nodebv);
     MEM_SAFE_FREE(tree->nodechild);
+#ifdef USE_WIDE_BVH
+    MEM_SAFE_FREE(tree->wide_nodes);
+#endif
     MEM_freeN(tree);
   }
 }
@@ -1039,6 +1303,12 @@ void BLI_bvhtree_update_tree(BVHTree *tree)
   for (; index >= root; index--) {
     node_join(tree, *index);
   }
+
+#ifdef USE_WIDE_BVH
+  if (tree->wide_nodes) {
+    bvhtree_wide_refit(tree, tree->wide_nodes, tree->wide_nodes_num);
+  }
+#endif
 }
 int BLI_bvhtree_get_len(const BVHTree *tree)
 {
@@ -1598,6 +1868,82 @@ static void dfs_find_nearest_dfs(BVHNearestData *data, BVHNode *node)
   }
 }
 
+#ifdef USE_WIDE_BVH
+
+/**
+ * Squared distance from the query point to the bounds of all children of a wide node, the same
+ * as #calc_nearest_point_squared. Returns a mask of the children closer than the current nearest.
+ */
+static int wide_node_nearest_dist_squared(const BVHNearestData *data,
+                                          const BVHWideNode *node,
+                                          float r_dist_sq[BVH_WIDE_WIDTH])
+{
+#  ifdef __SSE2__
+  const __m128 zero = _mm_setzero_ps();
+  __m128 dist_sq = zero;
+  for (int axis = 0; axis < 3; axis++) {
+    const __m128 co = _mm_set1_ps(data->proj[axis]);
+    const __m128 min = _mm_loadu_ps(node->bounds[2 * axis]);
+    const __m128 max = _mm_loadu_ps(node->bounds[2 * axis + 1]);
+    const __m128 d = _mm_max_ps(_mm_max_ps(_mm_sub_ps(min, co), _mm_sub_ps(co, max)), zero);
+    dist_sq = _mm_add_ps(dist_sq, _mm_mul_ps(d, d));
+  }
+  _mm_storeu_ps(r_dist_sq, dist_sq);
+  const int mask = _mm_movemask_ps(_mm_cmplt_ps(dist_sq, _mm_set1_ps(data->nearest.dist_sq)));
+#  else
+  int mask = 0;
+  for (int lane = 0; lane < BVH_WIDE_WIDTH; lane++) {
+    float dist_sq = 0.0f;
+    for (int axis = 0; axis < 3; axis++) {
+      const float co = data->proj[axis];
+      const float d = max_fff(node->bounds[2 * axis][lane] - co,
+                              co - node->bounds[2 * axis + 1][lane],
+                              0.0f);
+      dist_sq += d * d;
+    }
+    r_dist_sq[lane] = dist_sq;
+    mask |= (dist_sq < data->nearest.dist_sq) << lane;
+  }
+#  endif
+  return mask & ((1 << node->children_num) - 1);
+}
+
+/* Depth first search visiting the closest children first. */
+static void wide_find_nearest(BVHNearestData *data)
+{
+  const BVHTree *tree = data->tree;
+  BVHWideStackItem stack[BVH_WIDE_STACK_SIZE];
+  int stack_len = 1;
+  stack[0].child = 0;
+  stack[0].dist = 0.0f;
+
+  while (stack_len > 0) {
+    const BVHWideStackItem item = stack[--stack_len];
+    if (item.dist >= data->nearest.dist_sq) {
+      continue;
+    }
+
+    if (item.child < 0) {
+      BVHNode *leaf = &tree->nodearray[-1 - item.child];
+      if (data->callback) {
+        data->callback(data->userdata, leaf->index, data->co, &data->nearest);
+      }
+      else {
+        data->nearest.index = leaf->index;
+        data->nearest.dist_sq = calc_nearest_point_squared(data->proj, leaf, data->nearest.co);
+      }
+      continue;
+    }
+
+    const BVHWideNode *node = &tree->wide_nodes[item.child];
+    float dist_sq[BVH_WIDE_WIDTH];
+    const int mask = wide_node_nearest_dist_squared(data, node, dist_sq);
+    stack_len = bvhtree_wide_stack_push(stack, stack_len, node, dist_sq, mask);
+  }
+}
+
+#endif /* USE_WIDE_BVH */
+
 static void dfs_find_nearest_begin(BVHNearestData *data, BVHNode *node)
 {
   float nearest[3], dist_sq;
@@ -1690,6 +2036,11 @@ int BLI_bvhtree_find_nearest_ex(const BVHTree *tree,
     if (flag & BVH_NEAREST_OPTIMAL_ORDER) {
       heap_find_nearest_begin(&data, root);
     }
+#ifdef USE_WIDE_BVH
+    else if (bvhtree_wide_ensure(tree)) {
+      wide_find_nearest(&data);
+    }
+#endif
     else {
       dfs_find_nearest_begin(&data, root);
     }
@@ -1914,6 +2265,97 @@ static void dfs_raycast(BVHRayCastData *data, BVHNode *node)
   }
 }
 
+#ifdef USE_WIDE_BVH
+
+/**
+ * Distance along the ray to the bounds of all children of a wide node, the same as
+ * #fast_ray_nearest_hit. Returns a mask of the children that are hit closer than the current hit.
+ */
+static int wide_node_ray_hit(const BVHRayCastData *data,
+                             const BVHWideNode *node,
+                             float r_dist[BVH_WIDE_WIDTH])
+{
+#  ifdef __SSE2__
+  __m128 t_near = _mm_set1_ps(-FLT_MAX);
+  __m128 t_far = _mm_set1_ps(FLT_MAX);
+  for (int axis = 0; axis < 3; axis++) {
+    const __m128 origin = _mm_set1_ps(data->ray.origin[axis]);
+    const __m128 idot = _mm_set1_ps(data->idot_axis[axis]);
+    const __m128 t1 = _mm_mul_ps(
+        _mm_sub_ps(_mm_loadu_ps(node->bounds[data->index[2 * axis]]), origin), idot);
+    const __m128 t2 = _mm_mul_ps(
+        _mm_sub_ps(_mm_loadu_ps(node->bounds[data->index[2 * axis + 1]]), origin), idot);
+    t_near = _mm_max_ps(t_near, t1);
+    t_far = _mm_min_ps(t_far, t2);
+  }
+  _mm_storeu_ps(r_dist, t_near);
+  const __m128 hit = _mm_and_ps(
+      _mm_and_ps(_mm_cmple_ps(t_near, t_far), _mm_cmpge_ps(t_far, _mm_setzero_ps())),
+      _mm_cmplt_ps(t_near, _mm_set1_ps(data->hit.dist)));
+  const int mask = _mm_movemask_ps(hit);
+#  else
+  int mask = 0;
+  for (int lane = 0; lane < BVH_WIDE_WIDTH; lane++) {
+    float t_near = -FLT_MAX, t_far = FLT_MAX;
+    for (int axis = 0; axis < 3; axis++) {
+      const float origin = data->ray.origin[axis];
+      const float idot = data->idot_axis[axis];
+      t_near = max_ff(t_near, (node->bounds[data->index[2 * axis]][lane] - origin) * idot);
+      t_far = min_ff(t_far, (node->bounds[data->index[2 * axis + 1]][lane] - origin) * idot);
+    }
+    r_dist[lane] = t_near;
+    mask |= (t_near <= t_far && t_far >= 0.0f && t_near < data->hit.dist) << lane;
+  }
+#  endif
+  return mask & ((1 << node->children_num) - 1);
+}
+
+/**
+ * Traverse the wide tree visiting the closest children first, see #dfs_raycast and
+ * #dfs_raycast_all for the handling of leaves.
+ */
+static void wide_raycast(BVHRayCastData *data, const bool use_all)
+{
+  const BVHTree *tree = data->tree;
+  BVHWideStackItem stack[BVH_WIDE_STACK_SIZE];
+  int stack_len = 1;
+  stack[0].child = 0;
+  stack[0].dist = -FLT_MAX;
+
+  while (stack_len > 0) {
+    const BVHWideStackItem item = stack[--stack_len];
+    if (item.dist >= data->hit.dist) {
+      continue;
+    }
+
+    if (item.child < 0) {
+      const BVHNode *leaf = &tree->nodearray[-1 - item.child];
+      if (use_all) {
+        const float dist = data->hit.dist;
+        data->callback(data->userdata, leaf->index, &data->ray, &data->hit);
+        data->hit.index = -1;
+        data->hit.dist = dist;
+      }
+      else if (data->callback) {
+        data->callback(data->userdata, leaf->index, &data->ray, &data->hit);
+      }
+      else {
+        data->hit.index = leaf->index;
+        data->hit.dist = item.dist;
+        madd_v3_v3v3fl(data->hit.co, data->ray.origin, data->ray.direction, item.dist);
+      }
+      continue;
+    }
+
+    const BVHWideNode *node = &tree->wide_nodes[item.child];
+    float dist[BVH_WIDE_WIDTH];
+    const int mask = wide_node_ray_hit(data, node, dist);
+    stack_len = bvhtree_wide_stack_push(stack, stack_len, node, dist, mask);
+  }
+}
+
+#endif /* USE_WIDE_BVH */
+
 /**
  * A version of #dfs_raycast with minor changes to reset the index & dist each ray cast.
  */
@@ -2021,7 +2463,16 @@ int BLI_bvhtree_ray_cast_ex(const BVHTree *tree,
   }
 
   if (root) {
-    dfs_raycast(&data, root);
+#ifdef USE_WIDE_BVH
+    /* Like #fast_ray_nearest_hit, the wide tree doesn't support a ray radius. */
+    if (data.ray.radius == 0.0f && bvhtree_wide_ensure(tree)) {
+      wide_raycast(&data, false);
+    }
+    else
+#endif
+    {
+      dfs_raycast(&data, root);
+    }
     //      iterative_raycast(&data, root);
   }
 
@@ -2101,7 +2552,15 @@ void BLI_bvhtree_ray_cast_all_ex(const BVHTree *tree,
   data.hit.dist = hit_dist;
 
   if (root) {
-    dfs_raycast_all(&data, root);
+#ifdef USE_WIDE_BVH
+    if (data.ray.radius == 0.0f && bvhtree_wide_ensure(tree)) {
+      wide_raycast(&data, true);
+    }
+    else
+#endif
+    {
+      dfs_raycast_all(&data, root);
+    }
   }
 }
 
@@ -93,8 +93,10 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_array.hh"
 #include "BLI_listbase.h"
 #include "BLI_mempool.h"
+#include "BLI_task.hh"
 
 #include "BLI_array_store.h" /* Own include. */
 #include "BLI_ghash.h"       /* Only for #BLI_array_store_is_valid. */
@@ -868,21 +870,48 @@ BLI_INLINE void hash_accum_impl(hash_key *hash_array, const size_t i_dst, const
   hash_array[i_dst] += ((hash_array[i_ahead] << 3) ^ (hash_array[i_dst] >> 1));
 }
 
-static void hash_accum(hash_key *hash_array, const size_t hash_array_len, size_t iter_steps)
+/**
+ * Fill \a hash_array with the hashes of \a data (see #hash_array_from_data),
+ * each one accumulated with the hashes ahead of it for `info->accum_steps` iterations.
+ *
+ * An accumulated hash only depends on the hashes after it, up to the sum of all offsets.
+ * So the array is split into blocks that are hashed and accumulated independently in parallel,
+ * each block also hashing the elements it depends on past its end.
+ * This is the bulk of the work when adding a large array to the store.
+ */
+static void hash_array_from_data_accum(const BArrayInfo *info,
+                                       const uchar *data,
+                                       const size_t data_len,
+                                       hash_key *hash_array)
 {
-  /* _very_ unlikely, can happen if you select a chunk-size of 1 for example. */
-  if (UNLIKELY(iter_steps > hash_array_len)) {
-    iter_steps = hash_array_len;
-  }
-
+  const size_t hash_array_len = data_len / info->chunk_stride;
+  const size_t iter_steps = std::min(info->accum_steps, hash_array_len);
   const size_t hash_array_search_len = hash_array_len - iter_steps;
-  while (iter_steps != 0) {
-    const size_t hash_offset = iter_steps;
-    for (size_t i = 0; i < hash_array_search_len; i++) {
-      hash_accum_impl(hash_array, i, i + hash_offset);
-    }
-    iter_steps -= 1;
-  }
+  const size_t block_ahead_len = (iter_steps * (iter_steps + 1)) / 2;
+
+  blender::threading::parallel_for(
+      blender::IndexRange(int64_t(hash_array_len)), 8192, [&](const blender::IndexRange range) {
+        const size_t block_start = size_t(range.start());
+        const size_t block_end = std::min(size_t(range.one_after_last()) + block_ahead_len,
+                                          hash_array_len);
+        blender::Array<hash_key> block_hash_array(int64_t(block_end - block_start));
+        hash_array_from_data(info,
+                             &data[block_start * info->chunk_stride],
+                             (block_end - block_start) * info->chunk_stride,
+                             block_hash_array.data());
+        /* Only the values past the end of `range` that no value in `range` depends on are left
+         * incomplete. The last `accum_steps` values are never accumulated. */
+        for (size_t hash_offset = iter_steps; hash_offset != 0; hash_offset--) {
+          const size_t search_end = std::min(hash_array_search_len, block_end - hash_offset);
+          for (size_t i = block_start; i < search_end; i++) {
+            const size_t i_block = i - block_start;
+            hash_accum_impl(block_hash_array.data(), i_block, i_block + hash_offset);
+          }
+        }
+        memcpy(&hash_array[block_start],
+               block_hash_array.data(),
+               sizeof(hash_key) * size_t(range.size()));
+      });
 }
 
 /**
@@ -897,7 +926,7 @@ static void hash_accum_single(hash_key *hash_array, const size_t hash_array_len,
     iter_steps = hash_array_len;
   }
   /* We can increase this value each step to avoid accumulating quite as much
-   * while getting the same results as hash_accum. */
+   * while getting the same results as #hash_array_from_data_accum. */
   size_t iter_steps_sub = iter_steps;
 
   while (iter_steps != 0) {
@@ -1264,9 +1293,7 @@ static BChunkList *bchunk_list_from_data_merge(const BArrayInfo *info,
     const size_t table_hash_array_len = (data_len - i_prev) / info->chunk_stride;
     hash_key *table_hash_array = static_cast<hash_key *>(
         MEM_mallocN(sizeof(*table_hash_array) * table_hash_array_len, __func__));
-    hash_array_from_data(info, &data[i_prev], data_len - i_prev, table_hash_array);
-
-    hash_accum(table_hash_array, table_hash_array_len, info->accum_steps);
+    hash_array_from_data_accum(info, &data[i_prev], data_len - i_prev, table_hash_array);
 #else
     /* Dummy vars. */
     uint i_table_start = 0;
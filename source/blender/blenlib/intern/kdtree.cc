@@ -0,0 +1,99 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bli
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "BLI_kdtree.hh"
+#include "BLI_math_base.h"
+#include "BLI_task.hh"
+#include "BLI_vector.hh"
+
+namespace blender::kdtree {
+
+/**
+ * Queries are processed in fixed chunks so that the results of each chunk can be collected in
+ * a local buffer before they are copied to their final position.
+ */
+static constexpr int query_chunk_size = 1024;
+
+template<typename QueryFn>
+static NearestGroups batch_query(const int queries_num, const QueryFn &query_fn)
+{
+  NearestGroups result;
+  result.offset_data.reinitialize(queries_num + 1);
+
+  const IndexRange all_queries(queries_num);
+  const int chunks_num = divide_ceil_u(queries_num, query_chunk_size);
+  const auto chunk_queries = [&](const int chunk) {
+    return all_queries.intersect(IndexRange(chunk * query_chunk_size, query_chunk_size));
+  };
+
+  Array<Vector<KDTreeNearest_3d>> chunk_nearest(chunks_num);
+  threading::parallel_for(IndexRange(chunks_num), 1, [&](const IndexRange chunks) {
+    for (const int chunk : chunks) {
+      Vector<KDTreeNearest_3d> &nearest = chunk_nearest[chunk];
+      for (const int query : chunk_queries(chunk)) {
+        const int64_t start = nearest.size();
+        query_fn(query, nearest);
+        result.offset_data[query] = int(nearest.size() - start);
+      }
+    }
+  });
+
+  const OffsetIndices offsets = offset_indices::accumulate_counts_to_offsets(result.offset_data);
+  result.nearest.reinitialize(offsets.total_size());
+
+  threading::parallel_for(IndexRange(chunks_num), 1, [&](const IndexRange chunks) {
+    for (const int chunk : chunks) {
+      const IndexRange queries = chunk_queries(chunk);
+      const IndexRange dst_range = offsets[queries];
+      result.nearest.as_mutable_span().slice(dst_range).copy_from(chunk_nearest[chunk]);
+    }
+  });
+  return result;
+}
+
+NearestGroups find_nearest_n_batch(const KDTree_3d &tree,
+                                   const Span<float3> positions,
+                                   const int nearest_len_max)
+{
+  return batch_query(positions.size(), [&](const int query, Vector<KDTreeNearest_3d> &nearest) {
+    /* Search directly into the chunk buffer, then drop the unused elements. */
+    const int64_t start = nearest.size();
+    nearest.resize(start + nearest_len_max);
+    const int found = BLI_kdtree_3d_find_nearest_n(
+        &tree, positions[query], &nearest[start], uint(nearest_len_max));
+    nearest.resize(start + found);
+  });
+}
+
+NearestGroups range_search_batch(const KDTree_3d &tree,
+                                 const Span<float3> positions,
+                                 const float range)
+{
+  return batch_query(positions.size(), [&](const int query, Vector<KDTreeNearest_3d> &nearest) {
+    /* Use the callback version to avoid allocating an array for every query. */
+    const int64_t start = nearest.size();
+    BLI_kdtree_3d_range_search_cb_cpp(
+        &tree,
+        positions[query],
+        range,
+        [&](const int index, const float *co, const float dist_sq) {
+          nearest.append({index, std::sqrt(dist_sq), {co[0], co[1], co[2]}});
+          return true;
+        });
+    std::sort(nearest.begin() + start,
+              nearest.end(),
+              [](const KDTreeNearest_3d &a, const KDTreeNearest_3d &b) {
+                return a.dist < b.dist;
+              });
+  });
+}
+
+}  // namespace blender::kdtree
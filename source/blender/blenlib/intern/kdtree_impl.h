@@ -10,6 +10,7 @@
 
 #include "BLI_kdtree_impl.h"
 #include "BLI_math_base.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include <string.h>
@@ -50,6 +51,9 @@ struct KDTree {
 
 #define KD_NODE_UNSET ((uint)-1)
 
+/** Sub-trees with more nodes than this are balanced in parallel. */
+#define KD_BALANCE_PARALLEL_THRESHOLD 10000
+
 /**
  * When set we know all values are unbalanced,
  * otherwise clear them when re-balancing: see #62210.
@@ -139,19 +143,17 @@ void BLI_kdtree_nd_(insert)(KDTree *tree, int index, const float co[KD_DIMS])
 #endif
 }
 
-static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+/**
+ * Partition the nodes around the median along \a axis (quick-select),
+ * nodes before the median are less or equal, nodes after it greater or equal.
+ *
+ * \return the index of the median node, which is tagged to split along \a axis.
+ */
+static uint kdtree_balance_median(KDTreeNode *nodes, uint nodes_len, uint axis)
 {
-  KDTreeNode *node;
   float co;
   uint left, right, median, i, j;
 
-  if (nodes_len <= 0) {
-    return KD_NODE_UNSET;
-  }
-  else if (nodes_len == 1) {
-    return 0 + ofs;
-  }
-
   /* Quick-sort style sorting around median. */
   left = 0;
   right = nodes_len - 1;
@@ -184,9 +186,25 @@ static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const u
     }
   }
 
+  nodes[median].d = axis;
+  return median;
+}
+
+static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+{
+  KDTreeNode *node;
+  uint median;
+
+  if (nodes_len <= 0) {
+    return KD_NODE_UNSET;
+  }
+  else if (nodes_len == 1) {
+    return 0 + ofs;
+  }
+
   /* Set node and sort sub-nodes. */
+  median = kdtree_balance_median(nodes, nodes_len, axis);
   node = &nodes[median];
-  node->d = axis;
   axis = (axis + 1) % KD_DIMS;
   node->left = kdtree_balance(nodes, median, axis, ofs);
   node->right = kdtree_balance(
@@ -195,6 +213,70 @@ static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const u
   return median + ofs;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Parallel Balancing
+ *
+ * The sub-trees on both sides of a median are independent ranges of the node array,
+ * so large sub-trees are balanced as separate tasks. The result is identical to
+ * #kdtree_balance since the partitioning of each range doesn't depend on the order
+ * the ranges are processed in.
+ * \{ */
+
+typedef struct KDTreeBalanceTask {
+  KDTreeNode *nodes;
+  uint nodes_len;
+  uint axis;
+  uint ofs;
+} KDTreeBalanceTask;
+
+static void kdtree_balance_task_push(
+    TaskPool *pool, KDTreeNode *nodes, uint nodes_len, uint axis, uint ofs);
+
+static uint kdtree_balance_parallel(
+    TaskPool *pool, KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+{
+  KDTreeNode *node;
+  uint median, right_len;
+
+  if (nodes_len <= KD_BALANCE_PARALLEL_THRESHOLD) {
+    return kdtree_balance(nodes, nodes_len, axis, ofs);
+  }
+
+  median = kdtree_balance_median(nodes, nodes_len, axis);
+  node = &nodes[median];
+  axis = (axis + 1) % KD_DIMS;
+  right_len = nodes_len - (median + 1);
+
+  /* The root of a sub-tree is its median, which only depends on the length of the sub-tree,
+   * so the links can be set before the sub-trees are balanced (see #kdtree_balance). */
+  node->left = (median / 2) + ofs;
+  node->right = (right_len / 2) + (median + 1) + ofs;
+
+  kdtree_balance_task_push(pool, nodes, median, axis, ofs);
+  kdtree_balance_task_push(pool, nodes + median + 1, right_len, axis, (median + 1) + ofs);
+
+  return median + ofs;
+}
+
+static void kdtree_balance_task_run(TaskPool *__restrict pool, void *taskdata)
+{
+  const KDTreeBalanceTask *task = taskdata;
+  kdtree_balance_parallel(pool, task->nodes, task->nodes_len, task->axis, task->ofs);
+}
+
+static void kdtree_balance_task_push(
+    TaskPool *pool, KDTreeNode *nodes, uint nodes_len, uint axis, uint ofs)
+{
+  KDTreeBalanceTask *task = MEM_mallocN(sizeof(*task), __func__);
+  task->nodes = nodes;
+  task->nodes_len = nodes_len;
+  task->axis = axis;
+  task->ofs = ofs;
+  BLI_task_pool_push(pool, kdtree_balance_task_run, task, true, NULL);
+}
+
+/** \} */
+
 void BLI_kdtree_nd_(balance)(KDTree *tree)
 {
   if (tree->root != KD_NODE_ROOT_IS_INIT) {
@@ -204,7 +286,15 @@ void BLI_kdtree_nd_(balance)(KDTree *tree)
     }
   }
 
-  tree->root = kdtree_balance(tree->nodes, tree->nodes_len, 0, 0);
+  if (tree->nodes_len > KD_BALANCE_PARALLEL_THRESHOLD) {
+    TaskPool *pool = BLI_task_pool_create(NULL, TASK_PRIORITY_HIGH);
+    tree->root = kdtree_balance_parallel(pool, tree->nodes, tree->nodes_len, 0, 0);
+    BLI_task_pool_work_and_wait(pool);
+    BLI_task_pool_free(pool);
+  }
+  else {
+    tree->root = kdtree_balance(tree->nodes, tree->nodes_len, 0, 0);
+  }
 
 #ifndef NDEBUG
   tree->is_balanced = true;
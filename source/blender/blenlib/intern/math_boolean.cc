@@ -6,8 +6,11 @@
  * \ingroup bli
  */
 
+#include <cfloat>
+
 #include "BLI_math_boolean.hh"
 #include "BLI_math_mpq.hh"
+#include "BLI_math_vector.hh"
 #include "BLI_math_vector_types.hh"
 #include "BLI_span.hh"
 #include "BLI_utildefines.h"
@@ -2507,4 +2510,59 @@ int insphere_fast(
   return sgn(robust_pred::inspherefast(a, b, c, d, e));
 }
 
+/**
+ * The index of the #orient3d determinant, as defined in
+ * EXACT GEOMETRIC COMPUTATION USING CASCADING, by Burnikel, Funke, and Seel,
+ * when the input coordinates have index 1 (they are approximations of exact values).
+ * The coordinate differences have index 2, the 2x2 minors index 6,
+ * their products with a difference index 9, and the sum of three of those index 11.
+ */
+constexpr double index_orient3d = 11;
+
+double orient3d_static_error_bound(const double max_abs_coord)
+{
+  /* Every coordinate difference is bounded by `2 * max_abs_coord`, and the supremum of the
+   * determinant is a sum of 6 products of three differences. */
+  const double max_abs_diff = 2.0 * max_abs_coord;
+  const double supremum = 6.0 * max_abs_diff * max_abs_diff * max_abs_diff;
+  return supremum * index_orient3d * DBL_EPSILON;
+}
+
+int orient3d_filter(const double3 &a,
+                    const double3 &b,
+                    const double3 &c,
+                    const double3 &d,
+                    const double static_error_bound)
+{
+  const double3 ad = a - d;
+  const double3 bd = b - d;
+  const double3 cd = c - d;
+  const double det = ad.x * (bd.y * cd.z - bd.z * cd.y) + bd.x * (cd.y * ad.z - cd.z * ad.y) +
+                     cd.x * (ad.y * bd.z - ad.z * bd.y);
+
+  /* Static filter: the bound only depends on the range of the coordinates. */
+  if (fabs(det) > static_error_bound) {
+    return det > 0 ? 1 : -1;
+  }
+
+  /* Dynamic filter: compute the supremum of the determinant for these coordinates. */
+  const double3 abs_d = math::abs(d);
+  const double3 sup_ad = math::abs(a) + abs_d;
+  const double3 sup_bd = math::abs(b) + abs_d;
+  const double3 sup_cd = math::abs(c) + abs_d;
+  const double supremum = sup_ad.x * (sup_bd.y * sup_cd.z + sup_bd.z * sup_cd.y) +
+                          sup_bd.x * (sup_cd.y * sup_ad.z + sup_cd.z * sup_ad.y) +
+                          sup_cd.x * (sup_ad.y * sup_bd.z + sup_ad.z * sup_bd.y);
+  const double err_bound = supremum * index_orient3d * DBL_EPSILON;
+  if (fabs(det) > err_bound) {
+    return det > 0 ? 1 : -1;
+  }
+  return 0;
+}
+
+int orient3d_filter(const double3 &a, const double3 &b, const double3 &c, const double3 &d)
+{
+  return orient3d_filter(a, b, c, d, DBL_MAX);
+}
+
 }  // namespace blender
@@ -0,0 +1,183 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bli
+ */
+
+#include <cstring>
+
+#include "BLI_math_half.hh"
+#include "BLI_system.h"
+
+/* Blender is not built with F16C enabled, so the functions using it are compiled for it
+ * separately and only called when the CPU supports it. */
+#if defined(__x86_64__) || defined(_M_X64)
+#  include <immintrin.h>
+#  define BLI_HAVE_F16C 1
+#  if defined(__GNUC__)
+#    define BLI_TARGET_F16C __attribute__((target("avx,f16c")))
+#  else
+#    define BLI_TARGET_F16C
+#  endif
+#else
+#  define BLI_HAVE_F16C 0
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#  include <arm_neon.h>
+#  define BLI_HAVE_NEON_FP16 1
+#else
+#  define BLI_HAVE_NEON_FP16 0
+#endif
+
+namespace blender::math {
+
+static uint32_t float_as_uint(const float f)
+{
+  uint32_t u;
+  memcpy(&u, &f, sizeof(f));
+  return u;
+}
+
+static float uint_as_float(const uint32_t u)
+{
+  float f;
+  memcpy(&f, &u, sizeof(u));
+  return f;
+}
+
+/* Based on the public domain `float_to_half_fast3_rtne` and `half_to_float_fast4` functions by
+ * Fabian Giesen. */
+
+uint16_t float_to_half(const float v)
+{
+  const uint32_t f32_infinity = 255u << 23;
+  const uint32_t f16_max = (127u + 16u) << 23;
+  const uint32_t denorm_magic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+  uint32_t u = float_as_uint(v);
+  const uint32_t sign = u & 0x80000000u;
+  u ^= sign;
+
+  uint16_t result;
+  if (u >= f16_max) {
+    /* Overflow becomes infinity, NaN becomes quiet NaN. */
+    result = u > f32_infinity ? 0x7e00 : 0x7c00;
+  }
+  else if (u < (113u << 23)) {
+    /* Sub-normal half, let the float addition do the rounding. */
+    const float f = uint_as_float(u) + uint_as_float(denorm_magic);
+    result = uint16_t(float_as_uint(f) - denorm_magic);
+  }
+  else {
+    /* Normal half, re-bias the exponent and round the mantissa to nearest even. */
+    const uint32_t mantissa_odd = (u >> 13) & 1;
+    u += (uint32_t(15 - 127) << 23) + 0xfff;
+    u += mantissa_odd;
+    result = uint16_t(u >> 13);
+  }
+  return result | uint16_t(sign >> 16);
+}
+
+float half_to_float(const uint16_t v)
+{
+  const float magic = uint_as_float(113u << 23);
+  /* Exponent mask after the shift. */
+  const uint32_t shifted_exp = 0x7c00u << 13;
+
+  uint32_t u = (v & 0x7fffu) << 13;
+  const uint32_t exp = shifted_exp & u;
+  /* Re-bias the exponent. */
+  u += uint32_t(127 - 15) << 23;
+
+  float f;
+  if (exp == shifted_exp) {
+    /* Infinity or NaN, extra exponent adjust. */
+    u += uint32_t(128 - 16) << 23;
+    f = uint_as_float(u);
+  }
+  else if (exp == 0) {
+    /* Zero or sub-normal, renormalize. */
+    u += 1u << 23;
+    f = uint_as_float(u) - magic;
+  }
+  else {
+    f = uint_as_float(u);
+  }
+  return uint_as_float(float_as_uint(f) | (uint32_t(v & 0x8000u) << 16));
+}
+
+#if BLI_HAVE_F16C
+static bool cpu_supports_f16c()
+{
+  static const bool supported = BLI_cpu_support_f16c();
+  return supported;
+}
+
+/* Convert the multiple of 8 elements at the start of the arrays, returning the count. */
+BLI_TARGET_F16C static size_t float_to_half_array_f16c(const float *src,
+                                                       uint16_t *dst,
+                                                       const size_t length)
+{
+  size_t i = 0;
+  for (; i + 8 <= length; i += 8) {
+    const __m256 f = _mm256_loadu_ps(src + i);
+    const __m128i h = _mm256_cvtps_ph(f, _MM_FROUND_TO_NEAREST_INT);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), h);
+  }
+  return i;
+}
+
+BLI_TARGET_F16C static size_t half_to_float_array_f16c(const uint16_t *src,
+                                                       float *dst,
+                                                       const size_t length)
+{
+  size_t i = 0;
+  for (; i + 8 <= length; i += 8) {
+    const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+  }
+  return i;
+}
+#endif
+
+void float_to_half_array(const float *src, uint16_t *dst, const size_t length)
+{
+  size_t i = 0;
+#if BLI_HAVE_F16C
+  if (cpu_supports_f16c()) {
+    i = float_to_half_array_f16c(src, dst, length);
+  }
+#elif BLI_HAVE_NEON_FP16
+  for (; i + 4 <= length; i += 4) {
+    const float32x4_t f = vld1q_f32(src + i);
+    const float16x4_t h = vcvt_f16_f32(f);
+    vst1_u16(dst + i, vreinterpret_u16_f16(h));
+  }
+#endif
+  for (; i < length; i++) {
+    dst[i] = float_to_half(src[i]);
+  }
+}
+
+void half_to_float_array(const uint16_t *src, float *dst, const size_t length)
+{
+  size_t i = 0;
+#if BLI_HAVE_F16C
+  if (cpu_supports_f16c()) {
+    i = half_to_float_array_f16c(src, dst, length);
+  }
+#elif BLI_HAVE_NEON_FP16
+  for (; i + 4 <= length; i += 4) {
+    const float16x4_t h = vreinterpret_f16_u16(vld1_u16(src + i));
+    vst1q_f32(dst + i, vcvt_f32_f16(h));
+  }
+#endif
+  for (; i < length; i++) {
+    dst[i] = half_to_float(src[i]);
+  }
+}
+
+}  // namespace blender::math
@@ -10,6 +10,8 @@
 
 #  include <algorithm>
 #  include <atomic>
+#  include <cfloat>
+#  include <cmath>
 #  include <fstream>
 #  include <iostream>
 
@@ -119,12 +121,40 @@ static std::ostream &operator<<(std::ostream &os, const Array<int> &iarr)
   return os;
 }
 
-/** Holds information about topology of an #IMesh that is all triangles. */
+int boolean_topology_max_grid_resolution = 16;
+
+/**
+ * Holds information about topology of an #IMesh that is all triangles.
+ *
+ * The maps are split over the cells of a uniform grid covering the mesh, by the position of the
+ * first vertex of an edge, or of the vertex itself. Each cell only holds the topology of a small
+ * part of the mesh and is built independently, so large meshes are handled in parallel, and
+ * cut regions don't pay for hashing into maps sized for the whole mesh.
+ */
 class TriMeshTopology : NonCopyable {
-  /** Triangles that contain a given Edge (either order). */
-  Map<Edge, Vector<int> *> edge_tri_;
-  /** Edges incident on each vertex. */
-  Map<const Vert *, Vector<Edge>> vert_edges_;
+  struct Partition {
+    /** Triangles that contain a given Edge (either order). */
+    Map<Edge, Vector<int> *> edge_tri;
+    /** Edges incident on each vertex. */
+    Map<const Vert *, Vector<Edge>> vert_edges;
+  };
+  Array<Partition> partitions_;
+  int grid_resolution_ = 1;
+  double3 grid_min_ = double3(0.0);
+  double grid_scale_ = 0.0;
+
+  int partition_index(const Vert *v) const
+  {
+    if (grid_resolution_ == 1) {
+      return 0;
+    }
+    int index = 0;
+    for (int i = 2; i >= 0; i--) {
+      const int cell = int((v->co[i] - grid_min_[i]) * grid_scale_);
+      index = index * grid_resolution_ + std::clamp(cell, 0, grid_resolution_ - 1);
+    }
+    return index;
+  }
 
  public:
   TriMeshTopology(const IMesh &tm);
@@ -134,7 +164,7 @@ class TriMeshTopology : NonCopyable {
    * Else return NO_INDEX. */
   int other_tri_if_manifold(Edge e, int t) const
   {
-    const auto *p = edge_tri_.lookup_ptr(e);
+    const auto *p = partitions_[partition_index(e.v0())].edge_tri.lookup_ptr(e);
     if (p != nullptr && (*p)->size() == 2) {
       return ((**p)[0] == t) ? (**p)[1] : (**p)[0];
     }
@@ -144,90 +174,181 @@ class TriMeshTopology : NonCopyable {
   /* Which triangles share edge e (in either orientation)? */
   const Vector<int> *edge_tris(Edge e) const
   {
-    return edge_tri_.lookup_default(e, nullptr);
+    return partitions_[partition_index(e.v0())].edge_tri.lookup_default(e, nullptr);
   }
 
   /* Which edges are incident on the given vertex?
    * We assume v has some incident edges. */
   Span<Edge> vert_edges(const Vert *v) const
   {
-    return vert_edges_.lookup(v);
+    return partitions_[partition_index(v)].vert_edges.lookup(v);
+  }
+
+  IndexRange partition_range() const
+  {
+    return partitions_.index_range();
   }
 
-  Map<Edge, Vector<int> *>::ItemIterator edge_tri_map_items() const
+  /* The edge to triangles map of one partition, together they contain all edges. */
+  const Map<Edge, Vector<int> *> &edge_tri_map(int partition) const
   {
-    return edge_tri_.items();
+    return partitions_[partition].edge_tri;
   }
 };
 
+/**
+ * Group the triangle corners by the partition of their key vertex, keeping them in corner order
+ * in each group. Corner `i` of triangle `t` has index `3 * t + i`.
+ */
+static void group_corners_by_partition(const Span<int> corner_partition,
+                                       const int partitions_num,
+                                       Array<int> &r_offsets,
+                                       Array<int> &r_corners)
+{
+  r_offsets.reinitialize(partitions_num + 1);
+  r_offsets.fill(0);
+  for (const int partition : corner_partition) {
+    r_offsets[partition + 1]++;
+  }
+  for (const int i : IndexRange(partitions_num)) {
+    r_offsets[i + 1] += r_offsets[i];
+  }
+  Array<int> fill = r_offsets.as_span().drop_back(1);
+  r_corners.reinitialize(corner_partition.size());
+  for (const int corner : corner_partition.index_range()) {
+    r_corners[fill[corner_partition[corner]]++] = corner;
+  }
+}
+
 TriMeshTopology::TriMeshTopology(const IMesh &tm)
 {
   const int dbg_level = 0;
   if (dbg_level > 0) {
     std::cout << "TRIMESHTOPOLOGY CONSTRUCTION\n";
   }
-  /* If everything were manifold, `F+V-E=2` and `E=3F/2`.
-   * So an likely overestimate, allowing for non-manifoldness, is `E=2F` and `V=F`. */
-  const int estimate_num_edges = 2 * tm.face_size();
-  const int estimate_verts_num = tm.face_size();
-  edge_tri_.reserve(estimate_num_edges);
-  vert_edges_.reserve(estimate_verts_num);
-  for (int t : tm.face_index_range()) {
-    const Face &tri = *tm.face(t);
-    BLI_assert(tri.is_tri());
-    for (int i = 0; i < 3; ++i) {
-      const Vert *v = tri[i];
-      const Vert *vnext = tri[(i + 1) % 3];
-      Edge e(v, vnext);
-      Vector<Edge> *edges = vert_edges_.lookup_ptr(v);
-      if (edges == nullptr) {
-        vert_edges_.add_new(v, Vector<Edge>());
-        edges = vert_edges_.lookup_ptr(v);
-        BLI_assert(edges != nullptr);
-      }
-      edges->append_non_duplicates(e);
+  /* Roughly a thousand triangles per grid cell, for a mesh filling its bounds. Surfaces only go
+   * through a part of the cells, so the actual cells are larger. */
+  constexpr int tris_per_partition = 1024;
+  grid_resolution_ = std::clamp(int(std::cbrt(double(tm.face_size()) / tris_per_partition)),
+                                1,
+                                std::max(boolean_topology_max_grid_resolution, 1));
+  if (grid_resolution_ > 1) {
+    using MinMax = std::pair<double3, double3>;
+    const MinMax bounds = threading::parallel_reduce(
+        tm.face_index_range(),
+        4096,
+        MinMax(double3(DBL_MAX), double3(-DBL_MAX)),
+        [&](IndexRange range, MinMax minmax) {
+          for (const int t : range) {
+            for (const Vert *v : *tm.face(t)) {
+              minmax.first = math::min(minmax.first, v->co);
+              minmax.second = math::max(minmax.second, v->co);
+            }
+          }
+          return minmax;
+        },
+        [](const MinMax &a, const MinMax &b) {
+          return MinMax(math::min(a.first, b.first), math::max(a.second, b.second));
+        });
+    const double max_size = math::reduce_max(bounds.second - bounds.first);
+    if (max_size > 0.0) {
+      grid_min_ = bounds.first;
+      grid_scale_ = grid_resolution_ / max_size;
+    }
+    else {
+      grid_resolution_ = 1;
+    }
+  }
+  const int partitions_num = grid_resolution_ * grid_resolution_ * grid_resolution_;
+  partitions_.reinitialize(partitions_num);
 
-      auto *p = edge_tri_.lookup_ptr(Edge(v, vnext));
-      if (p == nullptr) {
-        edge_tri_.add_new(e, new Vector<int>{t});
+  /* Edges are stored in the partition of their first vertex, and in the vertex edges of the
+   * corner vertex only, like when adding the corners one by one. */
+  Array<int> edge_partition(tm.face_size() * 3);
+  Array<int> vert_partition(tm.face_size() * 3);
+  threading::parallel_for(tm.face_index_range(), 2048, [&](IndexRange range) {
+    for (const int t : range) {
+      const Face &tri = *tm.face(t);
+      BLI_assert(tri.is_tri());
+      for (int i = 0; i < 3; ++i) {
+        const Edge e(tri[i], tri[(i + 1) % 3]);
+        edge_partition[3 * t + i] = partition_index(e.v0());
+        vert_partition[3 * t + i] = partition_index(tri[i]);
       }
-      else {
-        (*p)->append_non_duplicates(t);
+    }
+  });
+  Array<int> edge_offsets;
+  Array<int> edge_corners;
+  Array<int> vert_offsets;
+  Array<int> vert_corners;
+  group_corners_by_partition(edge_partition, partitions_num, edge_offsets, edge_corners);
+  group_corners_by_partition(vert_partition, partitions_num, vert_offsets, vert_corners);
+
+  /* Corners are in increasing triangle order in each partition, so the triangle and edge vectors
+   * end up in the same order as when building from all triangles in a single pass. */
+  threading::parallel_for(partitions_.index_range(), 1, [&](IndexRange range) {
+    for (const int partition_i : range) {
+      Partition &partition = partitions_[partition_i];
+      const Span<int> edge_group = edge_corners.as_span().slice(
+          edge_offsets[partition_i], edge_offsets[partition_i + 1] - edge_offsets[partition_i]);
+      const Span<int> vert_group = vert_corners.as_span().slice(
+          vert_offsets[partition_i], vert_offsets[partition_i + 1] - vert_offsets[partition_i]);
+      /* Manifold edges are used by two corners, and vertices by about six corners. Overestimate
+       * a bit to allow for non-manifoldness. */
+      partition.edge_tri.reserve(edge_group.size() / 2);
+      partition.vert_edges.reserve(vert_group.size() / 4);
+      for (const int corner : edge_group) {
+        const int t = corner / 3;
+        const Face &tri = *tm.face(t);
+        const Edge e(tri[corner % 3], tri[(corner % 3 + 1) % 3]);
+        auto *p = partition.edge_tri.lookup_ptr(e);
+        if (p == nullptr) {
+          partition.edge_tri.add_new(e, new Vector<int>{t});
+        }
+        else {
+          (*p)->append_non_duplicates(t);
+        }
+      }
+      for (const int corner : vert_group) {
+        const Face &tri = *tm.face(corner / 3);
+        const Vert *v = tri[corner % 3];
+        const Edge e(v, tri[(corner % 3 + 1) % 3]);
+        partition.vert_edges.lookup_or_add_default(v).append_non_duplicates(e);
       }
     }
-  }
+  });
   /* Debugging. */
   if (dbg_level > 0) {
     std::cout << "After TriMeshTopology construction\n";
-    for (auto item : edge_tri_.items()) {
-      std::cout << "tris for edge " << item.key << ": " << *item.value << "\n";
-      constexpr bool print_stats = false;
-      if (print_stats) {
-        edge_tri_.print_stats("");
+    for (const Partition &partition : partitions_) {
+      for (auto item : partition.edge_tri.items()) {
+        std::cout << "tris for edge " << item.key << ": " << *item.value << "\n";
+        constexpr bool print_stats = false;
+        if (print_stats) {
+          partition.edge_tri.print_stats("");
+        }
       }
     }
-    for (auto item : vert_edges_.items()) {
-      std::cout << "edges for vert " << item.key << ":\n";
-      for (const Edge &e : item.value) {
-        std::cout << "  " << e << "\n";
+    for (const Partition &partition : partitions_) {
+      for (auto item : partition.vert_edges.items()) {
+        std::cout << "edges for vert " << item.key << ":\n";
+        for (const Edge &e : item.value) {
+          std::cout << "  " << e << "\n";
+        }
+        std::cout << "\n";
       }
-      std::cout << "\n";
     }
   }
 }
 
 TriMeshTopology::~TriMeshTopology()
 {
-  Vector<Vector<int> *> values;
-
-  /* Deconstructing is faster in parallel, so it is worth building an array of things to delete. */
-  for (auto *item : edge_tri_.values()) {
-    values.append(item);
-  }
-
-  threading::parallel_for(values.index_range(), 256, [&](IndexRange range) {
-    for (int i : range) {
-      delete values[i];
+  /* Deconstructing is faster in parallel. */
+  threading::parallel_for(partitions_.index_range(), 1, [&](IndexRange range) {
+    for (const int partition : range) {
+      for (Vector<int> *tris : partitions_[partition].edge_tri.values()) {
+        delete tris;
+      }
     }
   });
 }
@@ -890,9 +1011,6 @@ static int sort_tris_class(const Face &tri, const Face &tri0, const Edge e)
   if (dbg_level > 0) {
     std::cout << "classify  e = " << e << "\n";
   }
-  mpq3 a0 = tri0[0]->co_exact;
-  mpq3 a1 = tri0[1]->co_exact;
-  mpq3 a2 = tri0[2]->co_exact;
   bool rev;
   bool rev0;
   const Vert *flapv0 = find_flap_vert(tri0, e, &rev0);
@@ -904,9 +1022,12 @@ static int sort_tris_class(const Face &tri, const Face &tri0, const Edge e)
     std::cout << " rev = " << rev << " flapv = " << flapv << "\n";
   }
   BLI_assert(flapv != nullptr && flapv0 != nullptr);
-  const mpq3 flap = flapv->co_exact;
-  /* orient will be positive if flap is below oriented plane of a0,a1,a2. */
-  int orient = orient3d(a0, a1, a2, flap);
+  /* orient will be positive if flap is below oriented plane of tri0.
+   * Try the approximate coordinates first, only use exact arithmetic when that is inconclusive. */
+  int orient = orient3d_filter(tri0[0]->co, tri0[1]->co, tri0[2]->co, flapv->co);
+  if (orient == 0) {
+    orient = orient3d(tri0[0]->co_exact, tri0[1]->co_exact, tri0[2]->co_exact, flapv->co_exact);
+  }
   int ans;
   if (orient > 0) {
     ans = rev0 ? 4 : 3;
@@ -1346,44 +1467,40 @@ static bool is_pwn(const IMesh &tm, const TriMeshTopology &tmtopo)
 {
   constexpr int dbg_level = 0;
   std::atomic<bool> is_pwn = true;
-  Vector<std::pair<Edge, Vector<int> *>> tris;
-
-  for (auto item : tmtopo.edge_tri_map_items()) {
-    tris.append(std::pair<Edge, Vector<int> *>(item.key, item.value));
-  }
-
-  threading::parallel_for(tris.index_range(), 2048, [&](IndexRange range) {
-    if (!is_pwn.load()) {
-      /* Early out if mesh is already determined to be non-pwn. */
-      return;
-    }
-
-    for (int j : range) {
-      const Edge &edge = tris[j].first;
-      int tot_orient = 0;
-      /* For each face t attached to edge, add +1 if the edge
-       * is positively in t, and -1 if negatively in t. */
-      for (int t : *tris[j].second) {
-        const Face &face = *tm.face(t);
-        BLI_assert(face.size() == 3);
-        for (int i : face.index_range()) {
-          if (face[i] == edge.v0()) {
-            if (face[(i + 1) % 3] == edge.v1()) {
-              ++tot_orient;
-            }
-            else {
-              BLI_assert(face[(i + 3 - 1) % 3] == edge.v1());
-              --tot_orient;
+
+  threading::parallel_for(tmtopo.partition_range(), 1, [&](IndexRange range) {
+    for (const int partition : range) {
+      for (auto item : tmtopo.edge_tri_map(partition).items()) {
+        if (!is_pwn.load()) {
+          /* Early out if mesh is already determined to be non-pwn. */
+          return;
+        }
+        const Edge &edge = item.key;
+        int tot_orient = 0;
+        /* For each face t attached to edge, add +1 if the edge
+         * is positively in t, and -1 if negatively in t. */
+        for (int t : *item.value) {
+          const Face &face = *tm.face(t);
+          BLI_assert(face.size() == 3);
+          for (int i : face.index_range()) {
+            if (face[i] == edge.v0()) {
+              if (face[(i + 1) % 3] == edge.v1()) {
+                ++tot_orient;
+              }
+              else {
+                BLI_assert(face[(i + 3 - 1) % 3] == edge.v1());
+                --tot_orient;
+              }
             }
           }
         }
-      }
-      if (tot_orient != 0) {
-        if (dbg_level > 0) {
-          std::cout << "edge causing non-pwn: " << edge << "\n";
+        if (tot_orient != 0) {
+          if (dbg_level > 0) {
+            std::cout << "edge causing non-pwn: " << edge << "\n";
+          }
+          is_pwn = false;
+          return;
         }
-        is_pwn = false;
-        break;
       }
     }
   });
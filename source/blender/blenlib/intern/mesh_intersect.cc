@@ -22,6 +22,7 @@
 #  include "BLI_hash.hh"
 #  include "BLI_kdopbvh.h"
 #  include "BLI_map.hh"
+#  include "BLI_math_boolean.hh"
 #  include "BLI_math_geom.h"
 #  include "BLI_math_matrix.h"
 #  include "BLI_math_mpq.hh"
@@ -846,8 +847,9 @@ static void calc_face_bb_reduce(const void *__restrict /*userdata*/,
  * We will expand the bounding boxes by an epsilon on all sides so that
  * the "less than" tests in isect_aabb_aabb_v3 are sufficient to detect
  * touching or overlap.
+ * The largest absolute value of any vertex coordinate is returned in \a r_max_abs_val.
  */
-static Array<BoundingBox> calc_face_bounding_boxes(const IMesh &m)
+static Array<BoundingBox> calc_face_bounding_boxes(const IMesh &m, double *r_max_abs_val)
 {
   int n = m.face_size();
   Array<BoundingBox> ans(n);
@@ -862,6 +864,7 @@ static Array<BoundingBox> calc_face_bounding_boxes(const IMesh &m)
   settings.use_threading = intersect_use_threading;
   BLI_task_parallel_range(0, n, &data, calc_face_bb_range_func, &settings);
   double max_abs_val = chunk_data.max_abs_val;
+  *r_max_abs_val = max_abs_val;
   constexpr float pad_factor = 10.0f;
   float pad = max_abs_val == 0.0f ? FLT_EPSILON : 2 * FLT_EPSILON * max_abs_val;
   pad *= pad_factor; /* For extra safety. */
@@ -1123,6 +1126,15 @@ static int filter_plane_side(const double3 &p,
   return 0;
 }
 
+/**
+ * Whether \a v is one of the vertices of \a tri. Such vertices are exactly on the plane of the
+ * triangle, which is common for neighboring triangles, so no arithmetic is needed to know that.
+ */
+static inline bool tri_has_vert(const Face &tri, const Vert *v)
+{
+  return ELEM(v, tri[0], tri[1], tri[2]);
+}
+
 /*
  * #intersect_tri_tri and helper functions.
  * This code uses the algorithm of Guigue and Devillers, as described
@@ -1153,31 +1165,47 @@ static inline mpq3 tti_interp(
 }
 
 /**
- * Return +1, 0, -1 as a + ad is above, on, or below the oriented plane containing a, b, c in CCW
- * order. This is the same as -oriented(a, b, c, a + ad), but uses fewer arithmetic operations.
- * TODO: change arguments to `const Vert *` and use floating filters.
+ * Return +1, 0, -1 as d is above, on, or below the oriented plane containing a, b, c in CCW
+ * order. This is the same as -oriented(a, b, c, d), but uses fewer arithmetic operations.
+ * The sign is decided without exact arithmetic when two of the vertices are the same, or when
+ * #orient3d_filter succeeds on the approximate coordinates.
  * The ba, ca, n, and dotbuf arguments are used as temporaries; declaring them
  * in the caller can avoid many allocations and frees of mpq3 and mpq_class structures.
  */
-static inline int tti_above(const mpq3 &a,
-                            const mpq3 &b,
-                            const mpq3 &c,
-                            const mpq3 &ad,
+static inline int tti_above(const Vert *a,
+                            const Vert *b,
+                            const Vert *c,
+                            const Vert *d,
+                            const double orient3d_static_bound,
                             mpq3 &ba,
                             mpq3 &ca,
                             mpq3 &n,
                             mpq3 &dotbuf)
 {
-  ba = b;
-  ba -= a;
-  ca = c;
-  ca -= a;
+  if (ELEM(d, a, b, c) || ELEM(a, b, c) || b == c) {
+    return 0;
+  }
+  const int filter_orient = orient3d_filter(a->co, b->co, c->co, d->co, orient3d_static_bound);
+  if (filter_orient != 0) {
+#  ifdef PERFDEBUG
+    incperfcount(5); /* Above tests decided by the filter. */
+#  endif
+    return -filter_orient;
+  }
+
+  ba = b->co_exact;
+  ba -= a->co_exact;
+  ca = c->co_exact;
+  ca -= a->co_exact;
 
   n.x = ba.y * ca.z - ba.z * ca.y;
   n.y = ba.z * ca.x - ba.x * ca.z;
   n.z = ba.x * ca.y - ba.y * ca.x;
 
-  return sgn(math::dot_with_buffer(ad, n, dotbuf));
+  /* Re-use `ba` for `d - a`. */
+  ba = d->co_exact;
+  ba -= a->co_exact;
+  return sgn(math::dot_with_buffer(ba, n, dotbuf));
 }
 
 /**
@@ -1193,16 +1221,23 @@ static inline int tti_above(const mpq3 &a,
  *   of the plane and at least one of q1 and r1 are off the plane.
  * Similarly for p2, q2, r2 with respect to the first triangle's plane.
  */
-static ITT_value itt_canon2(const mpq3 &p1,
-                            const mpq3 &q1,
-                            const mpq3 &r1,
-                            const mpq3 &p2,
-                            const mpq3 &q2,
-                            const mpq3 &r2,
+static ITT_value itt_canon2(const Vert *vp1,
+                            const Vert *vq1,
+                            const Vert *vr1,
+                            const Vert *vp2,
+                            const Vert *vq2,
+                            const Vert *vr2,
                             const mpq3 &n1,
-                            const mpq3 &n2)
+                            const mpq3 &n2,
+                            const double orient3d_static_bound)
 {
   constexpr int dbg_level = 0;
+  const mpq3 &p1 = vp1->co_exact;
+  const mpq3 &q1 = vq1->co_exact;
+  const mpq3 &r1 = vr1->co_exact;
+  const mpq3 &p2 = vp2->co_exact;
+  const mpq3 &q2 = vq2->co_exact;
+  const mpq3 &r2 = vr2->co_exact;
   if (dbg_level > 0) {
     std::cout << "\ntri_tri_intersect_canon:\n";
     std::cout << "p1=" << p1 << " q1=" << q1 << " r1=" << r1 << "\n";
@@ -1218,17 +1253,19 @@ static ITT_value itt_canon2(const mpq3 &p1,
     std::cout << "n1=(" << n1[0].get_d() << "," << n1[1].get_d() << "," << n1[2].get_d() << ")\n";
     std::cout << "n2=(" << n2[0].get_d() << "," << n2[1].get_d() << "," << n2[2].get_d() << ")\n";
   }
-  mpq3 p1p2 = p2 - p1;
   mpq3 intersect_1;
   mpq3 intersect_2;
   mpq3 buf[4];
+  const auto tti_above_p2 = [&](const Vert *a, const Vert *b) {
+    return tti_above(vp1, a, b, vp2, orient3d_static_bound, buf[0], buf[1], buf[2], buf[3]);
+  };
   bool no_overlap = false;
   /* Top test in classification tree. */
-  if (tti_above(p1, q1, r2, p1p2, buf[0], buf[1], buf[2], buf[3]) > 0) {
+  if (tti_above_p2(vq1, vr2) > 0) {
     /* Middle right test in classification tree. */
-    if (tti_above(p1, r1, r2, p1p2, buf[0], buf[1], buf[2], buf[3]) <= 0) {
+    if (tti_above_p2(vr1, vr2) <= 0) {
       /* Bottom right test in classification tree. */
-      if (tti_above(p1, r1, q2, p1p2, buf[0], buf[1], buf[2], buf[3]) > 0) {
+      if (tti_above_p2(vr1, vq2) > 0) {
         /* Overlap is [k [i l] j]. */
         if (dbg_level > 0) {
           std::cout << "overlap [k [i l] j]\n";
@@ -1257,7 +1294,7 @@ static ITT_value itt_canon2(const mpq3 &p1,
   }
   else {
     /* Middle left test in classification tree. */
-    if (tti_above(p1, q1, q2, p1p2, buf[0], buf[1], buf[2], buf[3]) < 0) {
+    if (tti_above_p2(vq1, vq2) < 0) {
       /* No overlap: [i j] [k l]. */
       if (dbg_level > 0) {
         std::cout << "no overlap: [i j] [k l]\n";
@@ -1266,7 +1303,7 @@ static ITT_value itt_canon2(const mpq3 &p1,
     }
     else {
       /* Bottom left test in classification tree. */
-      if (tti_above(p1, r1, q2, p1p2, buf[0], buf[1], buf[2], buf[3]) >= 0) {
+      if (tti_above_p2(vr1, vq2) >= 0) {
         /* Overlap is [k [i j] l]. */
         if (dbg_level > 0) {
           std::cout << "overlap [k [i j] l]\n";
@@ -1303,54 +1340,55 @@ static ITT_value itt_canon2(const mpq3 &p1,
 
 /* Helper function for intersect_tri_tri. Arguments have been canonicalized for triangle 1. */
 
-static ITT_value itt_canon1(const mpq3 &p1,
-                            const mpq3 &q1,
-                            const mpq3 &r1,
-                            const mpq3 &p2,
-                            const mpq3 &q2,
-                            const mpq3 &r2,
+static ITT_value itt_canon1(const Vert *p1,
+                            const Vert *q1,
+                            const Vert *r1,
+                            const Vert *p2,
+                            const Vert *q2,
+                            const Vert *r2,
                             const mpq3 &n1,
                             const mpq3 &n2,
                             int sp2,
                             int sq2,
-                            int sr2)
+                            int sr2,
+                            const double orient3d_static_bound)
 {
   constexpr int dbg_level = 0;
   if (sp2 > 0) {
     if (sq2 > 0) {
-      return itt_canon2(p1, r1, q1, r2, p2, q2, n1, n2);
+      return itt_canon2(p1, r1, q1, r2, p2, q2, n1, n2, orient3d_static_bound);
     }
     if (sr2 > 0) {
-      return itt_canon2(p1, r1, q1, q2, r2, p2, n1, n2);
+      return itt_canon2(p1, r1, q1, q2, r2, p2, n1, n2, orient3d_static_bound);
     }
-    return itt_canon2(p1, q1, r1, p2, q2, r2, n1, n2);
+    return itt_canon2(p1, q1, r1, p2, q2, r2, n1, n2, orient3d_static_bound);
   }
   if (sp2 < 0) {
     if (sq2 < 0) {
-      return itt_canon2(p1, q1, r1, r2, p2, q2, n1, n2);
+      return itt_canon2(p1, q1, r1, r2, p2, q2, n1, n2, orient3d_static_bound);
     }
     if (sr2 < 0) {
-      return itt_canon2(p1, q1, r1, q2, r2, p2, n1, n2);
+      return itt_canon2(p1, q1, r1, q2, r2, p2, n1, n2, orient3d_static_bound);
     }
-    return itt_canon2(p1, r1, q1, p2, q2, r2, n1, n2);
+    return itt_canon2(p1, r1, q1, p2, q2, r2, n1, n2, orient3d_static_bound);
   }
   if (sq2 < 0) {
     if (sr2 >= 0) {
-      return itt_canon2(p1, r1, q1, q2, r2, p2, n1, n2);
+      return itt_canon2(p1, r1, q1, q2, r2, p2, n1, n2, orient3d_static_bound);
     }
-    return itt_canon2(p1, q1, r1, p2, q2, r2, n1, n2);
+    return itt_canon2(p1, q1, r1, p2, q2, r2, n1, n2, orient3d_static_bound);
   }
   if (sq2 > 0) {
     if (sr2 > 0) {
-      return itt_canon2(p1, r1, q1, p2, q2, r2, n1, n2);
+      return itt_canon2(p1, r1, q1, p2, q2, r2, n1, n2, orient3d_static_bound);
     }
-    return itt_canon2(p1, q1, r1, q2, r2, p2, n1, n2);
+    return itt_canon2(p1, q1, r1, q2, r2, p2, n1, n2, orient3d_static_bound);
   }
   if (sr2 > 0) {
-    return itt_canon2(p1, q1, r1, r2, p2, q2, n1, n2);
+    return itt_canon2(p1, q1, r1, r2, p2, q2, n1, n2, orient3d_static_bound);
   }
   if (sr2 < 0) {
-    return itt_canon2(p1, r1, q1, r2, p2, q2, n1, n2);
+    return itt_canon2(p1, r1, q1, r2, p2, q2, n1, n2, orient3d_static_bound);
   }
   if (dbg_level > 0) {
     std::cout << "triangles are co-planar\n";
@@ -1358,7 +1396,10 @@ static ITT_value itt_canon1(const mpq3 &p1,
   return ITT_value(ICOPLANAR);
 }
 
-static ITT_value intersect_tri_tri(const IMesh &tm, int t1, int t2)
+static ITT_value intersect_tri_tri(const IMesh &tm,
+                                   int t1,
+                                   int t2,
+                                   const double orient3d_static_bound)
 {
   constexpr int dbg_level = 0;
 #  ifdef PERFDEBUG
@@ -1442,17 +1483,17 @@ static ITT_value intersect_tri_tri(const IMesh &tm, int t1, int t2)
   const mpq3 &r2 = vr2->co_exact;
 
   const mpq3 &n2 = tri2.plane->norm_exact;
-  if (sp1 == 0) {
+  if (sp1 == 0 && !tri_has_vert(tri2, vp1)) {
     buf[0] = p1;
     buf[0] -= r2;
     sp1 = sgn(math::dot_with_buffer(buf[0], n2, buf[1]));
   }
-  if (sq1 == 0) {
+  if (sq1 == 0 && !tri_has_vert(tri2, vq1)) {
     buf[0] = q1;
     buf[0] -= r2;
     sq1 = sgn(math::dot_with_buffer(buf[0], n2, buf[1]));
   }
-  if (sr1 == 0) {
+  if (sr1 == 0 && !tri_has_vert(tri2, vr1)) {
     buf[0] = r1;
     buf[0] -= r2;
     sr1 = sgn(math::dot_with_buffer(buf[0], n2, buf[1]));
@@ -1474,17 +1515,17 @@ static ITT_value intersect_tri_tri(const IMesh &tm, int t1, int t2)
 
   /* Repeat for signs of t2's vertices with respect to plane of t1. */
   const mpq3 &n1 = tri1.plane->norm_exact;
-  if (sp2 == 0) {
+  if (sp2 == 0 && !tri_has_vert(tri1, vp2)) {
     buf[0] = p2;
     buf[0] -= r1;
     sp2 = sgn(math::dot_with_buffer(buf[0], n1, buf[1]));
   }
-  if (sq2 == 0) {
+  if (sq2 == 0 && !tri_has_vert(tri1, vq2)) {
     buf[0] = q2;
     buf[0] -= r1;
     sq2 = sgn(math::dot_with_buffer(buf[0], n1, buf[1]));
   }
-  if (sr2 == 0) {
+  if (sr2 == 0 && !tri_has_vert(tri1, vr2)) {
     buf[0] = r2;
     buf[0] -= r1;
     sr2 = sgn(math::dot_with_buffer(buf[0], n1, buf[1]));
@@ -1510,49 +1551,61 @@ static ITT_value intersect_tri_tri(const IMesh &tm, int t1, int t2)
   ITT_value ans;
   if (sp1 > 0) {
     if (sq1 > 0) {
-      ans = itt_canon1(r1, p1, q1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+      ans = itt_canon1(
+          vr1, vp1, vq1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2, orient3d_static_bound);
     }
     else if (sr1 > 0) {
-      ans = itt_canon1(q1, r1, p1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+      ans = itt_canon1(
+          vq1, vr1, vp1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2, orient3d_static_bound);
     }
     else {
-      ans = itt_canon1(p1, q1, r1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+      ans = itt_canon1(
+          vp1, vq1, vr1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2, orient3d_static_bound);
     }
   }
   else if (sp1 < 0) {
     if (sq1 < 0) {
-      ans = itt_canon1(r1, p1, q1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+      ans = itt_canon1(
+          vr1, vp1, vq1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2, orient3d_static_bound);
     }
     else if (sr1 < 0) {
-      ans = itt_canon1(q1, r1, p1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+      ans = itt_canon1(
+          vq1, vr1, vp1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2, orient3d_static_bound);
     }
     else {
-      ans = itt_canon1(p1, q1, r1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+      ans = itt_canon1(
+          vp1, vq1, vr1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2, orient3d_static_bound);
     }
   }
   else {
     if (sq1 < 0) {
       if (sr1 >= 0) {
-        ans = itt_canon1(q1, r1, p1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+        ans = itt_canon1(
+            vq1, vr1, vp1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2, orient3d_static_bound);
       }
       else {
-        ans = itt_canon1(p1, q1, r1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+        ans = itt_canon1(
+            vp1, vq1, vr1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2, orient3d_static_bound);
       }
     }
     else if (sq1 > 0) {
       if (sr1 > 0) {
-        ans = itt_canon1(p1, q1, r1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+        ans = itt_canon1(
+            vp1, vq1, vr1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2, orient3d_static_bound);
       }
       else {
-        ans = itt_canon1(q1, r1, p1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+        ans = itt_canon1(
+            vq1, vr1, vp1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2, orient3d_static_bound);
       }
     }
     else {
       if (sr1 > 0) {
-        ans = itt_canon1(r1, p1, q1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+        ans = itt_canon1(
+            vr1, vp1, vq1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2, orient3d_static_bound);
       }
       else if (sr1 < 0) {
-        ans = itt_canon1(r1, p1, q1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+        ans = itt_canon1(
+            vr1, vp1, vq1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2, orient3d_static_bound);
       }
       else {
         if (dbg_level > 0) {
@@ -2463,9 +2516,17 @@ struct OverlapIttsData {
   Map<std::pair<int, int>, ITT_value> &itt_map;
   const IMesh &tm;
   IMeshArena *arena;
-
-  OverlapIttsData(Map<std::pair<int, int>, ITT_value> &itt_map, const IMesh &tm, IMeshArena *arena)
-      : itt_map(itt_map), tm(tm), arena(arena)
+  /** Error bound for #orient3d_filter that is valid for all vertices of #tm. */
+  double orient3d_static_bound;
+
+  OverlapIttsData(Map<std::pair<int, int>, ITT_value> &itt_map,
+                  const IMesh &tm,
+                  IMeshArena *arena,
+                  double max_abs_val)
+      : itt_map(itt_map),
+        tm(tm),
+        arena(arena),
+        orient3d_static_bound(orient3d_static_error_bound(max_abs_val))
   {
   }
 };
@@ -2494,7 +2555,7 @@ static void calc_overlap_itts_range_func(void *__restrict userdata,
   if (dbg_level > 0) {
     std::cout << "calc_overlap_itts_range_func a=" << a << ", b=" << b << "\n";
   }
-  ITT_value itt = intersect_tri_tri(data->tm, a, b);
+  ITT_value itt = intersect_tri_tri(data->tm, a, b, data->orient3d_static_bound);
   if (dbg_level > 0) {
     std::cout << "result of intersecting " << a << " and " << b << " = " << itt << "\n";
   }
@@ -2509,9 +2570,10 @@ static void calc_overlap_itts_range_func(void *__restrict userdata,
 static void calc_overlap_itts(Map<std::pair<int, int>, ITT_value> &itt_map,
                               const IMesh &tm,
                               const TriOverlaps &ov,
+                              const double max_abs_val,
                               IMeshArena *arena)
 {
-  OverlapIttsData data(itt_map, tm, arena);
+  OverlapIttsData data(itt_map, tm, arena, max_abs_val);
   /* Put dummy values in `itt_map` initially,
    * so map entries will exist when doing the range function.
    * This means we won't have to protect the `itt_map.add_overwrite` function with a lock. */
@@ -2976,7 +3038,8 @@ IMesh trimesh_nary_intersect(const IMesh &tm_in,
   double clean_time = BLI_time_now_seconds();
   std::cout << "cleaned, time = " << clean_time - start_time << "\n";
 #  endif
-  Array<BoundingBox> tri_bb = calc_face_bounding_boxes(*tm_clean);
+  double max_abs_val;
+  Array<BoundingBox> tri_bb = calc_face_bounding_boxes(*tm_clean, &max_abs_val);
 #  ifdef PERFDEBUG
   double bb_calc_time = BLI_time_now_seconds();
   std::cout << "bbs calculated, time = " << bb_calc_time - clean_time << "\n";
@@ -3003,7 +3066,7 @@ IMesh trimesh_nary_intersect(const IMesh &tm_in,
    * triangles with indices a and b, where a < b. */
   Map<std::pair<int, int>, ITT_value> itt_map;
   itt_map.reserve(tri_ov.overlap().size());
-  calc_overlap_itts(itt_map, *tm_clean, tri_ov, arena);
+  calc_overlap_itts(itt_map, *tm_clean, tri_ov, max_abs_val, arena);
 #  ifdef PERFDEBUG
   double itt_time = BLI_time_now_seconds();
   std::cout << "itts found, time = " << itt_time - plane_populate << "\n";
@@ -3176,6 +3239,10 @@ static void perfdata_init()
   perfdata->count.append(0);
   perfdata->count_name.append("final non-NONE intersects");
 
+  /* count 5. */
+  perfdata->count.append(0);
+  perfdata->count_name.append("tri tri above tests decided by filter");
+
   /* max 0. */
   perfdata->max.append(0);
   perfdata->max_name.append("total faces");
@@ -8,10 +8,13 @@
 #include <cmath>
 #include <cstdint>
 
+#include "BLI_array.hh"
 #include "BLI_math_base_safe.h"
 #include "BLI_math_vector.hh"
 #include "BLI_noise.hh"
+#include "BLI_simd.hh"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 namespace blender::noise {
 
@@ -559,28 +562,493 @@ float perlin(float4 position)
   return perlin_signed(position) / 2.0f + 0.5f;
 }
 
+/* Batch versions of signed perlin noise.
+ *
+ * With SSE2, four positions are evaluated at once. Every operation is the same as in the
+ * functions above, including the ones that are done in double precision, so the results are
+ * exactly the same. */
+
+#if BLI_HAVE_SSE2
+
+template<int k> BLI_INLINE __m128i hash_bit_rotate_sse(const __m128i x)
+{
+  return _mm_or_si128(_mm_slli_epi32(x, k), _mm_srli_epi32(x, 32 - k));
+}
+
+BLI_INLINE void hash_bit_mix_sse(__m128i &a, __m128i &b, __m128i &c)
+{
+  a = _mm_sub_epi32(a, c);
+  a = _mm_xor_si128(a, hash_bit_rotate_sse<4>(c));
+  c = _mm_add_epi32(c, b);
+  b = _mm_sub_epi32(b, a);
+  b = _mm_xor_si128(b, hash_bit_rotate_sse<6>(a));
+  a = _mm_add_epi32(a, c);
+  c = _mm_sub_epi32(c, b);
+  c = _mm_xor_si128(c, hash_bit_rotate_sse<8>(b));
+  b = _mm_add_epi32(b, a);
+  a = _mm_sub_epi32(a, c);
+  a = _mm_xor_si128(a, hash_bit_rotate_sse<16>(c));
+  c = _mm_add_epi32(c, b);
+  b = _mm_sub_epi32(b, a);
+  b = _mm_xor_si128(b, hash_bit_rotate_sse<19>(a));
+  a = _mm_add_epi32(a, c);
+  c = _mm_sub_epi32(c, b);
+  c = _mm_xor_si128(c, hash_bit_rotate_sse<4>(b));
+  b = _mm_add_epi32(b, a);
+}
+
+BLI_INLINE void hash_bit_final_sse(__m128i &a, __m128i &b, __m128i &c)
+{
+  c = _mm_xor_si128(c, b);
+  c = _mm_sub_epi32(c, hash_bit_rotate_sse<14>(b));
+  a = _mm_xor_si128(a, c);
+  a = _mm_sub_epi32(a, hash_bit_rotate_sse<11>(c));
+  b = _mm_xor_si128(b, a);
+  b = _mm_sub_epi32(b, hash_bit_rotate_sse<25>(a));
+  c = _mm_xor_si128(c, b);
+  c = _mm_sub_epi32(c, hash_bit_rotate_sse<16>(b));
+  a = _mm_xor_si128(a, c);
+  a = _mm_sub_epi32(a, hash_bit_rotate_sse<4>(c));
+  b = _mm_xor_si128(b, a);
+  b = _mm_sub_epi32(b, hash_bit_rotate_sse<14>(a));
+  c = _mm_xor_si128(c, b);
+  c = _mm_sub_epi32(c, hash_bit_rotate_sse<24>(b));
+}
+
+BLI_INLINE __m128i hash_sse(const __m128i kx, const __m128i ky)
+{
+  __m128i a, b, c;
+  a = b = c = _mm_set1_epi32(int(0xdeadbeef + (2 << 2) + 13));
+
+  b = _mm_add_epi32(b, ky);
+  a = _mm_add_epi32(a, kx);
+  hash_bit_final_sse(a, b, c);
+
+  return c;
+}
+
+BLI_INLINE __m128i hash_sse(const __m128i kx, const __m128i ky, const __m128i kz)
+{
+  __m128i a, b, c;
+  a = b = c = _mm_set1_epi32(int(0xdeadbeef + (3 << 2) + 13));
+
+  c = _mm_add_epi32(c, kz);
+  b = _mm_add_epi32(b, ky);
+  a = _mm_add_epi32(a, kx);
+  hash_bit_final_sse(a, b, c);
+
+  return c;
+}
+
+BLI_INLINE __m128i hash_sse(const __m128i kx,
+                            const __m128i ky,
+                            const __m128i kz,
+                            const __m128i kw)
+{
+  __m128i a, b, c;
+  a = b = c = _mm_set1_epi32(int(0xdeadbeef + (4 << 2) + 13));
+
+  a = _mm_add_epi32(a, kx);
+  b = _mm_add_epi32(b, ky);
+  c = _mm_add_epi32(c, kz);
+  hash_bit_mix_sse(a, b, c);
+
+  a = _mm_add_epi32(a, kw);
+  hash_bit_final_sse(a, b, c);
+
+  return c;
+}
+
+/** Select \a a where \a mask is set and \a b elsewhere. */
+BLI_INLINE __m128 select_sse(const __m128i mask, const __m128 a, const __m128 b)
+{
+  const __m128 mask_f = _mm_castsi128_ps(mask);
+  return _mm_or_ps(_mm_and_ps(mask_f, a), _mm_andnot_ps(mask_f, b));
+}
+
+/** Negate \a value where bit \a Bit of \a h is set. */
+template<int Bit> BLI_INLINE __m128 negate_if_bit_sse(const __m128 value, const __m128i h)
+{
+  const __m128i sign = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(1 << Bit)), 31 - Bit);
+  return _mm_xor_ps(value, _mm_castsi128_ps(sign));
+}
+
+BLI_INLINE __m128 noise_grad_sse(const __m128i hash, const __m128 x, const __m128 y)
+{
+  const __m128i h = _mm_and_si128(hash, _mm_set1_epi32(7));
+  const __m128i h_lt_4 = _mm_cmplt_epi32(h, _mm_set1_epi32(4));
+  const __m128 u = select_sse(h_lt_4, x, y);
+  const __m128 v = _mm_mul_ps(_mm_set1_ps(2.0f), select_sse(h_lt_4, y, x));
+  return _mm_add_ps(negate_if_bit_sse<0>(u, h), negate_if_bit_sse<1>(v, h));
+}
+
+BLI_INLINE __m128 noise_grad_sse(const __m128i hash,
+                                 const __m128 x,
+                                 const __m128 y,
+                                 const __m128 z)
+{
+  const __m128i h = _mm_and_si128(hash, _mm_set1_epi32(15));
+  const __m128 u = select_sse(_mm_cmplt_epi32(h, _mm_set1_epi32(8)), x, y);
+  const __m128i h_12_14 = _mm_or_si128(_mm_cmpeq_epi32(h, _mm_set1_epi32(12)),
+                                       _mm_cmpeq_epi32(h, _mm_set1_epi32(14)));
+  const __m128 vt = select_sse(h_12_14, x, z);
+  const __m128 v = select_sse(_mm_cmplt_epi32(h, _mm_set1_epi32(4)), y, vt);
+  return _mm_add_ps(negate_if_bit_sse<0>(u, h), negate_if_bit_sse<1>(v, h));
+}
+
+BLI_INLINE __m128 noise_grad_sse(
+    const __m128i hash, const __m128 x, const __m128 y, const __m128 z, const __m128 w)
+{
+  const __m128i h = _mm_and_si128(hash, _mm_set1_epi32(31));
+  const __m128 u = select_sse(_mm_cmplt_epi32(h, _mm_set1_epi32(24)), x, y);
+  const __m128 v = select_sse(_mm_cmplt_epi32(h, _mm_set1_epi32(16)), y, z);
+  const __m128 s = select_sse(_mm_cmplt_epi32(h, _mm_set1_epi32(8)), z, w);
+  return _mm_add_ps(_mm_add_ps(negate_if_bit_sse<0>(u, h), negate_if_bit_sse<1>(v, h)),
+                    negate_if_bit_sse<2>(s, h));
+}
+
+BLI_INLINE __m128 floor_fraction_sse(const __m128 x, __m128i &i)
+{
+  /* SSE2 has no floor, truncate and correct negative numbers instead. */
+  const __m128 x_trunc = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+  const __m128 x_floor = _mm_sub_ps(
+      x_trunc, _mm_and_ps(_mm_cmpgt_ps(x_trunc, x), _mm_set1_ps(1.0f)));
+  i = _mm_cvttps_epi32(x_floor);
+  /* Adding zero turns the fraction of -0.0 into 0.0 like in #floor_fraction. */
+  return _mm_add_ps(_mm_sub_ps(x, x_floor), _mm_setzero_ps());
+}
+
+/** Apply a function to the four values as doubles and convert the result back to float. */
+template<typename Fn> BLI_INLINE __m128 map_as_double_sse(const __m128 x, const Fn &fn)
+{
+  const __m128d low = fn(_mm_cvtps_pd(x));
+  const __m128d high = fn(_mm_cvtps_pd(_mm_movehl_ps(x, x)));
+  return _mm_movelh_ps(_mm_cvtpd_ps(low), _mm_cvtpd_ps(high));
+}
+
+BLI_INLINE __m128 fade_sse(const __m128 t)
+{
+  /* The polynomial is evaluated in double precision like in #fade. */
+  const __m128 t3 = _mm_mul_ps(_mm_mul_ps(t, t), t);
+  const __m128d t3_low = _mm_cvtps_pd(t3);
+  const __m128d t3_high = _mm_cvtps_pd(_mm_movehl_ps(t3, t3));
+  const auto polynomial = [](const __m128d t) {
+    const __m128d t6_15 = _mm_sub_pd(_mm_mul_pd(t, _mm_set1_pd(6.0)), _mm_set1_pd(15.0));
+    return _mm_add_pd(_mm_mul_pd(t, t6_15), _mm_set1_pd(10.0));
+  };
+  const __m128d low = _mm_mul_pd(t3_low, polynomial(_mm_cvtps_pd(t)));
+  const __m128d high = _mm_mul_pd(t3_high, polynomial(_mm_cvtps_pd(_mm_movehl_ps(t, t))));
+  return _mm_movelh_ps(_mm_cvtpd_ps(low), _mm_cvtpd_ps(high));
+}
+
+BLI_INLINE __m128 one_minus_sse(const __m128 x)
+{
+  return map_as_double_sse(x, [](const __m128d x) { return _mm_sub_pd(_mm_set1_pd(1.0), x); });
+}
+
+BLI_INLINE __m128 mix_sse(const __m128 v0, const __m128 v1, const __m128 x)
+{
+  return _mm_add_ps(_mm_mul_ps(_mm_sub_ps(_mm_set1_ps(1.0f), x), v0), _mm_mul_ps(x, v1));
+}
+
+BLI_INLINE __m128 mix_sse(const __m128 v0,
+                          const __m128 v1,
+                          const __m128 v2,
+                          const __m128 v3,
+                          const __m128 x,
+                          const __m128 y)
+{
+  const __m128 x1 = one_minus_sse(x);
+  const __m128 a = _mm_add_ps(_mm_mul_ps(v0, x1), _mm_mul_ps(v1, x));
+  const __m128 b = _mm_mul_ps(y, _mm_add_ps(_mm_mul_ps(v2, x1), _mm_mul_ps(v3, x)));
+  /* The final interpolation is done in double precision, like in #mix. */
+  const auto mix_y = [](const __m128d a, const __m128d b, const __m128d y) {
+    return _mm_add_pd(_mm_mul_pd(_mm_sub_pd(_mm_set1_pd(1.0), y), a), b);
+  };
+  const __m128d low = mix_y(_mm_cvtps_pd(a), _mm_cvtps_pd(b), _mm_cvtps_pd(y));
+  const __m128d high = mix_y(_mm_cvtps_pd(_mm_movehl_ps(a, a)),
+                             _mm_cvtps_pd(_mm_movehl_ps(b, b)),
+                             _mm_cvtps_pd(_mm_movehl_ps(y, y)));
+  return _mm_movelh_ps(_mm_cvtpd_ps(low), _mm_cvtpd_ps(high));
+}
+
+BLI_INLINE __m128 mix_sse(const __m128 v0,
+                          const __m128 v1,
+                          const __m128 v2,
+                          const __m128 v3,
+                          const __m128 v4,
+                          const __m128 v5,
+                          const __m128 v6,
+                          const __m128 v7,
+                          const __m128 x,
+                          const __m128 y,
+                          const __m128 z)
+{
+  const __m128 x1 = one_minus_sse(x);
+  const __m128 y1 = one_minus_sse(y);
+  const __m128 z1 = one_minus_sse(z);
+  const auto mix_x = [&](const __m128 a, const __m128 b) {
+    return _mm_add_ps(_mm_mul_ps(a, x1), _mm_mul_ps(b, x));
+  };
+  const auto mix_xy = [&](const __m128 a, const __m128 b, const __m128 c, const __m128 d) {
+    return _mm_add_ps(_mm_mul_ps(y1, mix_x(a, b)), _mm_mul_ps(y, mix_x(c, d)));
+  };
+  return _mm_add_ps(_mm_mul_ps(z1, mix_xy(v0, v1, v2, v3)),
+                    _mm_mul_ps(z, mix_xy(v4, v5, v6, v7)));
+}
+
+BLI_INLINE __m128 perlin_noise_sse(const __m128 position_x, const __m128 position_y)
+{
+  __m128i X, Y;
+
+  const __m128 fx = floor_fraction_sse(position_x, X);
+  const __m128 fy = floor_fraction_sse(position_y, Y);
+  const __m128i X1 = _mm_add_epi32(X, _mm_set1_epi32(1));
+  const __m128i Y1 = _mm_add_epi32(Y, _mm_set1_epi32(1));
+  const __m128 fx1 = _mm_sub_ps(fx, _mm_set1_ps(1.0f));
+  const __m128 fy1 = _mm_sub_ps(fy, _mm_set1_ps(1.0f));
+
+  const __m128 u = fade_sse(fx);
+  const __m128 v = fade_sse(fy);
+
+  return mix_sse(noise_grad_sse(hash_sse(X, Y), fx, fy),
+                 noise_grad_sse(hash_sse(X1, Y), fx1, fy),
+                 noise_grad_sse(hash_sse(X, Y1), fx, fy1),
+                 noise_grad_sse(hash_sse(X1, Y1), fx1, fy1),
+                 u,
+                 v);
+}
+
+BLI_INLINE __m128 perlin_noise_sse(const __m128 position_x,
+                                   const __m128 position_y,
+                                   const __m128 position_z)
+{
+  __m128i X, Y, Z;
+
+  const __m128 fx = floor_fraction_sse(position_x, X);
+  const __m128 fy = floor_fraction_sse(position_y, Y);
+  const __m128 fz = floor_fraction_sse(position_z, Z);
+  const __m128i X1 = _mm_add_epi32(X, _mm_set1_epi32(1));
+  const __m128i Y1 = _mm_add_epi32(Y, _mm_set1_epi32(1));
+  const __m128i Z1 = _mm_add_epi32(Z, _mm_set1_epi32(1));
+  const __m128 fx1 = _mm_sub_ps(fx, _mm_set1_ps(1.0f));
+  const __m128 fy1 = _mm_sub_ps(fy, _mm_set1_ps(1.0f));
+  const __m128 fz1 = _mm_sub_ps(fz, _mm_set1_ps(1.0f));
+
+  const __m128 u = fade_sse(fx);
+  const __m128 v = fade_sse(fy);
+  const __m128 w = fade_sse(fz);
+
+  return mix_sse(noise_grad_sse(hash_sse(X, Y, Z), fx, fy, fz),
+                 noise_grad_sse(hash_sse(X1, Y, Z), fx1, fy, fz),
+                 noise_grad_sse(hash_sse(X, Y1, Z), fx, fy1, fz),
+                 noise_grad_sse(hash_sse(X1, Y1, Z), fx1, fy1, fz),
+                 noise_grad_sse(hash_sse(X, Y, Z1), fx, fy, fz1),
+                 noise_grad_sse(hash_sse(X1, Y, Z1), fx1, fy, fz1),
+                 noise_grad_sse(hash_sse(X, Y1, Z1), fx, fy1, fz1),
+                 noise_grad_sse(hash_sse(X1, Y1, Z1), fx1, fy1, fz1),
+                 u,
+                 v,
+                 w);
+}
+
+BLI_INLINE __m128 perlin_noise_sse(const __m128 position_x,
+                                   const __m128 position_y,
+                                   const __m128 position_z,
+                                   const __m128 position_w)
+{
+  __m128i X, Y, Z, W;
+
+  const __m128 fx = floor_fraction_sse(position_x, X);
+  const __m128 fy = floor_fraction_sse(position_y, Y);
+  const __m128 fz = floor_fraction_sse(position_z, Z);
+  const __m128 fw = floor_fraction_sse(position_w, W);
+  const __m128i X1 = _mm_add_epi32(X, _mm_set1_epi32(1));
+  const __m128i Y1 = _mm_add_epi32(Y, _mm_set1_epi32(1));
+  const __m128i Z1 = _mm_add_epi32(Z, _mm_set1_epi32(1));
+  const __m128i W1 = _mm_add_epi32(W, _mm_set1_epi32(1));
+  const __m128 fx1 = _mm_sub_ps(fx, _mm_set1_ps(1.0f));
+  const __m128 fy1 = _mm_sub_ps(fy, _mm_set1_ps(1.0f));
+  const __m128 fz1 = _mm_sub_ps(fz, _mm_set1_ps(1.0f));
+  const __m128 fw1 = _mm_sub_ps(fw, _mm_set1_ps(1.0f));
+
+  const __m128 u = fade_sse(fx);
+  const __m128 v = fade_sse(fy);
+  const __m128 t = fade_sse(fz);
+  const __m128 s = fade_sse(fw);
+
+  return mix_sse(mix_sse(noise_grad_sse(hash_sse(X, Y, Z, W), fx, fy, fz, fw),
+                         noise_grad_sse(hash_sse(X1, Y, Z, W), fx1, fy, fz, fw),
+                         noise_grad_sse(hash_sse(X, Y1, Z, W), fx, fy1, fz, fw),
+                         noise_grad_sse(hash_sse(X1, Y1, Z, W), fx1, fy1, fz, fw),
+                         noise_grad_sse(hash_sse(X, Y, Z1, W), fx, fy, fz1, fw),
+                         noise_grad_sse(hash_sse(X1, Y, Z1, W), fx1, fy, fz1, fw),
+                         noise_grad_sse(hash_sse(X, Y1, Z1, W), fx, fy1, fz1, fw),
+                         noise_grad_sse(hash_sse(X1, Y1, Z1, W), fx1, fy1, fz1, fw),
+                         u,
+                         v,
+                         t),
+                 mix_sse(noise_grad_sse(hash_sse(X, Y, Z, W1), fx, fy, fz, fw1),
+                         noise_grad_sse(hash_sse(X1, Y, Z, W1), fx1, fy, fz, fw1),
+                         noise_grad_sse(hash_sse(X, Y1, Z, W1), fx, fy1, fz, fw1),
+                         noise_grad_sse(hash_sse(X1, Y1, Z, W1), fx1, fy1, fz, fw1),
+                         noise_grad_sse(hash_sse(X, Y, Z1, W1), fx, fy, fz1, fw1),
+                         noise_grad_sse(hash_sse(X1, Y, Z1, W1), fx1, fy, fz1, fw1),
+                         noise_grad_sse(hash_sse(X, Y1, Z1, W1), fx, fy1, fz1, fw1),
+                         noise_grad_sse(hash_sse(X1, Y1, Z1, W1), fx1, fy1, fz1, fw1),
+                         u,
+                         v,
+                         t),
+                 s);
+}
+
+/** Same as the repetition and precision correction of the position in #perlin_signed. */
+BLI_INLINE __m128 perlin_wrap_position_sse(__m128 x)
+{
+  const __m128 abs_x = _mm_andnot_ps(_mm_set1_ps(-0.0f), x);
+  const __m128 precision_correction = _mm_and_ps(
+      _mm_cmpge_ps(abs_x, _mm_set1_ps(1000000.0f)), _mm_set1_ps(0.5f));
+  /* The modulo doesn't change smaller values, which is by far the most common case. */
+  if (_mm_movemask_ps(_mm_cmpge_ps(abs_x, _mm_set1_ps(100000.0f))) != 0) {
+    float values[4];
+    _mm_storeu_ps(values, x);
+    for (float &value : values) {
+      value = math::mod(value, 100000.0f);
+    }
+    x = _mm_loadu_ps(values);
+  }
+  return _mm_add_ps(x, precision_correction);
+}
+
+#endif
+
+void perlin_signed(const Span<float> positions, MutableSpan<float> r_values)
+{
+  BLI_assert(positions.size() == r_values.size());
+  /* One dimensional noise is cheap enough already. */
+  for (const int64_t i : positions.index_range()) {
+    r_values[i] = perlin_signed(positions[i]);
+  }
+}
+
+#if BLI_HAVE_SSE2
+/**
+ * Call \a fn for every four positions, the last positions are padded by repeating the last
+ * one, so that small batches like the three distortion positions are vectorized too.
+ */
+template<typename T, typename Fn>
+static void perlin_signed_batch(const Span<T> positions, MutableSpan<float> r_values, const Fn &fn)
+{
+  BLI_assert(positions.size() == r_values.size());
+  const int64_t size = positions.size();
+  int64_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    _mm_storeu_ps(&r_values[i], fn(&positions[i]));
+  }
+  if (i < size) {
+    const T padded_positions[4] = {positions[i],
+                                   positions[std::min(i + 1, size - 1)],
+                                   positions[std::min(i + 2, size - 1)],
+                                   positions[std::min(i + 3, size - 1)]};
+    float values[4];
+    _mm_storeu_ps(values, fn(padded_positions));
+    for (; i < size; i++) {
+      r_values[i] = values[i % 4];
+    }
+  }
+}
+#else
+template<typename T>
+static void perlin_signed_batch(const Span<T> positions, MutableSpan<float> r_values)
+{
+  BLI_assert(positions.size() == r_values.size());
+  for (const int64_t i : positions.index_range()) {
+    r_values[i] = perlin_signed(positions[i]);
+  }
+}
+#endif
+
+void perlin_signed(const Span<float2> positions, MutableSpan<float> r_values)
+{
+#if BLI_HAVE_SSE2
+  perlin_signed_batch(positions, r_values, [](const float2 *p) {
+    const __m128 x = perlin_wrap_position_sse(_mm_setr_ps(p[0].x, p[1].x, p[2].x, p[3].x));
+    const __m128 y = perlin_wrap_position_sse(_mm_setr_ps(p[0].y, p[1].y, p[2].y, p[3].y));
+    return _mm_mul_ps(perlin_noise_sse(x, y), _mm_set1_ps(0.6616f));
+  });
+#else
+  perlin_signed_batch(positions, r_values);
+#endif
+}
+
+void perlin_signed(const Span<float3> positions, MutableSpan<float> r_values)
+{
+#if BLI_HAVE_SSE2
+  perlin_signed_batch(positions, r_values, [](const float3 *p) {
+    const __m128 x = perlin_wrap_position_sse(_mm_setr_ps(p[0].x, p[1].x, p[2].x, p[3].x));
+    const __m128 y = perlin_wrap_position_sse(_mm_setr_ps(p[0].y, p[1].y, p[2].y, p[3].y));
+    const __m128 z = perlin_wrap_position_sse(_mm_setr_ps(p[0].z, p[1].z, p[2].z, p[3].z));
+    return _mm_mul_ps(perlin_noise_sse(x, y, z), _mm_set1_ps(0.9820f));
+  });
+#else
+  perlin_signed_batch(positions, r_values);
+#endif
+}
+
+void perlin_signed(const Span<float4> positions, MutableSpan<float> r_values)
+{
+#if BLI_HAVE_SSE2
+  perlin_signed_batch(positions, r_values, [](const float4 *p) {
+    const __m128 x = perlin_wrap_position_sse(_mm_setr_ps(p[0].x, p[1].x, p[2].x, p[3].x));
+    const __m128 y = perlin_wrap_position_sse(_mm_setr_ps(p[0].y, p[1].y, p[2].y, p[3].y));
+    const __m128 z = perlin_wrap_position_sse(_mm_setr_ps(p[0].z, p[1].z, p[2].z, p[3].z));
+    const __m128 w = perlin_wrap_position_sse(_mm_setr_ps(p[0].w, p[1].w, p[2].w, p[3].w));
+    return _mm_mul_ps(perlin_noise_sse(x, y, z, w), _mm_set1_ps(0.8344f));
+  });
+#else
+  perlin_signed_batch(positions, r_values);
+#endif
+}
+
 /* Fractal perlin noise. */
 
+/* The positions of the octaves don't depend on the noise values, so they are computed first and
+ * the noise is evaluated for all of them at once. This gives the same result as evaluating the
+ * octaves one by one. */
+
+/* Enough for the maximum detail of the noise texture nodes. */
+constexpr int64_t octaves_inline_buffer = 17;
+
 /* fBM = Fractal Brownian Motion */
 template<typename T>
 float perlin_fbm(
     T p, const float detail, const float roughness, const float lacunarity, const bool normalize)
 {
+  const float rmd = detail - std::floor(detail);
+  Vector<T, octaves_inline_buffer> positions;
   float fscale = 1.0f;
+  for (int i = 0; i <= int(detail); i++) {
+    positions.append(fscale * p);
+    fscale *= lacunarity;
+  }
+  if (rmd != 0.0f) {
+    positions.append(fscale * p);
+  }
+  Array<float, octaves_inline_buffer> noise(positions.size());
+  perlin_signed(positions.as_span(), noise);
+
   float amp = 1.0f;
   float maxamp = 0.0f;
   float sum = 0.0f;
 
   for (int i = 0; i <= int(detail); i++) {
-    float t = perlin_signed(fscale * p);
+    float t = noise[i];
     sum += t * amp;
     maxamp += amp;
     amp *= roughness;
-    fscale *= lacunarity;
   }
-  float rmd = detail - std::floor(detail);
   if (rmd != 0.0f) {
-    float t = perlin_signed(fscale * p);
+    float t = noise.last();
     float sum2 = sum + t * amp;
     return normalize ? mix(0.5f * sum / maxamp + 0.5f, 0.5f * sum2 / (maxamp + amp) + 0.5f, rmd) :
                        mix(sum, sum2, rmd);
@@ -598,18 +1066,28 @@ template float perlin_fbm<float3>(float3 p,
 template<typename T>
 float perlin_multi_fractal(T p, const float detail, const float roughness, const float lacunarity)
 {
+  const float rmd = detail - floorf(detail);
+  Vector<T, octaves_inline_buffer> positions;
+  for (int i = 0; i <= int(detail); i++) {
+    positions.append(p);
+    p *= lacunarity;
+  }
+  if (rmd != 0.0f) {
+    positions.append(p);
+  }
+  Array<float, octaves_inline_buffer> noise(positions.size());
+  perlin_signed(positions.as_span(), noise);
+
   float value = 1.0f;
   float pwr = 1.0f;
 
   for (int i = 0; i <= int(detail); i++) {
-    value *= (pwr * perlin_signed(p) + 1.0f);
+    value *= (pwr * noise[i] + 1.0f);
     pwr *= roughness;
-    p *= lacunarity;
   }
 
-  const float rmd = detail - floorf(detail);
   if (rmd != 0.0f) {
-    value *= (rmd * pwr * perlin_signed(p) + 1.0f); /* correct? */
+    value *= (rmd * pwr * noise.last() + 1.0f); /* correct? */
   }
 
   return value;
@@ -619,22 +1097,33 @@ template<typename T>
 float perlin_hetero_terrain(
     T p, const float detail, const float roughness, const float lacunarity, const float offset)
 {
+  const float rmd = detail - floorf(detail);
+  Vector<T, octaves_inline_buffer> positions;
+  positions.append(p);
+  p *= lacunarity;
+  for (int i = 1; i <= int(detail); i++) {
+    positions.append(p);
+    p *= lacunarity;
+  }
+  if (rmd != 0.0f) {
+    positions.append(p);
+  }
+  Array<float, octaves_inline_buffer> noise(positions.size());
+  perlin_signed(positions.as_span(), noise);
+
   float pwr = roughness;
 
   /* First unscaled octave of function; later octaves are scaled. */
-  float value = offset + perlin_signed(p);
-  p *= lacunarity;
+  float value = offset + noise[0];
 
   for (int i = 1; i <= int(detail); i++) {
-    float increment = (perlin_signed(p) + offset) * pwr * value;
+    float increment = (noise[i] + offset) * pwr * value;
     value += increment;
     pwr *= roughness;
-    p *= lacunarity;
   }
 
-  const float rmd = detail - floorf(detail);
   if (rmd != 0.0f) {
-    float increment = (perlin_signed(p) + offset) * pwr * value;
+    float increment = (noise.last() + offset) * pwr * value;
     value += rmd * increment;
   }
 
@@ -649,6 +1138,28 @@ float perlin_hybrid_multi_fractal(T p,
                                   const float offset,
                                   const float gain)
 {
+  const float rmd = detail - floorf(detail);
+  Vector<T, octaves_inline_buffer> positions;
+  for (int i = 0; i <= int(detail); i++) {
+    positions.append(p);
+    p *= lacunarity;
+  }
+  if (rmd != 0.0f) {
+    positions.append(p);
+  }
+  /* The loop below often stops early, so only evaluate four octaves at a time. */
+  Array<float, octaves_inline_buffer> noise(positions.size());
+  int64_t noise_evaluated_num = 0;
+  const auto octave_noise = [&](const int64_t octave) {
+    if (octave >= noise_evaluated_num) {
+      const IndexRange batch = IndexRange::from_begin_end(octave,
+                                                          std::min(octave + 4, noise.size()));
+      perlin_signed(positions.as_span().slice(batch), noise.as_mutable_span().slice(batch));
+      noise_evaluated_num = batch.one_after_last();
+    }
+    return noise[octave];
+  };
+
   float pwr = 1.0f;
   float value = 0.0f;
   float weight = 1.0f;
@@ -658,19 +1169,17 @@ float perlin_hybrid_multi_fractal(T p,
       weight = 1.0f;
     }
 
-    float signal = (perlin_signed(p) + offset) * pwr;
+    float signal = (octave_noise(i) + offset) * pwr;
     pwr *= roughness;
     value += weight * signal;
     weight *= gain * signal;
-    p *= lacunarity;
   }
 
-  const float rmd = detail - floorf(detail);
   if ((rmd != 0.0f) && (weight > 0.001f)) {
     if (weight > 1.0f) {
       weight = 1.0f;
     }
-    float signal = (perlin_signed(p) + offset) * pwr;
+    float signal = (octave_noise(noise.size() - 1) + offset) * pwr;
     value += rmd * weight * signal;
   }
 
@@ -685,17 +1194,25 @@ float perlin_ridged_multi_fractal(T p,
                                   const float offset,
                                   const float gain)
 {
+  Vector<T, octaves_inline_buffer> positions;
+  positions.append(p);
+  for (int i = 1; i <= int(detail); i++) {
+    p *= lacunarity;
+    positions.append(p);
+  }
+  Array<float, octaves_inline_buffer> noise(positions.size());
+  perlin_signed(positions.as_span(), noise);
+
   float pwr = roughness;
 
-  float signal = offset - std::abs(perlin_signed(p));
+  float signal = offset - std::abs(noise[0]);
   signal *= signal;
   float value = signal;
   float weight = 1.0f;
 
   for (int i = 1; i <= int(detail); i++) {
-    p *= lacunarity;
     weight = std::clamp(signal * gain, 0.0f, 1.0f);
-    signal = offset - std::abs(perlin_signed(p));
+    signal = offset - std::abs(noise[i]);
     signal *= signal;
     signal *= weight;
     value += signal * pwr;
@@ -787,23 +1304,33 @@ BLI_INLINE float perlin_distortion(float position, float strength)
 
 BLI_INLINE float2 perlin_distortion(float2 position, float strength)
 {
-  return float2(perlin_signed(position + random_float2_offset(0.0f)) * strength,
-                perlin_signed(position + random_float2_offset(1.0f)) * strength);
+  const float2 positions[2] = {position + random_float2_offset(0.0f),
+                               position + random_float2_offset(1.0f)};
+  float noise[2];
+  perlin_signed(Span<float2>(positions, 2), MutableSpan<float>(noise, 2));
+  return float2(noise[0] * strength, noise[1] * strength);
 }
 
 BLI_INLINE float3 perlin_distortion(float3 position, float strength)
 {
-  return float3(perlin_signed(position + random_float3_offset(0.0f)) * strength,
-                perlin_signed(position + random_float3_offset(1.0f)) * strength,
-                perlin_signed(position + random_float3_offset(2.0f)) * strength);
+  const float3 positions[3] = {position + random_float3_offset(0.0f),
+                               position + random_float3_offset(1.0f),
+                               position + random_float3_offset(2.0f)};
+  float noise[3];
+  perlin_signed(Span<float3>(positions, 3), MutableSpan<float>(noise, 3));
+  return float3(noise[0] * strength, noise[1] * strength, noise[2] * strength);
 }
 
 BLI_INLINE float4 perlin_distortion(float4 position, float strength)
 {
-  return float4(perlin_signed(position + random_float4_offset(0.0f)) * strength,
-                perlin_signed(position + random_float4_offset(1.0f)) * strength,
-                perlin_signed(position + random_float4_offset(2.0f)) * strength,
-                perlin_signed(position + random_float4_offset(3.0f)) * strength);
+  const float4 positions[4] = {position + random_float4_offset(0.0f),
+                               position + random_float4_offset(1.0f),
+                               position + random_float4_offset(2.0f),
+                               position + random_float4_offset(3.0f)};
+  float noise[4];
+  perlin_signed(Span<float4>(positions, 4), MutableSpan<float>(noise, 4));
+  return float4(
+      noise[0] * strength, noise[1] * strength, noise[2] * strength, noise[3] * strength);
 }
 
 /* Distorted fractal perlin noise. */
@@ -172,6 +172,34 @@ int BLI_cpu_support_sse42(void)
   return 0;
 }
 
+int BLI_cpu_support_f16c(void)
+{
+#if defined(__x86_64__) || defined(_M_X64)
+  int result[4];
+  __cpuid(result, 0);
+  if (result[0] < 1) {
+    return 0;
+  }
+  __cpuid(result, 0x00000001);
+  /* F16C instructions are VEX encoded, so they also need AVX and the OS saving the YMM state. */
+  const int osxsave_avx_f16c = (1 << 27) | (1 << 28) | (1 << 29);
+  if ((result[2] & osxsave_avx_f16c) != osxsave_avx_f16c) {
+    return 0;
+  }
+#  if defined(_MSC_VER)
+  const unsigned long long xcr0 = _xgetbv(0);
+#  else
+  unsigned int xcr0_low, xcr0_high;
+  __asm__("xgetbv" : "=a"(xcr0_low), "=d"(xcr0_high) : "c"(0));
+  const unsigned long long xcr0 = ((unsigned long long)xcr0_high << 32) | xcr0_low;
+#  endif
+  /* SSE and AVX state. */
+  return (xcr0 & 0x6) == 0x6;
+#else
+  return 0;
+#endif
+}
+
 void BLI_hostname_get(char *buffer, size_t bufsize)
 {
 #ifndef WIN32
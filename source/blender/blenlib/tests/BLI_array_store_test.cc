@@ -700,6 +700,11 @@ TEST(array_store, TestData_Stride32_Chunk64_Mutate8)
 {
   random_data_mutate_helper(0, 256, 200, 32, 64, 7117, 8);
 }
+/* Large enough for the hashes to be computed in multiple blocks. */
+TEST(array_store, TestData_Stride4_Chunk64_Mutate4_Large)
+{
+  random_data_mutate_helper(20000, 40000, 20, 4, 64, 4334, 4);
+}
 
 /* -------------------------------------------------------------------- */
 /* Randomized Chunks Test */
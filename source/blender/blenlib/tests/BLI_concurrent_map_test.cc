@@ -0,0 +1,97 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_concurrent_map.hh"
+#include "BLI_task.hh"
+#include "BLI_vector.hh"
+
+#include "BLI_strict_flags.h" /* Keep last. */
+
+namespace blender::tests {
+
+TEST(concurrent_map, DefaultConstructor)
+{
+  ConcurrentMap<int, float> map;
+  EXPECT_EQ(map.size(), 0);
+  EXPECT_TRUE(map.is_empty());
+}
+
+TEST(concurrent_map, AddLookup)
+{
+  ConcurrentMap<int, int> map;
+  EXPECT_TRUE(map.add(1, 10));
+  EXPECT_FALSE(map.add(1, 20));
+  EXPECT_TRUE(map.add(2, 30));
+  EXPECT_EQ(map.size(), 2);
+  EXPECT_EQ(map.lookup_try(1), 10);
+  EXPECT_EQ(map.lookup_try(2), 30);
+  EXPECT_FALSE(map.lookup_try(3).has_value());
+  EXPECT_EQ(map.lookup_default(3, -1), -1);
+  EXPECT_TRUE(map.contains(2));
+  EXPECT_FALSE(map.contains(3));
+}
+
+TEST(concurrent_map, AddOverwriteRemove)
+{
+  ConcurrentMap<int, int> map;
+  EXPECT_TRUE(map.add_overwrite(1, 10));
+  EXPECT_FALSE(map.add_overwrite(1, 20));
+  EXPECT_EQ(map.lookup_default(1, 0), 20);
+  EXPECT_TRUE(map.remove(1));
+  EXPECT_FALSE(map.remove(1));
+  EXPECT_TRUE(map.is_empty());
+}
+
+TEST(concurrent_map, AddMultiple)
+{
+  ConcurrentMap<int, int> map(2);
+  map.add_multiple({1, 2, 3}, {10, 20, 30});
+  map.add_multiple({3, 4, 5}, {0, 40, 50});
+  EXPECT_EQ(map.size(), 5);
+  EXPECT_EQ(map.lookup_default(3, 0), 30);
+  EXPECT_EQ(map.lookup_default(5, 0), 50);
+}
+
+TEST(concurrent_map, ParallelAddOrModify)
+{
+  ConcurrentMap<int, int> map;
+  threading::parallel_for(IndexRange(100000), 1024, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      map.add_or_modify(
+          int(i % 1000), [](int *value) { *value = 1; }, [](int *value) { (*value)++; });
+    }
+  });
+  EXPECT_EQ(map.size(), 1000);
+  int64_t total = 0;
+  for (const int64_t shard : map.shard_range()) {
+    for (const int value : map.shard(shard).values()) {
+      EXPECT_EQ(value, 100);
+      total += value;
+    }
+  }
+  EXPECT_EQ(total, 100000);
+}
+
+TEST(concurrent_map, ParallelAddMultiple)
+{
+  Vector<int> keys;
+  Vector<int> values;
+  for (int i = 0; i < 50000; i++) {
+    keys.append(i);
+    values.append(i * 2);
+  }
+  ConcurrentMap<int, int> map;
+  map.reserve(keys.size());
+  threading::parallel_for(keys.index_range(), 4096, [&](const IndexRange range) {
+    map.add_multiple(keys.as_span().slice(range), values.as_span().slice(range));
+  });
+  EXPECT_EQ(map.size(), 50000);
+  for (int i = 0; i < 50000; i++) {
+    EXPECT_EQ(map.lookup_default(i, -1), i * 2);
+  }
+}
+
+}  // namespace blender::tests
@@ -0,0 +1,125 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_concurrent_set.hh"
+#include "BLI_string_ref.hh"
+#include "BLI_task.hh"
+#include "BLI_vector.hh"
+
+#include "BLI_strict_flags.h" /* Keep last. */
+
+namespace blender::tests {
+
+TEST(concurrent_set, DefaultConstructor)
+{
+  ConcurrentSet<int> set;
+  EXPECT_EQ(set.size(), 0);
+  EXPECT_TRUE(set.is_empty());
+  EXPECT_EQ(set.shard_range().size(), 64);
+}
+
+TEST(concurrent_set, ShardsNumRoundedUp)
+{
+  ConcurrentSet<int> set(5);
+  EXPECT_EQ(set.shard_range().size(), 8);
+  ConcurrentSet<int> single_shard_set(1);
+  EXPECT_EQ(single_shard_set.shard_range().size(), 1);
+  single_shard_set.add(3);
+  EXPECT_TRUE(single_shard_set.contains(3));
+}
+
+TEST(concurrent_set, AddContainsRemove)
+{
+  ConcurrentSet<int> set;
+  EXPECT_TRUE(set.add(5));
+  EXPECT_FALSE(set.add(5));
+  EXPECT_TRUE(set.add(6));
+  EXPECT_TRUE(set.contains(5));
+  EXPECT_TRUE(set.contains(6));
+  EXPECT_FALSE(set.contains(7));
+  EXPECT_EQ(set.size(), 2);
+  EXPECT_TRUE(set.remove(5));
+  EXPECT_FALSE(set.remove(5));
+  EXPECT_FALSE(set.contains(5));
+  EXPECT_EQ(set.size(), 1);
+  set.clear();
+  EXPECT_TRUE(set.is_empty());
+}
+
+TEST(concurrent_set, AddAs)
+{
+  ConcurrentSet<std::string> set;
+  EXPECT_TRUE(set.add_as(StringRef("test")));
+  EXPECT_FALSE(set.add("test"));
+  EXPECT_TRUE(set.contains_as(StringRef("test")));
+  EXPECT_FALSE(set.contains_as(StringRef("other")));
+}
+
+TEST(concurrent_set, ShardsAreDisjoint)
+{
+  ConcurrentSet<int> set(16);
+  for (int i = 0; i < 1000; i++) {
+    set.add(i);
+  }
+  int64_t total = 0;
+  for (const int64_t shard : set.shard_range()) {
+    for (const int key : set.shard(shard)) {
+      for (const int64_t other_shard : set.shard_range()) {
+        if (other_shard != shard) {
+          EXPECT_FALSE(set.shard(other_shard).contains(key));
+        }
+      }
+    }
+    /* The keys should be spread over all shards, even though they only differ in low bits. */
+    EXPECT_GT(set.shard(shard).size(), 0);
+    total += set.shard(shard).size();
+  }
+  EXPECT_EQ(total, 1000);
+}
+
+TEST(concurrent_set, AddMultiple)
+{
+  ConcurrentSet<int> set(4);
+  set.add_multiple({1, 2, 3});
+  set.add_multiple({3, 4, 4, 5, 6, 7, 8, 1});
+  EXPECT_EQ(set.size(), 8);
+  for (int i = 1; i <= 8; i++) {
+    EXPECT_TRUE(set.contains(i));
+  }
+}
+
+TEST(concurrent_set, ParallelAdd)
+{
+  ConcurrentSet<int> set;
+  set.reserve(10000);
+  threading::parallel_for(IndexRange(100000), 1024, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      set.add(int(i % 10000));
+    }
+  });
+  EXPECT_EQ(set.size(), 10000);
+  for (int i = 0; i < 10000; i++) {
+    EXPECT_TRUE(set.contains(i));
+  }
+}
+
+TEST(concurrent_set, ParallelAddMultiple)
+{
+  Vector<int> keys;
+  for (int i = 0; i < 100000; i++) {
+    keys.append((i * 7) % 20000);
+  }
+  ConcurrentSet<int> set;
+  threading::parallel_for(keys.index_range(), 4096, [&](const IndexRange range) {
+    set.add_multiple(keys.as_span().slice(range));
+  });
+  EXPECT_EQ(set.size(), 20000);
+  for (int i = 0; i < 20000; i++) {
+    EXPECT_TRUE(set.contains(i));
+  }
+}
+
+}  // namespace blender::tests
@@ -4,14 +4,18 @@
 
 #include "testing/testing.h"
 
-/* TODO: ray intersection, overlap ... etc. */
+/* TODO: overlap ... etc. */
+
+#include <algorithm>
 
 #include "MEM_guardedalloc.h"
 
 #include "BLI_compiler_attrs.h"
 #include "BLI_kdopbvh.h"
+#include "BLI_math_base.h"
 #include "BLI_math_vector.h"
 #include "BLI_rand.h"
+#include "BLI_vector.hh"
 
 /* -------------------------------------------------------------------- */
 /* Helper Functions */
@@ -134,3 +138,334 @@ TEST(kdopbvh, OptimalFindNearest_500)
 {
   find_nearest_points_test(500, 1.0, 1000, 12, true);
 }
+
+/**
+ * Compare ray-casts against the bounds of all boxes, for the different tree types.
+ */
+static void ray_cast_boxes_test(int boxes_len, char tree_type, char axis, int random_seed)
+{
+  const float box_size = 0.05f;
+  RNG *rng = BLI_rng_new(random_seed);
+  BVHTree *tree = BLI_bvhtree_new(boxes_len, 0.0, tree_type, axis);
+  const float epsilon = BLI_bvhtree_get_epsilon(tree);
+
+  void *mem = MEM_mallocN(sizeof(float[2][3]) * boxes_len, __func__);
+  float(*boxes)[2][3] = (float(*)[2][3])mem;
+
+  for (int i = 0; i < boxes_len; i++) {
+    rng_v3_round(boxes[i][0], 3, rng, 1000, 1.0f);
+    copy_v3_v3(boxes[i][1], boxes[i][0]);
+    add_v3_fl(boxes[i][1], box_size);
+    BLI_bvhtree_insert(tree, i, boxes[i][0], 2);
+  }
+  BLI_bvhtree_balance(tree);
+
+  for (int i = 0; i < 100; i++) {
+    float co[3], dir[3];
+    rng_v3_round(co, 3, rng, 1000, 2.0f);
+    rng_v3_round(dir, 3, rng, 1000, 1.0f);
+    if (normalize_v3(dir) == 0.0f) {
+      continue;
+    }
+
+    /* Without a callback the hit distance is the distance to the bounds of the closest box. */
+    BVHTreeRayHit hit;
+    hit.index = -1;
+    hit.dist = BVH_RAYCAST_DIST_MAX;
+    BLI_bvhtree_ray_cast(tree, co, dir, 0.0f, &hit, nullptr, nullptr);
+
+    float expected_dist = BVH_RAYCAST_DIST_MAX;
+    for (int j = 0; j < boxes_len; j++) {
+      float t_near = -FLT_MAX, t_far = FLT_MAX;
+      for (int k = 0; k < 3; k++) {
+        const float min = boxes[j][0][k] - epsilon, max = boxes[j][1][k] + epsilon;
+        if (fabsf(dir[k]) < FLT_EPSILON) {
+          if (co[k] < min || co[k] > max) {
+            t_near = FLT_MAX;
+          }
+          continue;
+        }
+        const float t1 = (min - co[k]) / dir[k], t2 = (max - co[k]) / dir[k];
+        t_near = max_ff(t_near, min_ff(t1, t2));
+        t_far = min_ff(t_far, max_ff(t1, t2));
+      }
+      if (t_near <= t_far && t_far >= 0.0f && t_near < expected_dist) {
+        expected_dist = t_near;
+      }
+    }
+
+    if (expected_dist == BVH_RAYCAST_DIST_MAX) {
+      EXPECT_EQ(hit.index, -1);
+    }
+    else {
+      EXPECT_GE(hit.index, 0);
+      EXPECT_NEAR(hit.dist, expected_dist, 1e-5f);
+    }
+  }
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  MEM_freeN(boxes);
+}
+
+TEST(kdopbvh, RayCast_Binary)
+{
+  ray_cast_boxes_test(500, 2, 6, 12);
+}
+TEST(kdopbvh, RayCast_Quad)
+{
+  ray_cast_boxes_test(500, 4, 6, 123);
+}
+TEST(kdopbvh, RayCast_Oct)
+{
+  ray_cast_boxes_test(500, 8, 8, 1234);
+}
+TEST(kdopbvh, RayCast_KDOP26)
+{
+  ray_cast_boxes_test(500, 4, 26, 12345);
+}
+
+/* -------------------------------------------------------------------- */
+/* Queries with Callbacks
+ *
+ * Use enough spheres for the ray-cast and nearest queries to build a deep wide tree. */
+
+struct SpheresData {
+  int spheres_len;
+  float (*centers)[3];
+  float radius;
+  /** Only hit the spheres with an even index, ignoring the others like hidden faces. */
+  bool even_only;
+  /** Indices passed to the ray-cast all callback. */
+  blender::Vector<int> hits;
+};
+
+static SpheresData *spheres_create(int spheres_len, float radius, int random_seed)
+{
+  SpheresData *spheres = MEM_new<SpheresData>(__func__);
+  spheres->spheres_len = spheres_len;
+  spheres->centers = (float(*)[3])MEM_mallocN(sizeof(float[3]) * spheres_len, __func__);
+  spheres->radius = radius;
+  spheres->even_only = false;
+  RNG *rng = BLI_rng_new(random_seed);
+  for (int i = 0; i < spheres_len; i++) {
+    rng_v3_round(spheres->centers[i], 3, rng, 1000, 1.0f);
+  }
+  BLI_rng_free(rng);
+  return spheres;
+}
+
+static void spheres_free(SpheresData *spheres)
+{
+  MEM_freeN(spheres->centers);
+  MEM_delete(spheres);
+}
+
+static void spheres_tree_insert_or_update(BVHTree *tree, const SpheresData *spheres, bool update)
+{
+  for (int i = 0; i < spheres->spheres_len; i++) {
+    float bounds[2][3];
+    copy_v3_v3(bounds[0], spheres->centers[i]);
+    add_v3_fl(bounds[0], -spheres->radius);
+    copy_v3_v3(bounds[1], spheres->centers[i]);
+    add_v3_fl(bounds[1], spheres->radius);
+    if (update) {
+      BLI_bvhtree_update_node(tree, i, bounds[0], nullptr, 2);
+    }
+    else {
+      BLI_bvhtree_insert(tree, i, bounds[0], 2);
+    }
+  }
+  if (update) {
+    BLI_bvhtree_update_tree(tree);
+  }
+  else {
+    BLI_bvhtree_balance(tree);
+  }
+}
+
+/** Distance along the ray to the sphere, or #BVH_RAYCAST_DIST_MAX when it is missed. */
+static float ray_sphere_dist(const SpheresData *spheres,
+                             int index,
+                             const float co[3],
+                             const float dir[3])
+{
+  float to_center[3];
+  sub_v3_v3v3(to_center, spheres->centers[index], co);
+  const float t = dot_v3v3(to_center, dir);
+  const float dist_sq = len_squared_v3(to_center) - t * t;
+  const float radius_sq = spheres->radius * spheres->radius;
+  if (t < 0.0f || dist_sq > radius_sq) {
+    return BVH_RAYCAST_DIST_MAX;
+  }
+  return t - sqrtf(radius_sq - dist_sq);
+}
+
+static bool sphere_is_hidden(const SpheresData *spheres, int index)
+{
+  return spheres->even_only && index % 2 != 0;
+}
+
+static void ray_cast_spheres_callback(void *userdata,
+                                      int index,
+                                      const BVHTreeRay *ray,
+                                      BVHTreeRayHit *hit)
+{
+  const SpheresData *spheres = static_cast<const SpheresData *>(userdata);
+  if (sphere_is_hidden(spheres, index)) {
+    return;
+  }
+  const float dist = ray_sphere_dist(spheres, index, ray->origin, ray->direction);
+  if (dist < hit->dist) {
+    hit->index = index;
+    hit->dist = dist;
+  }
+}
+
+static void ray_cast_all_spheres_callback(void *userdata,
+                                          int index,
+                                          const BVHTreeRay *ray,
+                                          BVHTreeRayHit *hit)
+{
+  SpheresData *spheres = static_cast<SpheresData *>(userdata);
+  if (ray_sphere_dist(spheres, index, ray->origin, ray->direction) < hit->dist) {
+    spheres->hits.append(index);
+  }
+}
+
+static void nearest_spheres_callback(void *userdata,
+                                     int index,
+                                     const float co[3],
+                                     BVHTreeNearest *nearest)
+{
+  const SpheresData *spheres = static_cast<const SpheresData *>(userdata);
+  if (sphere_is_hidden(spheres, index)) {
+    return;
+  }
+  const float dist_sq = len_squared_v3v3(co, spheres->centers[index]);
+  if (dist_sq < nearest->dist_sq) {
+    nearest->index = index;
+    nearest->dist_sq = dist_sq;
+  }
+}
+
+/** Random ray from outside of the spheres, passing through the area covered by them. */
+static void rng_ray(RNG *rng, float co[3], float dir[3])
+{
+  float target[3];
+  BLI_rng_get_float_unit_v3(rng, co);
+  mul_v3_fl(co, 3.0f);
+  rng_v3_round(target, 3, rng, 1000, 1.0f);
+  sub_v3_v3v3(dir, target, co);
+  normalize_v3(dir);
+}
+
+/**
+ * Compare ray-casts and nearest queries with callbacks against testing all spheres. The callbacks
+ * ignore the hidden spheres, so the traversal has to continue after leaves that are missed.
+ */
+static void spheres_queries_test(BVHTree *tree, SpheresData *spheres, RNG *rng)
+{
+  for (int i = 0; i < 100; i++) {
+    float co[3], dir[3];
+    rng_ray(rng, co, dir);
+
+    int expected_index = -1;
+    float expected_dist = BVH_RAYCAST_DIST_MAX;
+    blender::Vector<int> expected_hits;
+    for (int j = 0; j < spheres->spheres_len; j++) {
+      const float dist = ray_sphere_dist(spheres, j, co, dir);
+      if (dist == BVH_RAYCAST_DIST_MAX) {
+        continue;
+      }
+      expected_hits.append(j);
+      if (!sphere_is_hidden(spheres, j) && dist < expected_dist) {
+        expected_index = j;
+        expected_dist = dist;
+      }
+    }
+
+    BVHTreeRayHit hit;
+    hit.index = -1;
+    hit.dist = BVH_RAYCAST_DIST_MAX;
+    BLI_bvhtree_ray_cast(tree, co, dir, 0.0f, &hit, ray_cast_spheres_callback, spheres);
+    EXPECT_EQ(hit.index, expected_index);
+    EXPECT_EQ(hit.dist, expected_dist);
+
+    /* All spheres along the ray are passed to the callback, hidden or not. */
+    spheres->hits.clear();
+    BLI_bvhtree_ray_cast_all(
+        tree, co, dir, 0.0f, BVH_RAYCAST_DIST_MAX, ray_cast_all_spheres_callback, spheres);
+    std::sort(spheres->hits.begin(), spheres->hits.end());
+    EXPECT_EQ(spheres->hits.as_span(), expected_hits.as_span());
+  }
+
+  for (int i = 0; i < 100; i++) {
+    float co[3];
+    rng_v3_round(co, 3, rng, 1000, 1.5f);
+
+    int expected_index = -1;
+    float expected_dist_sq = FLT_MAX;
+    for (int j = 0; j < spheres->spheres_len; j++) {
+      const float dist_sq = len_squared_v3v3(co, spheres->centers[j]);
+      if (!sphere_is_hidden(spheres, j) && dist_sq < expected_dist_sq) {
+        expected_index = j;
+        expected_dist_sq = dist_sq;
+      }
+    }
+
+    BVHTreeNearest nearest;
+    nearest.index = -1;
+    nearest.dist_sq = FLT_MAX;
+    BLI_bvhtree_find_nearest(tree, co, &nearest, nearest_spheres_callback, spheres);
+    EXPECT_EQ(nearest.index, expected_index);
+    EXPECT_EQ(nearest.dist_sq, expected_dist_sq);
+  }
+}
+
+TEST(kdopbvh, RayCastAll_Spheres)
+{
+  SpheresData *spheres = spheres_create(5000, 0.02f, 12);
+  RNG *rng = BLI_rng_new(123);
+  BVHTree *tree = BLI_bvhtree_new(spheres->spheres_len, 0.0, 4, 6);
+  spheres_tree_insert_or_update(tree, spheres, false);
+  spheres_queries_test(tree, spheres, rng);
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  spheres_free(spheres);
+}
+
+TEST(kdopbvh, CallbackMisses_Spheres)
+{
+  SpheresData *spheres = spheres_create(5000, 0.02f, 1234);
+  spheres->even_only = true;
+  RNG *rng = BLI_rng_new(12345);
+  BVHTree *tree = BLI_bvhtree_new(spheres->spheres_len, 0.0, 8, 8);
+  spheres_tree_insert_or_update(tree, spheres, false);
+  spheres_queries_test(tree, spheres, rng);
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  spheres_free(spheres);
+}
+
+TEST(kdopbvh, UpdateTree_Spheres)
+{
+  SpheresData *spheres = spheres_create(5000, 0.02f, 123456);
+  RNG *rng = BLI_rng_new(1);
+  BVHTree *tree = BLI_bvhtree_new(spheres->spheres_len, 0.0, 2, 6);
+  spheres_tree_insert_or_update(tree, spheres, false);
+  /* Build the wide tree before moving the spheres. */
+  spheres_queries_test(tree, spheres, rng);
+
+  /* Move the spheres far enough for the queries to fail when the wide tree isn't refit. */
+  for (int i = 0; i < spheres->spheres_len; i++) {
+    float offset[3];
+    rng_v3_round(offset, 3, rng, 1000, 0.25f);
+    add_v3_v3(spheres->centers[i], offset);
+  }
+  spheres_tree_insert_or_update(tree, spheres, true);
+  spheres_queries_test(tree, spheres, rng);
+
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  spheres_free(spheres);
+}
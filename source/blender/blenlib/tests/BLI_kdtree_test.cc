@@ -4,7 +4,10 @@
 
 #include "testing/testing.h"
 
-#include "BLI_kdtree.h"
+#include "BLI_kdtree.hh"
+#include "BLI_math_vector.hh"
+#include "BLI_rand.hh"
+#include "BLI_vector.hh"
 
 #include <cmath>
 
@@ -63,3 +66,107 @@ TEST(kdtree, Deduplicate)
 {
   deduplicate_test();
 }
+
+/* -------------------------------------------------------------------- */
+/* Large Trees & Batch Queries */
+
+namespace blender::kdtree::tests {
+
+static Array<float3> random_points(const int points_num, const uint32_t seed)
+{
+  RandomNumberGenerator rng(seed);
+  Array<float3> points(points_num);
+  for (float3 &point : points) {
+    point = float3(rng.get_float(), rng.get_float(), rng.get_float());
+  }
+  return points;
+}
+
+static KDTree_3d *build_tree(const Span<float3> points)
+{
+  KDTree_3d *tree = BLI_kdtree_3d_new(points.size());
+  for (const int i : points.index_range()) {
+    BLI_kdtree_3d_insert(tree, i, points[i]);
+  }
+  BLI_kdtree_3d_balance(tree);
+  return tree;
+}
+
+/** Sorted distances from \a position to all points, for brute-force comparisons. */
+static Vector<float> sorted_distances(const Span<float3> points, const float3 &position)
+{
+  Vector<float> distances;
+  for (const float3 &point : points) {
+    distances.append(math::distance(point, position));
+  }
+  std::sort(distances.begin(), distances.end());
+  return distances;
+}
+
+TEST(kdtree, BalanceLarge)
+{
+  /* Large enough to be balanced in parallel. */
+  const Array<float3> points = random_points(50000, 0);
+  const Array<float3> queries = random_points(20, 1);
+  KDTree_3d *tree = build_tree(points);
+  /* Balancing again has to reset the existing links. */
+  for ([[maybe_unused]] const int pass : IndexRange(2)) {
+    for (const float3 &query : queries) {
+      KDTreeNearest_3d nearest;
+      const int index = BLI_kdtree_3d_find_nearest(tree, query, &nearest);
+      ASSERT_NE(index, -1);
+      EXPECT_FLOAT_EQ(nearest.dist, sorted_distances(points, query).first());
+    }
+    BLI_kdtree_3d_balance(tree);
+  }
+  BLI_kdtree_3d_free(tree);
+}
+
+TEST(kdtree, FindNearestNBatch)
+{
+  const Array<float3> points = random_points(20000, 2);
+  const Array<float3> queries = random_points(3000, 3);
+  KDTree_3d *tree = build_tree(points);
+  const NearestGroups result = find_nearest_n_batch(*tree, queries, 5);
+  ASSERT_EQ(result.offsets().size(), queries.size());
+  EXPECT_EQ(result.nearest.size(), queries.size() * 5);
+  for (int i = 0; i < queries.size(); i += 37) {
+    const Vector<float> distances = sorted_distances(points, queries[i]);
+    const Span<KDTreeNearest_3d> nearest = result[i];
+    ASSERT_EQ(nearest.size(), 5);
+    for (const int j : nearest.index_range()) {
+      EXPECT_FLOAT_EQ(nearest[j].dist, distances[j]);
+      EXPECT_FLOAT_EQ(math::distance(points[nearest[j].index], queries[i]), nearest[j].dist);
+    }
+  }
+  /* Fewer points than requested. */
+  const NearestGroups all = find_nearest_n_batch(*tree, queries.as_span().take_front(2), 30000);
+  EXPECT_EQ(all[0].size(), points.size());
+  EXPECT_EQ(all[1].size(), points.size());
+  BLI_kdtree_3d_free(tree);
+}
+
+TEST(kdtree, RangeSearchBatch)
+{
+  const Array<float3> points = random_points(20000, 4);
+  const Array<float3> queries = random_points(3000, 5);
+  const float range = 0.05f;
+  KDTree_3d *tree = build_tree(points);
+  const NearestGroups result = range_search_batch(*tree, queries, range);
+  ASSERT_EQ(result.offsets().size(), queries.size());
+  for (int i = 0; i < queries.size(); i += 37) {
+    const Vector<float> distances = sorted_distances(points, queries[i]);
+    const Span<KDTreeNearest_3d> nearest = result[i];
+    const int64_t expected_num = std::upper_bound(distances.begin(), distances.end(), range) -
+                                 distances.begin();
+    EXPECT_EQ(nearest.size(), expected_num);
+    for (const int j : nearest.index_range()) {
+      EXPECT_FLOAT_EQ(nearest[j].dist, distances[j]);
+    }
+  }
+  /* No queries. */
+  EXPECT_TRUE(range_search_batch(*tree, {}, range).nearest.is_empty());
+  BLI_kdtree_3d_free(tree);
+}
+
+}  // namespace blender::kdtree::tests
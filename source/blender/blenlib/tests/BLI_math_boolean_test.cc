@@ -0,0 +1,89 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_math_boolean.hh"
+#include "BLI_rand.hh"
+
+#ifdef WITH_GMP
+namespace blender::tests {
+
+static double3 approx(const mpq3 &co)
+{
+  return double3(co[0].get_d(), co[1].get_d(), co[2].get_d());
+}
+
+/** Check that the filter never contradicts the exact predicate. */
+static void expect_filter_agrees(const mpq3 &a,
+                                 const mpq3 &b,
+                                 const mpq3 &c,
+                                 const mpq3 &d,
+                                 const double static_error_bound,
+                                 int &r_decided_num)
+{
+  const int exact = orient3d(a, b, c, d);
+  const double3 da = approx(a), db = approx(b), dc = approx(c), dd = approx(d);
+  const int dynamic = orient3d_filter(da, db, dc, dd);
+  const int both = orient3d_filter(da, db, dc, dd, static_error_bound);
+  if (dynamic != 0) {
+    EXPECT_EQ(dynamic, exact);
+    r_decided_num++;
+  }
+  if (both != 0) {
+    EXPECT_EQ(both, exact);
+  }
+}
+
+TEST(math_boolean, Orient3dFilterSimple)
+{
+  const double3 a(0, 0, 0), b(1, 0, 0), c(0, 1, 0);
+  EXPECT_EQ(orient3d_filter(a, b, c, double3(0.2, 0.2, -1)), orient3d(a, b, c, double3(0, 0, -1)));
+  EXPECT_EQ(orient3d_filter(a, b, c, double3(0.2, 0.2, 1)), orient3d(a, b, c, double3(0, 0, 1)));
+  EXPECT_EQ(orient3d_filter(a, b, c, double3(0.2, 0.2, 1)), -1);
+  /* Co-planar points can't be decided by the filter. */
+  EXPECT_EQ(orient3d_filter(a, b, c, double3(0.3, 0.7, 0)), 0);
+
+  const double static_bound = orient3d_static_error_bound(1.0);
+  EXPECT_GT(static_bound, 0.0);
+  EXPECT_EQ(orient3d_filter(a, b, c, double3(0.2, 0.2, -1), static_bound), 1);
+  EXPECT_EQ(orient3d_filter(a, b, c, double3(0.3, 0.7, 0), static_bound), 0);
+}
+
+TEST(math_boolean, Orient3dFilterRandom)
+{
+  RandomNumberGenerator rng(0);
+  const double static_bound = orient3d_static_error_bound(2.0);
+  int decided_num = 0;
+  constexpr int tests_num = 2000;
+  for ([[maybe_unused]] const int i : IndexRange(tests_num)) {
+    /* Rational coordinates that are not exactly representable as doubles. */
+    const auto random_co = [&]() {
+      return mpq3(mpq_class(rng.get_int32(2000) - 1000, 1 + rng.get_int32(999)),
+                  mpq_class(rng.get_int32(2000) - 1000, 1 + rng.get_int32(999)),
+                  mpq_class(rng.get_int32(2000) - 1000, 1 + rng.get_int32(999))) /
+             mpq_class(1000);
+    };
+    const mpq3 a = random_co();
+    const mpq3 b = random_co();
+    const mpq3 c = random_co();
+    expect_filter_agrees(a, b, c, random_co(), static_bound, decided_num);
+
+    /* A point that is exactly on the plane, and points that are very close to it. */
+    const mpq_class u(rng.get_int32(1000), 997);
+    const mpq_class v(rng.get_int32(1000), 991);
+    const mpq3 on_plane = a + u * (b - a) + v * (c - a);
+    const mpq3 normal = math::cross(b - a, c - a);
+    expect_filter_agrees(a, b, c, on_plane, static_bound, decided_num);
+    expect_filter_agrees(
+        a, b, c, on_plane + normal * mpq_class(1, 1000000000), static_bound, decided_num);
+    expect_filter_agrees(
+        a, b, c, on_plane - normal * mpq_class(1, 1000000000), static_bound, decided_num);
+  }
+  /* Most points in general position are decided without exact arithmetic. */
+  EXPECT_GT(decided_num, tests_num * 9 / 10);
+}
+
+}  // namespace blender::tests
+#endif
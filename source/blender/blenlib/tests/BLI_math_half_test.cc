@@ -0,0 +1,73 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include <cmath>
+#include <limits>
+
+#include "BLI_math_half.hh"
+
+namespace blender::tests {
+
+TEST(math_half, FloatToHalf)
+{
+  EXPECT_EQ(math::float_to_half(0.0f), 0x0000);
+  EXPECT_EQ(math::float_to_half(-0.0f), 0x8000);
+  EXPECT_EQ(math::float_to_half(1.0f), 0x3c00);
+  EXPECT_EQ(math::float_to_half(-2.0f), 0xc000);
+  EXPECT_EQ(math::float_to_half(0.5f), 0x3800);
+  EXPECT_EQ(math::float_to_half(65504.0f), 0x7bff);
+  /* Smallest sub-normal. */
+  EXPECT_EQ(math::float_to_half(5.9604645e-8f), 0x0001);
+  /* Round to nearest even. */
+  EXPECT_EQ(math::float_to_half(1.0f + 1.0f / 2048.0f), 0x3c00);
+  EXPECT_EQ(math::float_to_half(1.0f + 3.0f / 2048.0f), 0x3c02);
+  /* Out of range. */
+  EXPECT_EQ(math::float_to_half(100000.0f), 0x7c00);
+  EXPECT_EQ(math::float_to_half(-std::numeric_limits<float>::infinity()), 0xfc00);
+  EXPECT_EQ(math::float_to_half(std::numeric_limits<float>::quiet_NaN()) & 0x7e00, 0x7e00);
+}
+
+TEST(math_half, HalfToFloat)
+{
+  EXPECT_EQ(math::half_to_float(0x0000), 0.0f);
+  EXPECT_EQ(math::half_to_float(0x3c00), 1.0f);
+  EXPECT_EQ(math::half_to_float(0xc000), -2.0f);
+  EXPECT_EQ(math::half_to_float(0x7bff), 65504.0f);
+  EXPECT_EQ(math::half_to_float(0x0001), 5.9604645e-8f);
+  EXPECT_EQ(math::half_to_float(0x7c00), std::numeric_limits<float>::infinity());
+  EXPECT_TRUE(std::isnan(math::half_to_float(0x7e00)));
+}
+
+TEST(math_half, RoundTrip)
+{
+  for (int i = 0; i < 0x10000; i++) {
+    const uint16_t h = uint16_t(i);
+    if ((h & 0x7c00) == 0x7c00 && (h & 0x03ff) != 0) {
+      /* Skip NaN. */
+      continue;
+    }
+    EXPECT_EQ(math::float_to_half(math::half_to_float(h)), h);
+  }
+}
+
+TEST(math_half, Arrays)
+{
+  const int length = 37;
+  float src[length];
+  for (int i = 0; i < length; i++) {
+    src[i] = (i - 18) * 0.37f;
+  }
+  uint16_t half[length];
+  math::float_to_half_array(src, half, length);
+  float dst[length];
+  math::half_to_float_array(half, dst, length);
+  for (int i = 0; i < length; i++) {
+    EXPECT_EQ(half[i], math::float_to_half(src[i]));
+    EXPECT_EQ(dst[i], math::half_to_float(half[i]));
+  }
+}
+
+}  // namespace blender::tests
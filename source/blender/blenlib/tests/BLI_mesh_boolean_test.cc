@@ -497,6 +497,135 @@ TEST(boolean_trimesh, DegenerateTris)
   }
 }
 
+/**
+ * Add the triangles of a UV sphere centered at the origin, leaving out the triangles around the
+ * bottom pole when \a open is true.
+ */
+static void add_sphere_tris(
+    const int nrings, const int nsegs, const bool open, IMeshArena &arena, Vector<Face *> &r_faces)
+{
+  Array<const Vert *> verts((nrings - 1) * nsegs + 2);
+  for (const int ring : IndexRange(nrings - 1)) {
+    const double theta = M_PI * (ring + 1) / nrings;
+    for (const int seg : IndexRange(nsegs)) {
+      const double phi = 2.0 * M_PI * seg / nsegs;
+      const double3 co(std::sin(theta) * std::cos(phi),
+                       std::sin(theta) * std::sin(phi),
+                       std::cos(theta));
+      verts[ring * nsegs + seg] = arena.add_or_find_vert(co, ring * nsegs + seg);
+    }
+  }
+  const int top = verts.size() - 2;
+  const int bottom = verts.size() - 1;
+  verts[top] = arena.add_or_find_vert(double3(0, 0, 1), top);
+  verts[bottom] = arena.add_or_find_vert(double3(0, 0, -1), bottom);
+  const auto add_tri = [&](const int v0, const int v1, const int v2) {
+    const int f = r_faces.size();
+    r_faces.append(arena.add_face({verts[v0], verts[v1], verts[v2]},
+                                  f,
+                                  {IMeshBuilder::edge_index(f, 0),
+                                   IMeshBuilder::edge_index(f, 1),
+                                   IMeshBuilder::edge_index(f, 2)}));
+  };
+  for (const int seg : IndexRange(nsegs)) {
+    const int next_seg = (seg + 1) % nsegs;
+    add_tri(top, seg, next_seg);
+    for (const int ring : IndexRange(nrings - 2)) {
+      const int v0 = ring * nsegs + seg;
+      const int v1 = ring * nsegs + next_seg;
+      add_tri(v0, v0 + nsegs, v1 + nsegs);
+      add_tri(v0, v1 + nsegs, v1);
+    }
+    if (!open) {
+      add_tri(bottom, (nrings - 2) * nsegs + next_seg, (nrings - 2) * nsegs + seg);
+    }
+  }
+}
+
+/** Add the triangles of an axis aligned cube. */
+static void add_cube_tris(const double3 &center,
+                          const double half_size,
+                          IMeshArena &arena,
+                          Vector<Face *> &r_faces)
+{
+  Array<const Vert *> verts(8);
+  for (const int i : verts.index_range()) {
+    const double3 offset(i & 1 ? half_size : -half_size,
+                         i & 2 ? half_size : -half_size,
+                         i & 4 ? half_size : -half_size);
+    verts[i] = arena.add_or_find_vert(center + offset, arena.tot_allocated_verts());
+  }
+  const int quads[6][4] = {
+      {0, 2, 3, 1}, {4, 5, 7, 6}, {0, 1, 5, 4}, {2, 6, 7, 3}, {0, 4, 6, 2}, {1, 3, 7, 5}};
+  for (const auto &quad : quads) {
+    for (const int tri : IndexRange(2)) {
+      const int f = r_faces.size();
+      r_faces.append(arena.add_face({verts[quad[0]], verts[quad[tri + 1]], verts[quad[tri + 2]]},
+                                    f,
+                                    {IMeshBuilder::edge_index(f, 0),
+                                     IMeshBuilder::edge_index(f, 1),
+                                     IMeshBuilder::edge_index(f, 2)}));
+    }
+  }
+}
+
+/**
+ * Subtract a small cube from a sphere with enough triangles to build the mesh topology in
+ * multiple partitions, and compare with building it in a single partition.
+ */
+static void test_partitioned_sphere_cube_diff(const bool open_sphere)
+{
+  const int sphere_tris_num = 2 * 64 * 64 + (open_sphere ? 64 : 128);
+  const auto shape_fn = [&](const int t) { return t < sphere_tris_num ? 0 : 1; };
+  const auto compute = [&](IMeshArena &arena) {
+    Vector<Face *> faces;
+    add_sphere_tris(66, 64, open_sphere, arena, faces);
+    EXPECT_EQ(faces.size(), sphere_tris_num);
+    add_cube_tris(double3(0.95, 0.03, 0.07), 0.1, arena, faces);
+    IMesh mesh(faces);
+    return boolean_trimesh(mesh, BoolOpType::Difference, 2, shape_fn, false, false, &arena);
+  };
+
+  IMeshArena arena;
+  IMesh out = compute(arena);
+
+  const int max_grid_resolution = boolean_topology_max_grid_resolution;
+  boolean_topology_max_grid_resolution = 1;
+  IMeshArena single_arena;
+  IMesh single_out = compute(single_arena);
+  boolean_topology_max_grid_resolution = max_grid_resolution;
+
+  /* The cut adds faces to the sphere and removes the faces inside the cube. */
+  EXPECT_GT(out.face_size(), sphere_tris_num);
+  ASSERT_EQ(out.face_size(), single_out.face_size());
+  for (const int f : out.face_index_range()) {
+    const Face &face = *out.face(f);
+    const Face &single_face = *single_out.face(f);
+    EXPECT_EQ(face.orig, single_face.orig) << "face " << f;
+    ASSERT_EQ(face.size(), single_face.size());
+    for (const int i : face.index_range()) {
+      EXPECT_EQ(face[i]->co_exact, single_face[i]->co_exact) << "face " << f << ", vert " << i;
+      EXPECT_EQ(face[i]->orig, single_face[i]->orig);
+      EXPECT_EQ(face.edge_orig[i], single_face.edge_orig[i]);
+    }
+  }
+  if (DO_OBJ) {
+    write_obj_mesh(out, open_sphere ? "open_sphere_cube_diff_tm" : "sphere_cube_diff_tm");
+  }
+}
+
+TEST(boolean_trimesh, PartitionedSphereCubeDiff)
+{
+  test_partitioned_sphere_cube_diff(false);
+}
+
+TEST(boolean_trimesh, PartitionedOpenSphereCubeDiff)
+{
+  /* The sphere has a hole, so the mesh isn't piecewise constant winding, and the boolean takes
+   * the raycast path. */
+  test_partitioned_sphere_cube_diff(true);
+}
+
 TEST(boolean_polymesh, TetTet)
 {
   const char *spec = R"(8 8
@@ -0,0 +1,71 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_noise.hh"
+#include "BLI_rand.hh"
+
+namespace blender::noise::tests {
+
+/** Random positions, including integer coordinates, signed zeros and wrapped coordinates. */
+template<typename T> static Array<T> random_positions(const int64_t size)
+{
+  RandomNumberGenerator rng(0);
+  Array<T> positions(size);
+  for (T &position : positions) {
+    for (int i = 0; i < T::type_length; i++) {
+      const float value = rng.get_float() * 20.0f - 10.0f;
+      switch (rng.get_int32(5)) {
+        case 0:
+          position[i] = value;
+          break;
+        case 1:
+          position[i] = std::floor(value);
+          break;
+        case 2:
+          position[i] = rng.get_int32(2) ? 0.0f : -0.0f;
+          break;
+        case 3:
+          position[i] = value * 1e-30f;
+          break;
+        case 4:
+          position[i] = value * 300000.0f;
+          break;
+      }
+    }
+  }
+  return positions;
+}
+
+/** The batch functions must give exactly the same results as the single position functions. */
+template<typename T> static void test_perlin_signed_batch()
+{
+  /* Not a multiple of four, to test the padding of the last batch. */
+  const Array<T> positions = random_positions<T>(1001);
+  Array<float> values(positions.size());
+  perlin_signed(positions.as_span(), values);
+  for (const int64_t i : positions.index_range()) {
+    EXPECT_EQ(values[i], perlin_signed(positions[i]));
+    EXPECT_EQ(std::signbit(values[i]), std::signbit(perlin_signed(positions[i])));
+  }
+}
+
+TEST(noise, PerlinSignedBatch2D)
+{
+  test_perlin_signed_batch<float2>();
+}
+
+TEST(noise, PerlinSignedBatch3D)
+{
+  test_perlin_signed_batch<float3>();
+}
+
+TEST(noise, PerlinSignedBatch4D)
+{
+  test_perlin_signed_batch<float4>();
+}
+
+}  // namespace blender::noise::tests
@@ -872,9 +872,11 @@ static void bm_to_mesh_shape(BMesh *bm,
 
       if (currkey->data && (currkey->totelem == bm->totvert)) {
         /* Use memory in-place. */
+        BKE_keyblock_data_ensure_mutable(currkey);
       }
       else {
-        currkey->data = MEM_reallocN(currkey->data, key->elemsize * bm->totvert);
+        BKE_keyblock_data_free(currkey);
+        currkey->data = MEM_mallocN(key->elemsize * bm->totvert, __func__);
         currkey->totelem = bm->totvert;
       }
       currkey_data = (float(*)[3])currkey->data;
@@ -949,9 +951,7 @@ static void bm_to_mesh_shape(BMesh *bm,
       }
 
       currkey->totelem = bm->totvert;
-      if (currkey->data) {
-        MEM_freeN(currkey->data);
-      }
+      BKE_keyblock_data_free(currkey);
       currkey->data = currkey_data;
     }
   }
@@ -0,0 +1,207 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include <algorithm>
+#include <complex>
+#include <mutex>
+
+#if defined(WITH_FFTW3)
+#  include <fftw3.h>
+#endif
+
+#include "BLI_fftw.hh"
+#include "BLI_index_range.hh"
+#include "BLI_map.hh"
+#include "BLI_math_base.h"
+#include "BLI_math_base.hh"
+#include "BLI_math_vector.hh"
+#include "BLI_math_vector_types.hh"
+#include "BLI_task.hh"
+
+#include "COM_FFTConvolutionAlgorithm.h"
+#include "COM_MemoryBuffer.h"
+
+namespace blender::compositor {
+
+bool use_fft_convolution(const int2 kernel_size)
+{
+#if defined(WITH_FFTW3)
+  /* Rough break-even point with the direct convolutions of the compositor operations, which cost
+   * a few operations per kernel pixel and channel. */
+  return int64_t(kernel_size.x) * kernel_size.y >= 16 * 16;
+#else
+  UNUSED_VARS(kernel_size);
+  return false;
+#endif
+}
+
+#if defined(WITH_FFTW3)
+
+/** Real to complex and complex to real transforms of a given spatial size. */
+struct FFTPlans {
+  fftwf_plan forward;
+  fftwf_plan backward;
+};
+
+/**
+ * Get the plans to transform arrays of the given spatial size, creating them the first time. The
+ * size only depends on the kernel size, so the plans are shared by all the tiles and usually
+ * reused between executions. They can be executed concurrently on arrays allocated with FFTW.
+ */
+static FFTPlans get_fft_plans(const int2 spatial_size)
+{
+  static std::mutex mutex;
+  static Map<int2, FFTPlans> plans;
+
+  std::scoped_lock lock(mutex);
+  return plans.lookup_or_add_cb(spatial_size, [&]() {
+    const int2 frequency_size = int2(spatial_size.x / 2 + 1, spatial_size.y);
+    float *spatial_domain = fftwf_alloc_real(int64_t(spatial_size.x) * spatial_size.y);
+    fftwf_complex *frequency_domain = fftwf_alloc_complex(int64_t(frequency_size.x) *
+                                                          frequency_size.y);
+
+    FFTPlans new_plans;
+    new_plans.forward = fftwf_plan_dft_r2c_2d(
+        spatial_size.y, spatial_size.x, spatial_domain, frequency_domain, FFTW_ESTIMATE);
+    new_plans.backward = fftwf_plan_dft_c2r_2d(
+        spatial_size.y, spatial_size.x, frequency_domain, spatial_domain, FFTW_ESTIMATE);
+
+    fftwf_free(spatial_domain);
+    fftwf_free(frequency_domain);
+    return new_plans;
+  });
+}
+
+#endif
+
+bool fft_convolve(const MemoryBuffer &input,
+                  const MemoryBuffer &kernel,
+                  MemoryBuffer &output,
+                  const rcti &area)
+{
+#if defined(WITH_FFTW3)
+  BLI_assert(input.get_num_channels() == output.get_num_channels());
+  BLI_assert(ELEM(kernel.get_num_channels(), 1, input.get_num_channels()));
+  fftw::initialize_float();
+
+  const int channels_count = output.get_num_channels();
+  const int kernel_channels_count = kernel.get_num_channels();
+  const int2 kernel_size = int2(kernel.get_width(), kernel.get_height());
+  const int2 kernel_center = kernel_size / 2;
+  const int2 area_size = int2(BLI_rcti_size_x(&area), BLI_rcti_size_y(&area));
+
+  /* Each tile reads the input around it up to the kernel size, which is transformed along with
+   * the tile. Tiles a few times larger than the kernel keep that overhead low, while small enough
+   * transforms fit in cache and leave enough tiles to process in parallel. */
+  const int tile_length = std::max(128, 2 * math::reduce_max(kernel_size));
+  const int2 tile_size = math::min(area_size, int2(tile_length));
+  const int2 tiles_count = math::divide_ceil(area_size, tile_size);
+
+  /* The circular convolution of a tile doesn't wrap around when the transform is at least as
+   * large as the tile and the kernel together. */
+  const int2 spatial_size = fftw::optimal_size_for_real_transform(tile_size + kernel_size - 1);
+  const int2 frequency_size = int2(spatial_size.x / 2 + 1, spatial_size.y);
+  const int64_t spatial_pixels_count = int64_t(spatial_size.x) * spatial_size.y;
+  const int64_t frequency_pixels_count = int64_t(frequency_size.x) * frequency_size.y;
+  const FFTPlans plans = get_fft_plans(spatial_size);
+
+  /* Transform each kernel channel once. The kernel is flipped and wrapped around the origin, so
+   * that the convolution weights the input pixels the same way as the kernel. */
+  float *kernel_spatial_domain = fftwf_alloc_real(spatial_pixels_count * kernel_channels_count);
+  std::complex<float> *kernel_frequency_domain = reinterpret_cast<std::complex<float> *>(
+      fftwf_alloc_complex(frequency_pixels_count * kernel_channels_count));
+  const rcti &kernel_rect = kernel.get_rect();
+  threading::parallel_for(IndexRange(kernel_channels_count), 1, [&](const IndexRange sub_range) {
+    for (const int64_t channel : sub_range) {
+      float *channel_spatial_domain = kernel_spatial_domain + spatial_pixels_count * channel;
+      std::fill_n(channel_spatial_domain, spatial_pixels_count, 0.0f);
+      for (const int64_t y : IndexRange(kernel_size.y)) {
+        for (const int64_t x : IndexRange(kernel_size.x)) {
+          const int64_t wrapped_x = mod_i(kernel_center.x - x, spatial_size.x);
+          const int64_t wrapped_y = mod_i(kernel_center.y - y, spatial_size.y);
+          channel_spatial_domain[wrapped_x + wrapped_y * spatial_size.x] = kernel.get_elem(
+              kernel_rect.xmin + x, kernel_rect.ymin + y)[channel];
+        }
+      }
+      fftwf_execute_dft_r2c(plans.forward,
+                            channel_spatial_domain,
+                            reinterpret_cast<fftwf_complex *>(kernel_frequency_domain) +
+                                frequency_pixels_count * channel);
+    }
+  });
+  fftwf_free(kernel_spatial_domain);
+
+  /* The transforms are not normalized, so the inverse transform scales the result by the number
+   * of pixels. See Section 4.8.6 Multi-dimensional Transforms of the FFTW manual. */
+  const float normalization_scale = 1.0f / float(spatial_pixels_count);
+
+  threading::parallel_for(
+      IndexRange(int64_t(tiles_count.x) * tiles_count.y), 1, [&](const IndexRange sub_range) {
+        float *spatial_domain = fftwf_alloc_real(spatial_pixels_count);
+        std::complex<float> *frequency_domain = reinterpret_cast<std::complex<float> *>(
+            fftwf_alloc_complex(frequency_pixels_count));
+
+        for (const int64_t tile_index : sub_range) {
+          const int2 tile_start = int2(area.xmin + (tile_index % tiles_count.x) * tile_size.x,
+                                       area.ymin + (tile_index / tiles_count.x) * tile_size.y);
+          const int2 tile_end = math::min(tile_start + tile_size, int2(area.xmax, area.ymax));
+          /* The input pixels the tile reads, starting half a kernel before it. */
+          const int2 input_start = tile_start - kernel_center;
+          const int2 input_size = tile_end - tile_start + kernel_size - 1;
+
+          for (const int channel : IndexRange(channels_count)) {
+            for (const int64_t y : IndexRange(spatial_size.y)) {
+              float *row = spatial_domain + y * spatial_size.x;
+              if (y >= input_size.y) {
+                std::fill_n(row, spatial_size.x, 0.0f);
+                continue;
+              }
+              for (const int64_t x : IndexRange(input_size.x)) {
+                row[x] = input.get_elem_clamped(input_start.x + x, input_start.y + y)[channel];
+              }
+              std::fill_n(row + input_size.x, spatial_size.x - input_size.x, 0.0f);
+            }
+
+            fftwf_execute_dft_r2c(plans.forward,
+                                  spatial_domain,
+                                  reinterpret_cast<fftwf_complex *>(frequency_domain));
+
+            const std::complex<float> *channel_kernel = kernel_frequency_domain +
+                                                        frequency_pixels_count *
+                                                            (kernel_channels_count == 1 ? 0 :
+                                                                                          channel);
+            for (const int64_t i : IndexRange(frequency_pixels_count)) {
+              frequency_domain[i] *= channel_kernel[i] * normalization_scale;
+            }
+
+            fftwf_execute_dft_c2r(plans.backward,
+                                  reinterpret_cast<fftwf_complex *>(frequency_domain),
+                                  spatial_domain);
+
+            /* The convolution of the input pixels is centered, so the tile starts at the kernel
+             * center. */
+            for (int y = tile_start.y; y < tile_end.y; y++) {
+              const float *row = spatial_domain +
+                                 int64_t(y - tile_start.y + kernel_center.y) * spatial_size.x +
+                                 kernel_center.x;
+              for (int x = tile_start.x; x < tile_end.x; x++) {
+                output.get_elem(x, y)[channel] = row[x - tile_start.x];
+              }
+            }
+          }
+        }
+
+        fftwf_free(spatial_domain);
+        fftwf_free(frequency_domain);
+      });
+
+  fftwf_free(kernel_frequency_domain);
+  return true;
+#else
+  UNUSED_VARS(input, kernel, output, area);
+  return false;
+#endif
+}
+
+}  // namespace blender::compositor
@@ -0,0 +1,43 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+#include "BLI_math_vector_types.hh"
+
+#include "DNA_vec_types.h"
+
+#include "COM_MemoryBuffer.h"
+
+namespace blender::compositor {
+
+/**
+ * Whether convolving with a kernel of the given size is expected to be faster with
+ * #fft_convolve than with a direct convolution. Always false when built without FFTW.
+ */
+bool use_fft_convolution(int2 kernel_size);
+
+/**
+ * Convolves the input with the kernel in the frequency domain, writing the given area of the
+ * output. The cost per pixel barely depends on the kernel size, unlike direct convolutions.
+ *
+ * Each output pixel is the sum of the input pixels around it weighted by the kernel, which is
+ * centered on its middle pixel and not flipped:
+ *
+ *   output(x, y) = sum(kernel(i, j) * input(x + i - center_x, y + j - center_y))
+ *
+ * Input pixels outside of the input are clamped to its border. The kernel has either a single
+ * channel, used for all the input channels, or as many channels as the input. The result is not
+ * normalized.
+ *
+ * The area is processed in tiles that are transformed independently and in parallel
+ * (overlap-save), so the transforms stay small even for large images. Returns false without
+ * writing the output when built without FFTW.
+ */
+bool fft_convolve(const MemoryBuffer &input,
+                  const MemoryBuffer &kernel,
+                  MemoryBuffer &output,
+                  const rcti &area);
+
+}  // namespace blender::compositor
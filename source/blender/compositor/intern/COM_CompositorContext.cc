@@ -25,4 +25,18 @@ Size2f CompositorContext::get_render_size() const
           get_render_data()->ysch * get_render_percentage_as_factor()};
 }
 
+size_t CompositorContext::get_memory_limit() const
+{
+  if (rd_ == nullptr) {
+    return 0;
+  }
+  return size_t(rd_->compositor_memory_limit) * 1024 * 1024;
+}
+
+bool CompositorContext::use_half_float_storage() const
+{
+  /* Auto precision uses full precision for final renders and half precision otherwise. */
+  return rd_ && rd_->compositor_precision == SCE_COMPOSITOR_PRECISION_AUTO && !rendering_;
+}
+
 }  // namespace blender::compositor
@@ -220,6 +220,18 @@ class CompositorContext {
   }
 
   Size2f get_render_size() const;
+
+  /**
+   * Get the memory budget in bytes for intermediate results, above which operations are rendered
+   * in tiles. Zero when there is no limit.
+   */
+  size_t get_memory_limit() const;
+
+  /**
+   * Whether intermediate results waiting for their readers may be stored with half float
+   * precision, following the scene compositor precision.
+   */
+  bool use_half_float_storage() const;
 };
 
 }  // namespace blender::compositor
@@ -12,6 +12,7 @@
 #include "BLI_string.h"
 
 #include "BKE_appdir.hh"
+#include "CLG_log.h"
 #include "IMB_imbuf.hh"
 #include "IMB_imbuf_types.hh"
 
@@ -26,6 +27,8 @@ DebugInfo::OpNameMap DebugInfo::op_names_;
 std::string DebugInfo::current_node_name_;
 std::string DebugInfo::current_op_name_;
 
+static CLG_LogRef LOG_OPERATIONS = {"compositor.operations"};
+
 static std::string operation_class_name(const NodeOperation *op)
 {
   std::string full_name = typeid(*op).name();
@@ -57,6 +60,18 @@ std::string DebugInfo::operation_name(const NodeOperation *op)
   return "";
 }
 
+void DebugInfo::operation_render_time(const NodeOperation *op, const timeit::Nanoseconds time)
+{
+  CLOG_INFO(&LOG_OPERATIONS,
+            1,
+            "%s | %s | %dx%d | %.3f ms",
+            operation_class_name(op).c_str(),
+            op->get_name().c_str(),
+            int(op->get_width()),
+            int(op->get_height()),
+            std::chrono::duration<double, std::milli>(time).count());
+}
+
 int DebugInfo::graphviz_operation(const ExecutionSystem *system,
                                   NodeOperation *operation,
                                   char *str,
@@ -7,6 +7,7 @@
 #include <map>
 #include <string>
 
+#include "BLI_timeit.hh"
 #include "BLI_vector.hh"
 
 #include "COM_ExecutionSystem.h"
@@ -98,6 +99,12 @@ class DebugInfo {
     }
   }
 
+  /**
+   * Log the time taken to render an operation to the `compositor.operations` log, enabled with
+   * `--log "compositor.operations"`.
+   */
+  static void operation_render_time(const NodeOperation *op, timeit::Nanoseconds time);
+
   static void graphviz(const ExecutionSystem *system, StringRefNull name = "");
 
  protected:
@@ -4,11 +4,13 @@
 
 #include "COM_FullFrameExecutionModel.h"
 
+#include "BLI_set.hh"
 #include "BLI_string.h"
 
 #include "BLT_translation.hh"
 
 #include "COM_Debug.h"
+#include "COM_ResultCache.h"
 #include "COM_ViewerOperation.h"
 #include "COM_WorkScheduler.h"
 
@@ -64,6 +66,25 @@ void FullFrameExecutionModel::determine_areas_to_render_and_reads()
   }
 }
 
+/**
+ * Returns a view of an input operation buffer with an offset relative to given output
+ * coordinates of the reading operation. Returned memory buffer must be deleted.
+ */
+static MemoryBuffer *create_input_buffer_view(NodeOperation *op,
+                                              NodeOperation *input,
+                                              MemoryBuffer *buf,
+                                              const int output_x,
+                                              const int output_y)
+{
+  const int offset_x = (input->get_canvas().xmin - op->get_canvas().xmin) + output_x;
+  const int offset_y = (input->get_canvas().ymin - op->get_canvas().ymin) + output_y;
+
+  rcti rect = buf->get_rect();
+  BLI_rcti_translate(&rect, offset_x, offset_y);
+  return new MemoryBuffer(
+      buf->get_buffer(), buf->get_num_channels(), rect, buf->is_a_single_elem());
+}
+
 Vector<MemoryBuffer *> FullFrameExecutionModel::get_input_buffers(NodeOperation *op,
                                                                   const int output_x,
                                                                   const int output_y)
@@ -72,14 +93,8 @@ Vector<MemoryBuffer *> FullFrameExecutionModel::get_input_buffers(NodeOperation
   Vector<MemoryBuffer *> inputs_buffers(num_inputs);
   for (int i = 0; i < num_inputs; i++) {
     NodeOperation *input = op->get_input_operation(i);
-    const int offset_x = (input->get_canvas().xmin - op->get_canvas().xmin) + output_x;
-    const int offset_y = (input->get_canvas().ymin - op->get_canvas().ymin) + output_y;
     MemoryBuffer *buf = active_buffers_.get_rendered_buffer(input);
-
-    rcti rect = buf->get_rect();
-    BLI_rcti_translate(&rect, offset_x, offset_y);
-    inputs_buffers[i] = new MemoryBuffer(
-        buf->get_buffer(), buf->get_num_channels(), rect, buf->is_a_single_elem());
+    inputs_buffers[i] = create_input_buffer_view(op, input, buf, output_x, output_y);
   }
   return inputs_buffers;
 }
@@ -105,9 +120,23 @@ void FullFrameExecutionModel::render_operation(NodeOperation *op)
 
   const timeit::TimePoint before_time = timeit::Clock::now();
 
+  if (context_.use_half_float_storage()) {
+    /* Reduce memory usage of the results waiting for other readers. */
+    active_buffers_.store_as_half_float_except_inputs(op);
+  }
+
   const bool has_outputs = op->get_number_of_output_sockets() > 0;
-  MemoryBuffer *op_buf = has_outputs ? create_operation_buffer(op, output_x, output_y) : nullptr;
-  if (op->get_width() > 0 && op->get_height() > 0) {
+  MemoryBuffer *op_buf = nullptr;
+  if (const std::shared_ptr<const MemoryBuffer> cached_result = cached_results_.lookup_default(
+          op, nullptr))
+  {
+    op_buf = new MemoryBuffer(*cached_result);
+  }
+  else if (has_outputs) {
+    op_buf = create_operation_buffer(op, output_x, output_y);
+  }
+
+  if (op->get_width() > 0 && op->get_height() > 0 && !cached_results_.contains(op)) {
     Vector<MemoryBuffer *> input_bufs = get_input_buffers(op, output_x, output_y);
     const int op_offset_x = output_x - op->get_canvas().xmin;
     const int op_offset_y = output_y - op->get_canvas().ymin;
@@ -118,6 +147,10 @@ void FullFrameExecutionModel::render_operation(NodeOperation *op)
     for (MemoryBuffer *buf : input_bufs) {
       delete buf;
     }
+
+    if (op_buf) {
+      add_cached_result(op, *op_buf, areas, timeit::Clock::now() - before_time);
+    }
   }
   /* Even if operation has no resolution set the empty buffer. It will be clipped with a
    * TranslateOperation from convert resolutions if linked to an operation with resolution. */
@@ -128,15 +161,61 @@ void FullFrameExecutionModel::render_operation(NodeOperation *op)
   /* The operation may not come from any node. For example, it may have been added to convert data
    * type. Do not accumulate time from its execution. */
   const timeit::TimePoint after_time = timeit::Clock::now();
+  DebugInfo::operation_render_time(op, after_time - before_time);
   const bNodeInstanceKey node_instance_key = op->get_node_instance_key();
   if (context_.get_profiler() && node_instance_key != bke::NODE_INSTANCE_KEY_NONE) {
     context_.get_profiler()->set_node_evaluation_time(node_instance_key, after_time - before_time);
   }
 }
 
+std::shared_ptr<const MemoryBuffer> FullFrameExecutionModel::lookup_cached_result(
+    NodeOperation *op)
+{
+  /* Final renders don't benefit from caching and may not fit the memory anyway. */
+  if (context_.is_rendering() || !op->get_content_hash() || op->get_flags().is_constant_operation)
+  {
+    return nullptr;
+  }
+  std::shared_ptr<const MemoryBuffer> result = ResultCache::lookup(*op->get_content_hash());
+  const int num_channels = COM_data_type_num_channels(op->get_output_socket()->get_data_type());
+  if (result && (result->get_width() != op->get_width() ||
+                 result->get_height() != op->get_height() ||
+                 result->get_num_channels() != num_channels))
+  {
+    return nullptr;
+  }
+  return result;
+}
+
+void FullFrameExecutionModel::add_cached_result(NodeOperation *op,
+                                                const MemoryBuffer &result,
+                                                Span<rcti> rendered_areas,
+                                                const timeit::Nanoseconds render_time)
+{
+  /* Below this time, rendering the operation again costs about the same as copying its cached
+   * result. */
+  constexpr timeit::Nanoseconds min_render_time = std::chrono::milliseconds(2);
+  if (context_.is_rendering() || !op->get_content_hash() ||
+      op->get_flags().is_constant_operation || render_time < min_render_time)
+  {
+    return;
+  }
+
+  /* Only results rendered in full can be used by other executions, whatever their areas to
+   * render. */
+  const rcti full_area = result.get_rect();
+  for (const rcti &area : rendered_areas) {
+    if (BLI_rcti_inside_rcti(&area, &full_area)) {
+      ResultCache::add(*op->get_content_hash(), result);
+      return;
+    }
+  }
+}
+
 void FullFrameExecutionModel::render_operations()
 {
   const bool is_rendering = context_.is_rendering();
+  const bool use_tiles = context_.get_memory_limit() > 0;
 
   WorkScheduler::start();
   for (eCompositorPriority priority : priorities_) {
@@ -144,7 +223,10 @@ void FullFrameExecutionModel::render_operations()
       const bool has_size = op->get_width() > 0 && op->get_height() > 0;
       const bool is_priority_output = op->is_output_operation(is_rendering) &&
                                       op->get_render_priority() == priority;
-      if (is_priority_output && has_size) {
+      if (is_priority_output && has_size && use_tiles && op->get_flags().can_be_tiled) {
+        render_output_tiled(op);
+      }
+      else if (is_priority_output && has_size) {
         render_output_dependencies(op);
         render_operation(op);
       }
@@ -160,7 +242,9 @@ void FullFrameExecutionModel::render_operations()
  * Returns all dependencies from inputs to outputs. A dependency may be repeated when
  * several operations depend on it.
  */
-static Vector<NodeOperation *> get_operation_dependencies(NodeOperation *operation)
+static Vector<NodeOperation *> get_operation_dependencies(
+    NodeOperation *operation,
+    const Map<NodeOperation *, std::shared_ptr<const MemoryBuffer>> &cached_results)
 {
   /* Get dependencies from outputs to inputs. */
   Vector<NodeOperation *> dependencies;
@@ -170,6 +254,10 @@ static Vector<NodeOperation *> get_operation_dependencies(NodeOperation *operati
     Vector<NodeOperation *> outputs(next_outputs);
     next_outputs.clear();
     for (NodeOperation *output : outputs) {
+      /* Cached results don't need their inputs. */
+      if (cached_results.contains(output)) {
+        continue;
+      }
       for (int i = 0; i < output->get_number_of_input_sockets(); i++) {
         next_outputs.append(output->get_input_operation(i));
       }
@@ -186,7 +274,7 @@ static Vector<NodeOperation *> get_operation_dependencies(NodeOperation *operati
 void FullFrameExecutionModel::render_output_dependencies(NodeOperation *output_op)
 {
   BLI_assert(output_op->is_output_operation(context_.is_rendering()));
-  Vector<NodeOperation *> dependencies = get_operation_dependencies(output_op);
+  Vector<NodeOperation *> dependencies = get_operation_dependencies(output_op, cached_results_);
   for (NodeOperation *op : dependencies) {
     if (!active_buffers_.is_operation_rendered(op)) {
       render_operation(op);
@@ -194,6 +282,215 @@ void FullFrameExecutionModel::render_output_dependencies(NodeOperation *output_o
   }
 }
 
+static void get_operations_postorder_recursive(
+    NodeOperation *op,
+    const Map<NodeOperation *, std::shared_ptr<const MemoryBuffer>> &cached_results,
+    Set<NodeOperation *> &visited,
+    Vector<NodeOperation *> &r_operations)
+{
+  if (!visited.add(op)) {
+    return;
+  }
+  if (!cached_results.contains(op)) {
+    for (int i = 0; i < op->get_number_of_input_sockets(); i++) {
+      get_operations_postorder_recursive(
+          op->get_input_operation(i), cached_results, visited, r_operations);
+    }
+  }
+  r_operations.append(op);
+}
+
+Vector<NodeOperation *> FullFrameExecutionModel::get_tiled_operations(NodeOperation *output_op)
+{
+  /* Unique dependencies ordered from inputs to outputs. */
+  Set<NodeOperation *> visited;
+  Vector<NodeOperation *> dependencies;
+  get_operations_postorder_recursive(output_op, cached_results_, visited, dependencies);
+
+  /* Visit operations after all the operations reading them, an operation can only be tiled when
+   * all its readers are tiled too. Otherwise its buffer would have to be rendered in full for the
+   * other readers anyway. */
+  Map<NodeOperation *, int> tiled_reads;
+  Vector<NodeOperation *> tiled_ops;
+  for (int index = dependencies.size() - 1; index >= 0; index--) {
+    NodeOperation *op = dependencies[index];
+    if (op != output_op) {
+      const bool is_tiled = op->get_flags().can_be_tiled &&
+                            !active_buffers_.is_operation_rendered(op) &&
+                            !cached_results_.contains(op) &&
+                            tiled_reads.lookup_default(op, 0) ==
+                                active_buffers_.get_num_registered_reads(op);
+      if (!is_tiled) {
+        continue;
+      }
+    }
+    tiled_ops.append(op);
+    for (int i = 0; i < op->get_number_of_input_sockets(); i++) {
+      tiled_reads.add_or_modify(
+          op->get_input_operation(i),
+          [](int *value) { *value = 1; },
+          [](int *value) { (*value)++; });
+    }
+  }
+
+  /* Return operations ordered from inputs to outputs. */
+  std::reverse(tiled_ops.begin(), tiled_ops.end());
+  return tiled_ops;
+}
+
+int FullFrameExecutionModel::get_tile_height(Span<NodeOperation *> tiled_ops,
+                                             const rcti &output_area)
+{
+  /* Bytes per row of all the tiled operation buffers, except the output one which writes to its
+   * own storage. Tiled operations have correlated coordinates, so a row of the output needs
+   * about a row of each operation. */
+  size_t row_size = 0;
+  for (NodeOperation *op : tiled_ops.drop_back(1)) {
+    if (op->get_number_of_output_sockets() > 0) {
+      const DataType data_type = op->get_output_socket()->get_data_type();
+      row_size += size_t(op->get_width()) * COM_data_type_bytes_len(data_type);
+    }
+  }
+  const int height = BLI_rcti_size_y(&output_area);
+  if (row_size == 0) {
+    return height;
+  }
+  const size_t max_rows = context_.get_memory_limit() / row_size;
+  return std::max(1, int(std::min(max_rows, size_t(height))));
+}
+
+void FullFrameExecutionModel::render_output_tiled(NodeOperation *output_op)
+{
+  BLI_assert(output_op->is_output_operation(context_.is_rendering()));
+  const Vector<NodeOperation *> tiled_ops = get_tiled_operations(output_op);
+  const Set<NodeOperation *> tiled_ops_set(tiled_ops);
+
+  /* Operations that need global data are rendered in full beforehand, along with their
+   * dependencies. */
+  for (NodeOperation *op : tiled_ops) {
+    for (int i = 0; i < op->get_number_of_input_sockets(); i++) {
+      NodeOperation *input_op = op->get_input_operation(i);
+      if (!tiled_ops_set.contains(input_op) && !active_buffers_.is_operation_rendered(input_op)) {
+        for (NodeOperation *dependency : get_operation_dependencies(input_op, cached_results_)) {
+          if (!active_buffers_.is_operation_rendered(dependency)) {
+            render_operation(dependency);
+          }
+        }
+        render_operation(input_op);
+      }
+    }
+  }
+
+  rcti output_area;
+  get_output_render_area(output_op, output_area);
+  const int tile_height = get_tile_height(tiled_ops, output_area);
+
+  for (NodeOperation *op : tiled_ops) {
+    op->init_execution();
+  }
+  for (int y = output_area.ymin; y < output_area.ymax; y += tile_height) {
+    rcti tile;
+    BLI_rcti_init(
+        &tile, output_area.xmin, output_area.xmax, y, std::min(y + tile_height, output_area.ymax));
+    render_tile(tiled_ops, tiled_ops_set, tile);
+  }
+  for (NodeOperation *op : tiled_ops) {
+    op->deinit_execution();
+  }
+
+  for (NodeOperation *op : tiled_ops) {
+    operation_finished(op);
+  }
+}
+
+void FullFrameExecutionModel::render_tile(Span<NodeOperation *> tiled_ops,
+                                          const Set<NodeOperation *> &tiled_ops_set,
+                                          const rcti &tile)
+{
+  /* Determine the area each operation needs to render for the tile, from outputs to inputs. */
+  Map<NodeOperation *, rcti> tile_areas;
+  tile_areas.add_new(tiled_ops.last(), tile);
+  for (int index = tiled_ops.size() - 1; index >= 0; index--) {
+    NodeOperation *op = tiled_ops[index];
+    /* All readers of a tiled operation are tiled, so its area is known at this point. */
+    const rcti render_area = tile_areas.lookup(op);
+    for (int i = 0; i < op->get_number_of_input_sockets(); i++) {
+      NodeOperation *input_op = op->get_input_operation(i);
+      if (!tiled_ops_set.contains(input_op)) {
+        continue;
+      }
+      rcti input_area;
+      op->get_area_of_interest(input_op, render_area, input_area);
+      /* Ensure area of interest is within operation bounds, cropping areas outside. */
+      BLI_rcti_isect(&input_area, &input_op->get_canvas(), &input_area);
+      rcti *registered_area = tile_areas.lookup_ptr(input_op);
+      if (registered_area == nullptr) {
+        tile_areas.add_new(input_op, input_area);
+      }
+      else if (!BLI_rcti_is_empty(&input_area)) {
+        if (BLI_rcti_is_empty(registered_area)) {
+          *registered_area = input_area;
+        }
+        else {
+          BLI_rcti_union(registered_area, &input_area);
+        }
+      }
+    }
+  }
+
+  /* Render from inputs to outputs, freeing tile buffers as soon as all their readers are done. */
+  Map<NodeOperation *, std::unique_ptr<MemoryBuffer>> tile_buffers;
+  Map<NodeOperation *, int> remaining_reads;
+  for (NodeOperation *op : tiled_ops) {
+    const timeit::TimePoint before_time = timeit::Clock::now();
+
+    /* Tile buffers use the operation coordinates, like full buffers do. */
+    rcti area = tile_areas.lookup(op);
+    BLI_rcti_translate(&area, -op->get_canvas().xmin, -op->get_canvas().ymin);
+
+    MemoryBuffer *op_buf = nullptr;
+    if (op->get_number_of_output_sockets() > 0) {
+      op_buf = new MemoryBuffer(op->get_output_socket()->get_data_type(), area);
+      tile_buffers.add_new(op, std::unique_ptr<MemoryBuffer>(op_buf));
+      remaining_reads.add_new(op, active_buffers_.get_num_registered_reads(op));
+    }
+
+    const int num_inputs = op->get_number_of_input_sockets();
+    Vector<MemoryBuffer *> input_bufs(num_inputs);
+    for (int i = 0; i < num_inputs; i++) {
+      NodeOperation *input_op = op->get_input_operation(i);
+      MemoryBuffer *buf = tiled_ops_set.contains(input_op) ?
+                              tile_buffers.lookup(input_op).get() :
+                              active_buffers_.get_rendered_buffer(input_op);
+      input_bufs[i] = create_input_buffer_view(op, input_op, buf, 0, 0);
+    }
+
+    if (!BLI_rcti_is_empty(&area)) {
+      op->render_tile(op_buf, {area}, input_bufs);
+    }
+
+    for (int i = 0; i < num_inputs; i++) {
+      delete input_bufs[i];
+      NodeOperation *input_op = op->get_input_operation(i);
+      if (tiled_ops_set.contains(input_op)) {
+        int &reads = remaining_reads.lookup(input_op);
+        reads--;
+        if (reads == 0) {
+          tile_buffers.remove(input_op);
+        }
+      }
+    }
+
+    const timeit::TimePoint after_time = timeit::Clock::now();
+    DebugInfo::operation_render_time(op, after_time - before_time);
+    const bNodeInstanceKey node_instance_key = op->get_node_instance_key();
+    if (context_.get_profiler() && node_instance_key != bke::NODE_INSTANCE_KEY_NONE) {
+      context_.get_profiler()->set_node_evaluation_time(node_instance_key,
+                                                        after_time - before_time);
+    }
+  }
+}
+
 void FullFrameExecutionModel::determine_areas_to_render(NodeOperation *output_op,
                                                         const rcti &output_area)
 {
@@ -211,6 +508,15 @@ void FullFrameExecutionModel::determine_areas_to_render(NodeOperation *output_op
       continue;
     }
 
+    if (!cached_results_.contains(operation)) {
+      if (std::shared_ptr<const MemoryBuffer> result = lookup_cached_result(operation)) {
+        /* The cached result is complete and doesn't need its inputs. */
+        cached_results_.add_new(operation, std::move(result));
+        active_buffers_.register_area(operation, operation->get_canvas());
+        continue;
+      }
+    }
+
     active_buffers_.register_area(operation, render_area);
 
     const int num_inputs = operation->get_number_of_input_sockets();
@@ -235,7 +541,10 @@ void FullFrameExecutionModel::determine_reads(NodeOperation *output_op)
   stack.append(output_op);
   while (stack.size() > 0) {
     NodeOperation *operation = stack.pop_last();
-    const int num_inputs = operation->get_number_of_input_sockets();
+    /* Cached results don't read their inputs. */
+    const int num_inputs = cached_results_.contains(operation) ?
+                               0 :
+                               operation->get_number_of_input_sockets();
     for (int i = 0; i < num_inputs; i++) {
       NodeOperation *input_op = operation->get_input_operation(i);
       if (!active_buffers_.has_registered_reads(input_op)) {
@@ -275,7 +584,9 @@ void FullFrameExecutionModel::get_output_render_area(NodeOperation *output_op, r
 void FullFrameExecutionModel::operation_finished(NodeOperation *operation)
 {
   /* Report inputs reads so that buffers may be freed/reused. */
-  const int num_inputs = operation->get_number_of_input_sockets();
+  const int num_inputs = cached_results_.contains(operation) ?
+                             0 :
+                             operation->get_number_of_input_sockets();
   for (int i = 0; i < num_inputs; i++) {
     active_buffers_.read_finished(operation->get_input_operation(i));
   }
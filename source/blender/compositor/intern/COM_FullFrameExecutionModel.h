@@ -4,6 +4,11 @@
 
 #pragma once
 
+#include <memory>
+
+#include "BLI_map.hh"
+#include "BLI_set.hh"
+#include "BLI_timeit.hh"
 #include "BLI_vector.hh"
 
 #include "COM_Enums.h"
@@ -43,6 +48,12 @@ class FullFrameExecutionModel : public ExecutionModel {
    */
   Vector<eCompositorPriority> priorities_;
 
+  /**
+   * Results of previous executions found in the #ResultCache. Their operations are not rendered,
+   * and neither are their inputs unless read by other operations.
+   */
+  Map<NodeOperation *, std::shared_ptr<const MemoryBuffer>> cached_results_;
+
  public:
   FullFrameExecutionModel(CompositorContext &context,
                           SharedOperationBuffers &shared_buffers,
@@ -64,9 +75,35 @@ class FullFrameExecutionModel : public ExecutionModel {
   Vector<MemoryBuffer *> get_input_buffers(NodeOperation *op, int output_x, int output_y);
   MemoryBuffer *create_operation_buffer(NodeOperation *op, int output_x, int output_y);
   void render_operation(NodeOperation *op);
+  /** Returns the result of given operation from a previous execution, if cached. */
+  std::shared_ptr<const MemoryBuffer> lookup_cached_result(NodeOperation *op);
+  /** Adds the rendered result of given operation to the #ResultCache, when worth it. */
+  void add_cached_result(NodeOperation *op,
+                         const MemoryBuffer &result,
+                         Span<rcti> rendered_areas,
+                         timeit::Nanoseconds render_time);
 
   void operation_finished(NodeOperation *operation);
 
+  /**
+   * Renders given output operation a tile at a time, along with the operations it depends on that
+   * can be tiled, so that their buffers fit in the memory limit. Operations that need global data
+   * are rendered in full beforehand.
+   */
+  void render_output_tiled(NodeOperation *output_op);
+  /**
+   * Returns the operations to render in tiles for given output operation, ordered from inputs to
+   * outputs. The output operation is the last one.
+   */
+  Vector<NodeOperation *> get_tiled_operations(NodeOperation *output_op);
+  /**
+   * Returns the height of the tiles so that the tiled operations buffers fit in the memory limit.
+   */
+  int get_tile_height(Span<NodeOperation *> tiled_ops, const rcti &output_area);
+  void render_tile(Span<NodeOperation *> tiled_ops,
+                   const Set<NodeOperation *> &tiled_ops_set,
+                   const rcti &tile);
+
   /**
    * Calculates given output operation area to be rendered taking into account viewer and render
    * borders.
@@ -0,0 +1,188 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include <algorithm>
+#include <optional>
+
+#include "BLI_array.hh"
+#include "BLI_map.hh"
+#include "BLI_set.hh"
+
+#include "COM_FusedRowOperation.h"
+#include "COM_MixOperation.h"
+#include "COM_MultiThreadedRowOperation.h"
+
+namespace blender::compositor {
+
+FusedRowOperation::FusedRowOperation(Span<MultiThreadedOperation *> steps) : steps_(steps)
+{
+  BLI_assert(steps.size() > 1);
+  for (const int step_index : steps.index_range()) {
+    MultiThreadedOperation *step = steps[step_index];
+    NodeOperationOutput *prev_output = step_index > 0 ?
+                                           steps[step_index - 1]->get_output_socket() :
+                                           nullptr;
+    step_input_indices_.append_as();
+    Vector<int> &input_indices = step_input_indices_.last();
+    for (int i = 0; i < step->get_number_of_input_sockets(); i++) {
+      NodeOperationInput *input = step->get_input_socket(i);
+      if (prev_output && input->get_link() == prev_output) {
+        input_indices.append(-1);
+        /* Only a single input of a step may read the previous step. */
+        prev_output = nullptr;
+        continue;
+      }
+      input_indices.append(get_number_of_input_sockets());
+      add_input_socket(input->get_data_type(), ResizeMode::None);
+    }
+  }
+
+  MultiThreadedOperation *last_step = steps.last();
+  add_output_socket(last_step->get_output_socket()->get_data_type());
+  set_canvas(last_step->get_canvas());
+  flags_.can_be_tiled = true;
+}
+
+FusedRowOperation::~FusedRowOperation()
+{
+  for (MultiThreadedOperation *step : steps_) {
+    delete step;
+  }
+}
+
+bool FusedRowOperation::can_fuse(NodeOperation *operation)
+{
+  /* Only operations with correlated coordinates between inputs and output can be evaluated a row
+   * at a time. */
+  if (!dynamic_cast<MultiThreadedRowOperation *>(operation) &&
+      !dynamic_cast<MixBaseOperation *>(operation))
+  {
+    return false;
+  }
+  const NodeOperationFlags flags = operation->get_flags();
+  return !flags.is_constant_operation && !flags.is_viewer_operation &&
+         !flags.is_preview_operation && operation->get_number_of_output_sockets() == 1;
+}
+
+Vector<Vector<MultiThreadedOperation *>> FusedRowOperation::find_chains(
+    Span<NodeOperation *> operations)
+{
+  /* Number of inputs reading each operation output. */
+  Map<NodeOperationOutput *, int> num_output_users;
+  for (NodeOperation *op : operations) {
+    for (int i = 0; i < op->get_number_of_input_sockets(); i++) {
+      if (NodeOperationOutput *link = op->get_input_socket(i)->get_link()) {
+        num_output_users.add_or_modify(
+            link, [](int *value) { *value = 1; }, [](int *value) { (*value)++; });
+      }
+    }
+  }
+
+  /* Map fusable operations to the fusable operation whose output is only read by them. */
+  Map<NodeOperation *, MultiThreadedOperation *> prev_steps;
+  Set<NodeOperation *> has_next_step;
+  for (NodeOperation *op : operations) {
+    if (!can_fuse(op)) {
+      continue;
+    }
+    for (int i = 0; i < op->get_number_of_input_sockets(); i++) {
+      NodeOperationOutput *link = op->get_input_socket(i)->get_link();
+      if (link == nullptr || num_output_users.lookup(link) != 1) {
+        continue;
+      }
+      NodeOperation *prev_op = &link->get_operation();
+      if (can_fuse(prev_op) && BLI_rcti_compare(&prev_op->get_canvas(), &op->get_canvas())) {
+        prev_steps.add_new(op, static_cast<MultiThreadedOperation *>(prev_op));
+        has_next_step.add_new(prev_op);
+        break;
+      }
+    }
+  }
+
+  /* Walk each chain back from its last step. */
+  Vector<Vector<MultiThreadedOperation *>> chains;
+  for (NodeOperation *op : operations) {
+    if (!prev_steps.contains(op) || has_next_step.contains(op)) {
+      continue;
+    }
+    Vector<MultiThreadedOperation *> chain = {static_cast<MultiThreadedOperation *>(op)};
+    while (MultiThreadedOperation *prev_step = prev_steps.lookup_default(chain.last(), nullptr)) {
+      chain.append(prev_step);
+    }
+    std::reverse(chain.begin(), chain.end());
+    chains.append(std::move(chain));
+  }
+  return chains;
+}
+
+Vector<NodeOperationInput *> FusedRowOperation::get_step_external_inputs() const
+{
+  Vector<NodeOperationInput *> inputs;
+  for (const int step_index : steps_.index_range()) {
+    for (const int i : step_input_indices_[step_index].index_range()) {
+      if (step_input_indices_[step_index][i] != -1) {
+        inputs.append(steps_[step_index]->get_input_socket(i));
+      }
+    }
+  }
+  return inputs;
+}
+
+void FusedRowOperation::init_data()
+{
+  for (MultiThreadedOperation *step : steps_) {
+    step->init_data();
+  }
+}
+
+void FusedRowOperation::init_execution()
+{
+  for (MultiThreadedOperation *step : steps_) {
+    step->init_execution();
+  }
+}
+
+void FusedRowOperation::deinit_execution()
+{
+  for (MultiThreadedOperation *step : steps_) {
+    step->deinit_execution();
+  }
+}
+
+void FusedRowOperation::update_memory_buffer_partial(MemoryBuffer *output,
+                                                     const rcti &area,
+                                                     Span<MemoryBuffer *> inputs)
+{
+  const int width = BLI_rcti_size_x(&area);
+  /* Intermediate rows, alternating between the output of the previous and the current step. */
+  Array<float> rows_data[2] = {Array<float>(width * COM_DATA_TYPE_COLOR_CHANNELS),
+                               Array<float>(width * COM_DATA_TYPE_COLOR_CHANNELS)};
+  std::optional<MemoryBuffer> rows[2];
+
+  Vector<MemoryBuffer *> step_inputs;
+  for (int y = area.ymin; y < area.ymax; y++) {
+    const rcti row_area = {area.xmin, area.xmax, y, y + 1};
+    for (const int step_index : steps_.index_range()) {
+      MultiThreadedOperation *step = steps_[step_index];
+      MemoryBuffer *prev_row = step_index > 0 ? &*rows[(step_index - 1) % 2] : nullptr;
+
+      step_inputs.clear();
+      for (const int input_index : step_input_indices_[step_index]) {
+        step_inputs.append(input_index == -1 ? prev_row : inputs[input_index]);
+      }
+
+      if (step_index == steps_.index_range().last()) {
+        step->update_memory_buffer_partial(output, row_area, step_inputs);
+        break;
+      }
+      const int num_channels = COM_data_type_num_channels(
+          step->get_output_socket()->get_data_type());
+      std::optional<MemoryBuffer> &row = rows[step_index % 2];
+      row.emplace(rows_data[step_index % 2].data(), num_channels, row_area);
+      step->update_memory_buffer_partial(&*row, row_area, step_inputs);
+    }
+  }
+}
+
+}  // namespace blender::compositor
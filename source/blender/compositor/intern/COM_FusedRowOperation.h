@@ -0,0 +1,58 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+#include "COM_MultiThreadedOperation.h"
+
+namespace blender::compositor {
+
+/**
+ * Evaluates a chain of per-pixel operations row by row, so that the intermediate results of the
+ * chain stay in cache instead of being written to full size buffers.
+ *
+ * Each step of the chain is linked to the output of the previous one. The operation takes
+ * ownership of the steps, which are no longer part of the execution system.
+ */
+class FusedRowOperation : public MultiThreadedOperation {
+ private:
+  /** Steps of the chain, from the first to evaluate to the last. */
+  Vector<MultiThreadedOperation *> steps_;
+  /**
+   * For each input socket of each step, the index of the fused operation input it reads from,
+   * or -1 when it reads the output of the previous step.
+   */
+  Vector<Vector<int>> step_input_indices_;
+
+ public:
+  /** \param steps: Chain of fusable operations, each one linked to the previous. */
+  FusedRowOperation(Span<MultiThreadedOperation *> steps);
+  ~FusedRowOperation() override;
+
+  /** Whether the operation can be evaluated as a step of a #FusedRowOperation. */
+  static bool can_fuse(NodeOperation *operation);
+
+  /**
+   * Find the chains of operations to fuse. Each step has the same canvas as the next one and its
+   * output is only read by it. The steps of each chain are ordered from the first to evaluate.
+   */
+  static Vector<Vector<MultiThreadedOperation *>> find_chains(Span<NodeOperation *> operations);
+
+  /**
+   * Input sockets of the steps that are read from outside of the chain, in the same order as
+   * the input sockets of the fused operation.
+   */
+  Vector<NodeOperationInput *> get_step_external_inputs() const;
+
+  void init_data() override;
+  void init_execution() override;
+  void deinit_execution() override;
+
+ protected:
+  void update_memory_buffer_partial(MemoryBuffer *output,
+                                    const rcti &area,
+                                    Span<MemoryBuffer *> inputs) override;
+};
+
+}  // namespace blender::compositor
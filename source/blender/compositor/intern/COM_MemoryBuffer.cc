@@ -4,6 +4,9 @@
 
 #include "COM_MemoryBuffer.h"
 
+#include "BLI_math_half.hh"
+#include "BLI_task.hh"
+
 #include "IMB_colormanagement.hh"
 #include "IMB_imbuf_types.hh"
 
@@ -163,6 +166,37 @@ MemoryBuffer::~MemoryBuffer()
     MEM_freeN(buffer_);
     buffer_ = nullptr;
   }
+  if (half_buffer_) {
+    MEM_freeN(half_buffer_);
+    half_buffer_ = nullptr;
+  }
+}
+
+/* Number of floats converted by each task when changing the storage precision. */
+constexpr int64_t storage_conversion_grain_size = 1 << 16;
+
+void MemoryBuffer::store_as_half_float()
+{
+  BLI_assert(owns_data_ && !is_a_single_elem_ && !is_stored_as_half_float());
+  const int64_t len = buffer_len() * num_channels_;
+  half_buffer_ = (uint16_t *)MEM_malloc_arrayN(len, sizeof(uint16_t), "COM_MemoryBuffer half");
+  threading::parallel_for(IndexRange(len), storage_conversion_grain_size, [&](IndexRange range) {
+    math::float_to_half_array(buffer_ + range.start(), half_buffer_ + range.start(), range.size());
+  });
+  MEM_freeN(buffer_);
+  buffer_ = nullptr;
+}
+
+void MemoryBuffer::restore_float_storage()
+{
+  BLI_assert(is_stored_as_half_float());
+  const int64_t len = buffer_len() * num_channels_;
+  buffer_ = (float *)MEM_mallocN_aligned(sizeof(float) * len, 16, "COM_MemoryBuffer");
+  threading::parallel_for(IndexRange(len), storage_conversion_grain_size, [&](IndexRange range) {
+    math::half_to_float_array(half_buffer_ + range.start(), buffer_ + range.start(), range.size());
+  });
+  MEM_freeN(half_buffer_);
+  half_buffer_ = nullptr;
 }
 
 void MemoryBuffer::copy_from(const MemoryBuffer *src, const rcti &area)
@@ -68,6 +68,11 @@ class MemoryBuffer {
    */
   float *buffer_;
 
+  /**
+   * Buffer data stored with half float precision, see #store_as_half_float.
+   */
+  uint16_t *half_buffer_ = nullptr;
+
   /**
    * \brief the number of channels of a single value in the buffer.
    * For value buffers this is 1, vector 3 and color 4
@@ -429,6 +434,20 @@ class MemoryBuffer {
    */
   MemoryBuffer *inflate() const;
 
+  /**
+   * Store the owned buffer data with half float precision, halving its memory. Elements can't be
+   * accessed until #restore_float_storage is called.
+   */
+  void store_as_half_float();
+  /**
+   * Convert back the buffer data stored by #store_as_half_float, with reduced precision.
+   */
+  void restore_float_storage();
+  bool is_stored_as_half_float() const
+  {
+    return half_buffer_ != nullptr;
+  }
+
   inline void wrap_pixel(int &x,
                          int &y,
                          MemoryBufferExtend extend_x,
@@ -9,6 +9,8 @@
 namespace blender::compositor {
 
 class MultiThreadedOperation : public NodeOperation {
+  friend class FusedRowOperation;
+
  protected:
   /**
    * Number of execution passes.
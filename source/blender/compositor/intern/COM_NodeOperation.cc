@@ -84,6 +84,56 @@ std::optional<NodeOperationHash> NodeOperation::generate_hash()
   return hash;
 }
 
+std::optional<size_t> NodeOperation::generate_content_hash()
+{
+  if (outputs_.size() != 1) {
+    return std::nullopt;
+  }
+
+  size_t hash = get_default_hash(typeid(*this).hash_code(), get_output_socket()->get_data_type());
+  combine_hashes(hash, get_default_hash(canvas_.xmin, canvas_.xmax, canvas_.ymin, canvas_.ymax));
+
+  if (flags_.is_constant_operation) {
+    const float *elem = static_cast<ConstantOperation *>(this)->get_constant_elem();
+    const int num_channels = COM_data_type_num_channels(get_output_socket()->get_data_type());
+    for (const int i : IndexRange(num_channels)) {
+      combine_hashes(hash, get_default_hash(elem[i]));
+    }
+    return hash;
+  }
+
+  if (!node_settings_hash_) {
+    return std::nullopt;
+  }
+  combine_hashes(hash, *node_settings_hash_);
+
+  /* Parameters set by the node or the operations builder, when hashed by the subclass. */
+  params_hash_ = 0;
+  is_hash_output_params_implemented_ = true;
+  hash_output_params();
+  if (is_hash_output_params_implemented_) {
+    combine_hashes(hash, params_hash_);
+  }
+
+  if (!hash_external_data(hash)) {
+    return std::nullopt;
+  }
+
+  for (NodeOperationInput &socket : inputs_) {
+    if (!socket.is_connected()) {
+      combine_hashes(hash, 0);
+      continue;
+    }
+    const std::optional<size_t> input_hash = socket.get_link()->get_operation().content_hash_;
+    if (!input_hash) {
+      return std::nullopt;
+    }
+    combine_hashes(hash, *input_hash);
+  }
+
+  return hash;
+}
+
 NodeOperationOutput *NodeOperation::get_output_socket(uint index)
 {
   return &outputs_[index];
@@ -223,6 +273,16 @@ void NodeOperation::render(MemoryBuffer *output_buf,
   render_full_frame(output_buf, areas, inputs_bufs);
 }
 
+void NodeOperation::render_tile(MemoryBuffer *output_buf,
+                                Span<rcti> areas,
+                                Span<MemoryBuffer *> inputs_bufs)
+{
+  BLI_assert(flags_.can_be_tiled);
+  for (const rcti &area : areas) {
+    update_memory_buffer(output_buf, area, inputs_bufs);
+  }
+}
+
 void NodeOperation::render_full_frame(MemoryBuffer *output_buf,
                                       Span<rcti> areas,
                                       Span<MemoryBuffer *> inputs_bufs)
@@ -317,6 +377,9 @@ std::ostream &operator<<(std::ostream &os, const NodeOperationFlags &node_operat
   if (node_operation_flags.can_be_constant) {
     os << "can_be_constant,";
   }
+  if (node_operation_flags.can_be_tiled) {
+    os << "can_be_tiled,";
+  }
 
   return os;
 }
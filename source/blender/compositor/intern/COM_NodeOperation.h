@@ -206,6 +206,12 @@ struct NodeOperationFlags {
    */
   bool can_be_constant : 1;
 
+  /**
+   * Whether operation only reads its inputs within its areas of interest and can render any area
+   * independently. Such operations may be rendered a tile at a time to limit memory usage.
+   */
+  bool can_be_tiled : 1;
+
   NodeOperationFlags()
   {
     use_render_border = false;
@@ -217,6 +223,7 @@ struct NodeOperationFlags {
     use_datatype_conversion = true;
     is_constant_operation = false;
     can_be_constant = false;
+    can_be_tiled = false;
   }
 };
 
@@ -274,6 +281,11 @@ class NodeOperation {
   size_t params_hash_;
   bool is_hash_output_params_implemented_;
 
+  /** Hash of the settings of the node the operation was created from, see #ResultCache. */
+  std::optional<size_t> node_settings_hash_;
+  /** Hash identifying the operation result across executions, see #ResultCache. */
+  std::optional<size_t> content_hash_;
+
   /**
    * \brief the index of the input socket that will be used to determine the canvas
    */
@@ -345,6 +357,32 @@ class NodeOperation {
    */
   std::optional<NodeOperationHash> generate_hash();
 
+  /**
+   * Set the hash of the settings of the node the operation was created from, combined with the
+   * order of the operation among the ones created by the node. #std::nullopt when the node
+   * settings can't be hashed.
+   */
+  void set_node_settings_hash(const std::optional<size_t> hash)
+  {
+    node_settings_hash_ = hash;
+  }
+
+  /**
+   * Generate a hash that identifies the operation result across executions, from its type,
+   * canvas, node settings, external data and the content hashes of its linked inputs, which must
+   * have been set beforehand. Returns #std::nullopt when the result can't be identified.
+   */
+  std::optional<size_t> generate_content_hash();
+
+  void set_content_hash(const std::optional<size_t> hash)
+  {
+    content_hash_ = hash;
+  }
+  std::optional<size_t> get_content_hash() const
+  {
+    return content_hash_;
+  }
+
   unsigned int get_number_of_input_sockets() const
   {
     return inputs_.size();
@@ -493,6 +531,13 @@ class NodeOperation {
    */
   void render(MemoryBuffer *output_buf, Span<rcti> areas, Span<MemoryBuffer *> inputs_bufs);
 
+  /**
+   * Renders given areas like #render, but without initializing and deinitializing the execution,
+   * so that the operation can be rendered a tile at a time between a single #init_execution and
+   * #deinit_execution. Only valid for operations with the #NodeOperationFlags.can_be_tiled flag.
+   */
+  void render_tile(MemoryBuffer *output_buf, Span<rcti> areas, Span<MemoryBuffer *> inputs_bufs);
+
   /**
    * Executes operation updating output memory buffer. Single-threaded calls.
    */
@@ -529,6 +574,14 @@ class NodeOperation {
     is_hash_output_params_implemented_ = false;
   }
 
+  /* Overridden by subclasses reading data from outside of the node tree, like render results, to
+   * hash it into the content hash. Returns false when the data can't be hashed, in which case the
+   * operation result can't be cached. */
+  virtual bool hash_external_data(size_t & /*r_hash*/)
+  {
+    return true;
+  }
+
   static void combine_hashes(size_t &combined, size_t other)
   {
     combined = BLI_ghashutil_combine_hash(combined, other);
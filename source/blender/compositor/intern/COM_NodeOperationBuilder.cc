@@ -5,13 +5,16 @@
 #include <set>
 
 #include "BLI_multi_value_map.hh"
+#include "BLI_set.hh"
 
 #include "BKE_node_runtime.hh"
 
 #include "COM_Converter.h"
 #include "COM_Debug.h"
+#include "COM_FusedRowOperation.h"
 
 #include "COM_PreviewOperation.h"
+#include "COM_ResultCache.h"
 #include "COM_SetColorOperation.h"
 #include "COM_SetValueOperation.h"
 #include "COM_SetVectorOperation.h"
@@ -25,7 +28,11 @@ namespace blender::compositor {
 NodeOperationBuilder::NodeOperationBuilder(const CompositorContext *context,
                                            bNodeTree *b_nodetree,
                                            ExecutionSystem *system)
-    : context_(context), exec_system_(system), current_node_(nullptr), active_viewer_(nullptr)
+    : context_(context),
+      exec_system_(system),
+      current_node_(nullptr),
+      current_node_operations_num_(0),
+      active_viewer_(nullptr)
 {
   graph_.from_bNodeTree(*context, b_nodetree);
 }
@@ -35,8 +42,14 @@ void NodeOperationBuilder::convert_to_operations(ExecutionSystem *system)
   /* interface handle for nodes */
   NodeConverter converter(this);
 
+  const size_t context_hash = ResultCache::hash_context(*context_);
   for (Node *node : graph_.nodes()) {
     current_node_ = node;
+    current_node_operations_num_ = 0;
+    current_node_settings_hash_ = ResultCache::hash_node_settings(*node->get_bnode());
+    if (current_node_settings_hash_) {
+      current_node_settings_hash_ = get_default_hash(*current_node_settings_hash_, context_hash);
+    }
 
     DebugInfo::node_to_operations(node);
     node->convert_to_operations(converter, *context_);
@@ -90,6 +103,10 @@ void NodeOperationBuilder::convert_to_operations(ExecutionSystem *system)
   save_graphviz("compositor_prior_merging");
   merge_equal_operations();
 
+  compute_content_hashes();
+
+  fuse_row_operations();
+
   /* links not available from here on */
   /* XXX make links_ a local variable to avoid confusion! */
   links_.clear();
@@ -110,6 +127,18 @@ void NodeOperationBuilder::add_operation(NodeOperation *operation)
   if (current_node_) {
     operation->set_name(current_node_->get_bnode()->name);
     operation->set_node_instance_key(current_node_->get_instance_key());
+    /* The operations a node converts to only depend on its settings, so the order identifies
+     * them. */
+    if (current_node_settings_hash_) {
+      operation->set_node_settings_hash(
+          get_default_hash(*current_node_settings_hash_, current_node_operations_num_));
+    }
+    current_node_operations_num_++;
+  }
+  else {
+    /* Operations added by the builder, like conversions, only depend on their type, canvas and
+     * inputs. */
+    operation->set_node_settings_hash(0);
   }
   operation->set_execution_system(exec_system_);
 }
@@ -493,6 +522,55 @@ void NodeOperationBuilder::merge_equal_operations(NodeOperation *from, NodeOpera
   delete from;
 }
 
+void NodeOperationBuilder::fuse_row_operations()
+{
+  const Vector<Vector<MultiThreadedOperation *>> chains = FusedRowOperation::find_chains(
+      operations_);
+  for (Span<MultiThreadedOperation *> chain : chains) {
+    FusedRowOperation *fused_op = new FusedRowOperation(chain);
+
+    const Vector<NodeOperationInput *> step_inputs = fused_op->get_step_external_inputs();
+    for (const int i : step_inputs.index_range()) {
+      NodeOperationOutput *from = step_inputs[i]->get_link();
+      BLI_assert(from != nullptr);
+      remove_input_link(step_inputs[i]);
+      add_link(from, fused_op->get_input_socket(i));
+    }
+
+    /* The fused operation replaces the last step, the other steps are only read by the chain. */
+    for (int i = chain.size() - 1; i >= 0; i--) {
+      unlink_inputs_and_relink_outputs(chain[i], fused_op);
+      operations_.remove_first_occurrence_and_reorder(chain[i]);
+    }
+    add_operation(fused_op);
+    fused_op->set_name(chain.last()->get_name());
+    fused_op->set_node_instance_key(chain.last()->get_node_instance_key());
+    fused_op->set_content_hash(chain.last()->get_content_hash());
+  }
+}
+
+static void compute_content_hash_recursive(NodeOperation *op, Set<NodeOperation *> &visited)
+{
+  if (!visited.add(op)) {
+    return;
+  }
+  for (int i = 0; i < op->get_number_of_input_sockets(); i++) {
+    NodeOperationOutput *link = op->get_input_socket(i)->get_link();
+    if (link) {
+      compute_content_hash_recursive(&link->get_operation(), visited);
+    }
+  }
+  op->set_content_hash(op->generate_content_hash());
+}
+
+void NodeOperationBuilder::compute_content_hashes()
+{
+  Set<NodeOperation *> visited;
+  for (NodeOperation *op : operations_) {
+    compute_content_hash_recursive(op, visited);
+  }
+}
+
 Vector<NodeOperationInput *> NodeOperationBuilder::cache_output_links(
     NodeOperationOutput *output) const
 {
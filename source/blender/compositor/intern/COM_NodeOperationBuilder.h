@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <optional>
+
 #include "BLI_map.hh"
 #include "BLI_vector.hh"
 
@@ -60,6 +62,10 @@ class NodeOperationBuilder {
   Map<NodeOutput *, NodeOperationOutput *> output_map_;
 
   Node *current_node_;
+  /** Hash of the current node settings, see #NodeOperation::set_node_settings_hash. */
+  std::optional<size_t> current_node_settings_hash_;
+  /** Number of operations added by the current node so far. */
+  int current_node_operations_num_;
 
   /**
    * Operation that will be writing to the viewer image
@@ -143,6 +149,13 @@ class NodeOperationBuilder {
   /** Merge operations with same type, inputs and parameters that produce the same result. */
   void merge_equal_operations();
   void merge_equal_operations(NodeOperation *from, NodeOperation *into);
+  /**
+   * Replace chains of per-pixel operations with operations evaluating the whole chain row by row,
+   * to avoid writing the intermediate results to full size buffers.
+   */
+  void fuse_row_operations();
+  /** Compute the hashes identifying the operations results across executions. */
+  void compute_content_hashes();
   void save_graphviz(StringRefNull name = "");
 #ifdef WITH_CXX_GUARDEDALLOC
   MEM_CXX_CLASS_ALLOC_FUNCS("COM:NodeCompilerImpl")
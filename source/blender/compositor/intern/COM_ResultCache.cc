@@ -0,0 +1,189 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include <mutex>
+
+#include "BLI_hash_mm2a.hh"
+#include "BLI_listbase.h"
+#include "BLI_map.hh"
+
+#include "BKE_node.hh"
+
+#include "DNA_genfile.h"
+#include "DNA_node_types.h"
+#include "DNA_sdna_types.h"
+#include "DNA_userdef_types.h"
+
+#include "COM_CompositorContext.h"
+#include "COM_MemoryBuffer.h"
+#include "COM_ResultCache.h"
+
+namespace blender::compositor {
+
+struct CachedResult {
+  std::shared_ptr<const MemoryBuffer> buffer;
+  size_t size;
+  /** Value of the use counter when last looked up or added, to find the least recently used. */
+  uint64_t last_use;
+};
+
+static struct {
+  std::mutex mutex;
+  Map<size_t, CachedResult> results;
+  size_t size = 0;
+  uint64_t use_counter = 0;
+} g_result_cache;
+
+static size_t get_memory_limit()
+{
+  /* Leave most of the memory cache limit to the other caches, like the sequencer one. */
+  return size_t(U.memcachelimit) * 1024 * 1024 / 4;
+}
+
+static size_t get_buffer_size(const MemoryBuffer &buffer)
+{
+  return size_t(buffer.get_width()) * buffer.get_height() * buffer.get_num_channels() *
+         sizeof(float);
+}
+
+static void free_least_recently_used(const size_t max_size)
+{
+  while (g_result_cache.size > max_size && !g_result_cache.results.is_empty()) {
+    const size_t *lru_hash = nullptr;
+    uint64_t lru_use = UINT64_MAX;
+    for (const auto item : g_result_cache.results.items()) {
+      if (item.value.last_use < lru_use) {
+        lru_hash = &item.key;
+        lru_use = item.value.last_use;
+      }
+    }
+    const size_t hash = *lru_hash;
+    g_result_cache.size -= g_result_cache.results.lookup(hash).size;
+    g_result_cache.results.remove(hash);
+  }
+}
+
+std::shared_ptr<const MemoryBuffer> ResultCache::lookup(const size_t content_hash)
+{
+  std::scoped_lock lock(g_result_cache.mutex);
+  CachedResult *result = g_result_cache.results.lookup_ptr(content_hash);
+  if (result == nullptr) {
+    return nullptr;
+  }
+  result->last_use = ++g_result_cache.use_counter;
+  return result->buffer;
+}
+
+void ResultCache::add(const size_t content_hash, const MemoryBuffer &result)
+{
+  const size_t size = get_buffer_size(result);
+  const size_t memory_limit = get_memory_limit();
+  if (size > memory_limit) {
+    return;
+  }
+
+  /* Copy outside of the lock, the operation buffer may be big. */
+  std::shared_ptr<const MemoryBuffer> buffer = std::make_shared<const MemoryBuffer>(result);
+
+  std::scoped_lock lock(g_result_cache.mutex);
+  if (g_result_cache.results.contains(content_hash)) {
+    return;
+  }
+  free_least_recently_used(memory_limit - size);
+  g_result_cache.results.add_new(content_hash,
+                                 {std::move(buffer), size, ++g_result_cache.use_counter});
+  g_result_cache.size += size;
+}
+
+void ResultCache::clear()
+{
+  std::scoped_lock lock(g_result_cache.mutex);
+  g_result_cache.results.clear();
+  g_result_cache.size = 0;
+}
+
+/** Whether the DNA struct has pointers, directly or in nested structs. */
+static bool dna_struct_has_pointers(const SDNA *sdna, const int struct_nr)
+{
+  const SDNA_Struct *sdna_struct = sdna->structs[struct_nr];
+  for (const int i : IndexRange(sdna_struct->members_len)) {
+    const SDNA_StructMember &member = sdna_struct->members[i];
+    const char *member_name = sdna->names[member.name];
+    if (ELEM(member_name[0], '*', '(')) {
+      return true;
+    }
+    const int member_struct_nr = DNA_struct_find_without_alias(sdna, sdna->types[member.type]);
+    if (member_struct_nr != -1 && dna_struct_has_pointers(sdna, member_struct_nr)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static size_t hash_bytes(const size_t hash, const void *data, const size_t size)
+{
+  return get_default_hash(hash, BLI_hash_mm2(static_cast<const uchar *>(data), size, 0));
+}
+
+std::optional<size_t> ResultCache::hash_node_settings(const bNode &node)
+{
+  /* Render layers, image and defocus operations hash the data they read from the data-block
+   * themselves. */
+  if (node.id != nullptr && !ELEM(node.type, CMP_NODE_R_LAYERS, CMP_NODE_IMAGE, CMP_NODE_DEFOCUS))
+  {
+    return std::nullopt;
+  }
+
+  size_t hash = get_default_hash(node.type, node.custom1, node.custom2);
+  hash = get_default_hash(hash, node.custom3, node.custom4);
+
+  /* The image user is hashed by the image operations, its scene pointer isn't read. */
+  if (node.storage && node.type != CMP_NODE_IMAGE) {
+    const SDNA *sdna = DNA_sdna_current_get();
+    const int struct_nr = DNA_struct_find_without_alias(sdna, node.typeinfo->storagename);
+    if (struct_nr == -1 || dna_struct_has_pointers(sdna, struct_nr)) {
+      return std::nullopt;
+    }
+    hash = hash_bytes(hash, node.storage, sdna->types_size[sdna->structs[struct_nr]->type]);
+  }
+
+  /* Some nodes read their unlinked inputs values directly. */
+  LISTBASE_FOREACH (const bNodeSocket *, socket, &node.inputs) {
+    switch (socket->type) {
+      case SOCK_FLOAT:
+        hash = hash_bytes(hash, socket->default_value, sizeof(bNodeSocketValueFloat));
+        break;
+      case SOCK_INT:
+        hash = hash_bytes(hash, socket->default_value, sizeof(bNodeSocketValueInt));
+        break;
+      case SOCK_BOOLEAN:
+        hash = hash_bytes(hash, socket->default_value, sizeof(bNodeSocketValueBoolean));
+        break;
+      case SOCK_VECTOR:
+        hash = hash_bytes(hash, socket->default_value, sizeof(bNodeSocketValueVector));
+        break;
+      case SOCK_RGBA:
+        hash = hash_bytes(hash, socket->default_value, sizeof(bNodeSocketValueRGBA));
+        break;
+      default:
+        break;
+    }
+  }
+  return hash;
+}
+
+size_t ResultCache::hash_context(const CompositorContext &context)
+{
+  const RenderData *rd = context.get_render_data();
+  size_t hash = get_default_hash(StringRef(context.get_view_name() ? context.get_view_name() : ""),
+                                 context.is_rendering());
+  if (rd) {
+    hash = get_default_hash(hash, context.get_framenumber(), rd->xsch, rd->ysch);
+    hash = get_default_hash(hash, rd->size, rd->frs_sec, rd->frs_sec_base);
+    hash = get_default_hash(hash, rd->compositor_precision);
+  }
+  return hash;
+}
+
+}  // namespace blender::compositor
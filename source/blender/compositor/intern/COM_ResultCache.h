@@ -0,0 +1,56 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+#include <memory>
+#include <optional>
+
+struct bNode;
+
+namespace blender::compositor {
+
+class CompositorContext;
+class MemoryBuffer;
+
+/**
+ * Keeps operations results across executions of the compositor, identified by their content hash
+ * (see #NodeOperation::generate_content_hash). When a node changes, only the operations depending
+ * on it get a new hash and need to be rendered again.
+ *
+ * The least recently used results are freed when the cache gets over its memory limit, which is
+ * a fraction of the user preferences memory cache limit.
+ */
+struct ResultCache {
+  /**
+   * Get the cached result with given content hash, or null when there is none. The result stays
+   * valid while referenced, even if freed from the cache.
+   */
+  static std::shared_ptr<const MemoryBuffer> lookup(size_t content_hash);
+
+  /**
+   * Add a copy of the result of an operation with given content hash, freeing the least recently
+   * used results when over the memory limit.
+   */
+  static void add(size_t content_hash, const MemoryBuffer &result);
+
+  /**
+   * Free all cached results.
+   */
+  static void clear();
+
+  /**
+   * Hash the settings of the node that affect the operations it converts to, see
+   * #NodeOperation::set_node_settings_hash. Returns #std::nullopt when the node depends on data
+   * that can't be hashed, like data-blocks or storage with pointers.
+   */
+  static std::optional<size_t> hash_node_settings(const bNode &node);
+
+  /**
+   * Hash the context settings that may affect the result of any operation.
+   */
+  static size_t hash_context(const CompositorContext &context);
+};
+
+}  // namespace blender::compositor
@@ -5,6 +5,8 @@
 #include "COM_SharedOperationBuffers.h"
 #include "COM_NodeOperation.h"
 
+#include "BLI_set.hh"
+
 namespace blender::compositor {
 
 SharedOperationBuffers::BufferData::BufferData()
@@ -46,6 +48,11 @@ void SharedOperationBuffers::register_read(NodeOperation *read_op)
   get_buffer_data(read_op).registered_reads++;
 }
 
+int SharedOperationBuffers::get_num_registered_reads(NodeOperation *op)
+{
+  return get_buffer_data(op).registered_reads;
+}
+
 Vector<rcti> SharedOperationBuffers::get_areas_to_render(NodeOperation *op,
                                                          const int offset_x,
                                                          const int offset_y)
@@ -77,7 +84,11 @@ void SharedOperationBuffers::set_rendered_buffer(NodeOperation *op,
 MemoryBuffer *SharedOperationBuffers::get_rendered_buffer(NodeOperation *op)
 {
   BLI_assert(is_operation_rendered(op));
-  return get_buffer_data(op).buffer.get();
+  MemoryBuffer *buffer = get_buffer_data(op).buffer.get();
+  if (buffer && buffer->is_stored_as_half_float()) {
+    buffer->restore_float_storage();
+  }
+  return buffer;
 }
 
 void SharedOperationBuffers::read_finished(NodeOperation *read_op)
@@ -91,4 +102,22 @@ void SharedOperationBuffers::read_finished(NodeOperation *read_op)
   }
 }
 
+void SharedOperationBuffers::store_as_half_float_except_inputs(NodeOperation *op)
+{
+  Set<NodeOperation *> inputs;
+  for (int i = 0; i < op->get_number_of_input_sockets(); i++) {
+    inputs.add(op->get_input_operation(i));
+  }
+
+  for (auto item : buffers_.items()) {
+    MemoryBuffer *buffer = item.value.buffer.get();
+    if (buffer == nullptr || inputs.contains(item.key) || buffer->is_a_single_elem() ||
+        buffer->is_stored_as_half_float() || buffer->get_width() * buffer->get_height() == 0)
+    {
+      continue;
+    }
+    buffer->store_as_half_float();
+  }
+}
+
 }  // namespace blender::compositor
@@ -54,6 +54,10 @@ class SharedOperationBuffers {
    * Registers an operation read (other operation depends on given operation).
    */
   void register_read(NodeOperation *read_op);
+  /**
+   * Number of registered reads of given operation.
+   */
+  int get_num_registered_reads(NodeOperation *op);
 
   /**
    * Get registered areas given operation needs to render.
@@ -68,7 +72,8 @@ class SharedOperationBuffers {
    */
   void set_rendered_buffer(NodeOperation *op, std::unique_ptr<MemoryBuffer> buffer);
   /**
-   * Get given operation rendered buffer.
+   * Get given operation rendered buffer. Restores its float storage if it was stored with half
+   * float precision.
    */
   MemoryBuffer *get_rendered_buffer(NodeOperation *op);
 
@@ -78,6 +83,12 @@ class SharedOperationBuffers {
    */
   void read_finished(NodeOperation *read_op);
 
+  /**
+   * Store rendered buffers with half float precision until they are read again, except the ones
+   * read by given operation.
+   */
+  void store_as_half_float_except_inputs(NodeOperation *op);
+
  private:
   BufferData &get_buffer_data(NodeOperation *op);
 
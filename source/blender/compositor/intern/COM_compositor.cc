@@ -11,6 +11,7 @@
 #include "BKE_scene.hh"
 
 #include "COM_ExecutionSystem.h"
+#include "COM_ResultCache.h"
 #include "COM_WorkScheduler.h"
 #include "COM_compositor.hh"
 
@@ -103,6 +104,7 @@ void COM_deinitialize()
   if (g_compositor.is_initialized) {
     BLI_mutex_lock(&g_compositor.mutex);
     blender::compositor::WorkScheduler::deinitialize();
+    blender::compositor::ResultCache::clear();
     g_compositor.is_initialized = false;
     BLI_mutex_unlock(&g_compositor.mutex);
     BLI_mutex_end(&g_compositor.mutex);
@@ -7,6 +7,7 @@
 
 #include "COM_BokehBlurOperation.h"
 #include "COM_ConstantOperation.h"
+#include "COM_FFTConvolutionAlgorithm.h"
 
 namespace blender::compositor {
 
@@ -29,6 +30,7 @@ BokehBlurOperation::BokehBlurOperation()
   sizeavailable_ = false;
 
   extend_bounds_ = false;
+  is_fft_convolved_ = false;
 }
 
 void BokehBlurOperation::init_data()
@@ -96,6 +98,50 @@ void BokehBlurOperation::get_area_of_interest(const int input_idx,
   }
 }
 
+MemoryBuffer BokehBlurOperation::compute_kernel(const MemoryBuffer &bokeh, const int radius) const
+{
+  const int size = radius * 2 + 1;
+  rcti rect;
+  BLI_rcti_init(&rect, 0, size, 0, size);
+  MemoryBuffer kernel(DataType::Color, rect);
+
+  /* Same weights as the direct convolution in #update_memory_buffer_partial. */
+  const int2 bokeh_size = int2(bokeh.get_width(), bokeh.get_height());
+  for (const int y : IndexRange(size)) {
+    for (const int x : IndexRange(size)) {
+      const float2 normalized_texel = (float2(x, y) + 0.5f) / float(size);
+      const float2 weight_texel = (1.0f - normalized_texel) * float2(bokeh_size - 1);
+      copy_v4_v4(kernel.get_elem(x, y), bokeh.get_elem(int(weight_texel.x), int(weight_texel.y)));
+    }
+  }
+  return kernel;
+}
+
+void BokehBlurOperation::update_memory_buffer_started(MemoryBuffer *output,
+                                                      const rcti &area,
+                                                      Span<MemoryBuffer *> inputs)
+{
+  const float max_dim = std::max(this->get_width(), this->get_height());
+  const int radius = size_ * max_dim / 100.0f;
+  const int kernel_size = radius * 2 + 1;
+
+  /* Large kernels are convolved in the frequency domain, the partial updates then only normalize
+   * the result and handle the bounding box. */
+  is_fft_convolved_ = false;
+  if (!use_fft_convolution(int2(kernel_size)) || inputs[IMAGE_INPUT_INDEX]->is_a_single_elem()) {
+    return;
+  }
+
+  const MemoryBuffer kernel = compute_kernel(*inputs[BOKEH_INPUT_INDEX], radius);
+  weights_sum_ = float4(0.0f);
+  for (const int y : IndexRange(kernel_size)) {
+    for (const int x : IndexRange(kernel_size)) {
+      weights_sum_ += float4(kernel.get_elem(x, y));
+    }
+  }
+  is_fft_convolved_ = fft_convolve(*inputs[IMAGE_INPUT_INDEX], kernel, *output, area);
+}
+
 void BokehBlurOperation::update_memory_buffer_partial(MemoryBuffer *output,
                                                       const rcti &area,
                                                       Span<MemoryBuffer *> inputs)
@@ -117,6 +163,11 @@ void BokehBlurOperation::update_memory_buffer_partial(MemoryBuffer *output,
       continue;
     }
 
+    if (is_fft_convolved_) {
+      copy_v4_v4(it.out, math::safe_divide(float4(it.out), weights_sum_));
+      continue;
+    }
+
     float4 accumulated_color = float4(0.0f);
     float4 accumulated_weight = float4(0.0f);
     for (int yi = -radius; yi <= radius; ++yi) {
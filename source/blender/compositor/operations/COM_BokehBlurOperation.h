@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include "BLI_math_vector_types.hh"
+
 #include "COM_MultiThreadedOperation.h"
 
 namespace blender::compositor {
@@ -16,6 +18,14 @@ class BokehBlurOperation : public MultiThreadedOperation {
 
   bool extend_bounds_;
 
+  /** Whether the image was convolved in the frequency domain for the current area. */
+  bool is_fft_convolved_;
+  /** Sum of the bokeh weights of each channel, used to normalize the convolved image. */
+  float4 weights_sum_;
+
+  /** Bokeh weights for each pixel of the blur kernel, which has a size of twice the radius. */
+  MemoryBuffer compute_kernel(const MemoryBuffer &bokeh, int radius) const;
+
  public:
   BokehBlurOperation();
 
@@ -35,6 +45,9 @@ class BokehBlurOperation : public MultiThreadedOperation {
   void determine_canvas(const rcti &preferred_area, rcti &r_area) override;
 
   void get_area_of_interest(int input_idx, const rcti &output_area, rcti &r_input_area) override;
+  void update_memory_buffer_started(MemoryBuffer *output,
+                                    const rcti &area,
+                                    Span<MemoryBuffer *> inputs) override;
   void update_memory_buffer_partial(MemoryBuffer *output,
                                     const rcti &area,
                                     Span<MemoryBuffer *> inputs) override;
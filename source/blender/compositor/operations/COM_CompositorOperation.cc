@@ -32,6 +32,7 @@ CompositorOperation::CompositorOperation()
   view_name_ = nullptr;
 
   flags_.use_render_border = true;
+  flags_.can_be_tiled = true;
 }
 
 void CompositorOperation::init_execution()
@@ -74,6 +74,16 @@ void ConvertDepthToRadiusOperation::update_memory_buffer_partial(MemoryBuffer *o
   }
 }
 
+bool ConvertDepthToRadiusOperation::hash_external_data(size_t &r_hash)
+{
+  combine_hashes(r_hash, get_default_hash(get_focal_length(), compute_focus_distance()));
+  if (const Camera *camera = get_camera()) {
+    combine_hashes(r_hash,
+                   get_default_hash(int(camera->sensor_fit), camera->sensor_x, camera->sensor_y));
+  }
+  return true;
+}
+
 /* Computes the maximum possible defocus radius in pixels. */
 float ConvertDepthToRadiusOperation::compute_maximum_defocus_radius() const
 {
@@ -55,6 +55,13 @@ class ConvertDepthToRadiusOperation : public MultiThreadedOperation {
                                     const rcti &area,
                                     Span<MemoryBuffer *> inputs) override;
 
+ protected:
+  /**
+   * Hash the parameters of the scene camera. The canvas of the image, which defines the pixels
+   * per meter, is part of the hash of the input.
+   */
+  bool hash_external_data(size_t &r_hash) override;
+
  private:
   float compute_maximum_defocus_radius() const;
   float compute_maximum_diameter_of_circle_of_confusion() const;
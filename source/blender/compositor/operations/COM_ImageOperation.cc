@@ -63,6 +63,24 @@ void BaseImageOperation::deinit_execution()
   BKE_image_release_ibuf(image_, buffer_, nullptr);
 }
 
+bool BaseImageOperation::hash_external_data(size_t &r_hash)
+{
+  if (image_ == nullptr) {
+    return true;
+  }
+  /* Render results and viewer images are written without being tagged as updated. */
+  if (!ELEM(image_->type, IMA_TYPE_IMAGE, IMA_TYPE_MULTILAYER, IMA_TYPE_UV_TEST)) {
+    return false;
+  }
+
+  combine_hashes(r_hash, get_default_hash(image_->id.session_uid, image_->runtime.update_count));
+  combine_hashes(r_hash,
+                 get_default_hash(image_user_.framenr, image_user_.layer, image_user_.pass));
+  combine_hashes(r_hash,
+                 get_default_hash(image_user_.multi_index, image_user_.view, image_user_.tile));
+  return true;
+}
+
 void BaseImageOperation::determine_canvas(const rcti & /*preferred_area*/, rcti &r_area)
 {
   ImBuf *stackbuf = get_im_buf();
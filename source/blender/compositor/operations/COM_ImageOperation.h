@@ -40,6 +40,11 @@ class BaseImageOperation : public MultiThreadedOperation {
 
   virtual ImBuf *get_im_buf();
 
+  /**
+   * Hash the image, its update counter and the frame, layer and view of the image user.
+   */
+  bool hash_external_data(size_t &r_hash) override;
+
  public:
   void init_execution() override;
   void deinit_execution() override;
@@ -26,6 +26,15 @@ ImBuf *MultilayerBaseOperation::get_im_buf()
   return ibuf;
 }
 
+bool MultilayerBaseOperation::hash_external_data(size_t &r_hash)
+{
+  if (!BaseImageOperation::hash_external_data(r_hash)) {
+    return false;
+  }
+  combine_hashes(r_hash, get_default_hash(pass_name_));
+  return true;
+}
+
 void MultilayerBaseOperation::update_memory_buffer_partial(MemoryBuffer *output,
                                                            const rcti &area,
                                                            Span<MemoryBuffer *> /*inputs*/)
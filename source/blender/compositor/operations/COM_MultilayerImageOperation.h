@@ -18,6 +18,7 @@ class MultilayerBaseOperation : public BaseImageOperation {
   std::string pass_name_;
 
   ImBuf *get_im_buf() override;
+  bool hash_external_data(size_t &r_hash) override;
 
  public:
   MultilayerBaseOperation() = default;
@@ -7,6 +7,7 @@
 #include "BLI_math_interp.hh"
 #include "BLI_string.h"
 
+#include "BKE_global.hh"
 #include "BKE_image.h"
 
 namespace blender::compositor {
@@ -17,6 +18,8 @@ RenderLayersProg::RenderLayersProg(const char *pass_name, DataType type, int ele
     : pass_name_(pass_name)
 {
   this->set_scene(nullptr);
+  layer_id_ = 0;
+  view_name_ = nullptr;
   input_buffer_ = nullptr;
   elementsize_ = elementsize;
   rd_ = nullptr;
@@ -90,6 +93,35 @@ void RenderLayersProg::determine_canvas(const rcti & /*preferred_area*/, rcti &r
   }
 }
 
+bool RenderLayersProg::hash_external_data(size_t &r_hash)
+{
+  /* The render result is being written while rendering. */
+  if (G.is_rendering) {
+    return false;
+  }
+
+  Scene *scene = this->get_scene();
+  Render *re = (scene) ? RE_GetSceneRender(scene) : nullptr;
+  if (re == nullptr) {
+    return false;
+  }
+
+  RenderResult *rr = RE_AcquireResultRead(re);
+  if (rr) {
+    combine_hashes(r_hash, hash_render_result(*rr));
+  }
+  RE_ReleaseResult(re);
+
+  return rr != nullptr;
+}
+
+size_t RenderLayersProg::hash_render_result(const RenderResult &render_result) const
+{
+  size_t hash = get_default_hash(render_result.session_uid, layer_id_);
+  combine_hashes(hash, get_default_hash(pass_name_, StringRef(view_name_ ? view_name_ : "")));
+  return hash;
+}
+
 std::unique_ptr<MetaData> RenderLayersProg::get_meta_data()
 {
   Scene *scene = this->get_scene();
@@ -69,6 +69,11 @@ class RenderLayersProg : public MultiThreadedOperation {
     return input_buffer_;
   }
 
+  /**
+   * Hash the render result of the scene, see #hash_render_result.
+   */
+  bool hash_external_data(size_t &r_hash) override;
+
  public:
   /**
    * Constructor
@@ -110,6 +115,12 @@ class RenderLayersProg : public MultiThreadedOperation {
   void init_execution() override;
   void deinit_execution() override;
 
+  /**
+   * Hash identifying the pass read by the operation from the given render result. Each new
+   * render result gets a new hash.
+   */
+  size_t hash_render_result(const RenderResult &render_result) const;
+
   std::unique_ptr<MetaData> get_meta_data() override;
 
   virtual void update_memory_buffer_partial(MemoryBuffer *output,
@@ -0,0 +1,135 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BLI_rand.hh"
+#include "BLI_rect.h"
+
+#include "COM_FFTConvolutionAlgorithm.h"
+
+namespace blender::compositor::tests {
+
+struct FFTConvolutionParams {
+  /* Size of the input image, which starts at the origin. */
+  int2 image_size;
+  /* Size of the kernel, which is odd like the kernels of the compositor operations. */
+  int2 kernel_size;
+  /* Whether the kernel has a single channel for all image channels or one per channel. */
+  bool single_channel_kernel;
+  /* The area to convolve, which is clamped to the image. */
+  rcti area;
+};
+
+class FFTConvolutionTestP : public testing::TestWithParam<FFTConvolutionParams> {};
+
+static MemoryBuffer random_buffer(const DataType data_type, const int2 size, const uint32_t seed)
+{
+  rcti rect;
+  BLI_rcti_init(&rect, 0, size.x, 0, size.y);
+  MemoryBuffer buffer(data_type, rect);
+  RandomNumberGenerator rng(seed);
+  for (const int y : IndexRange(size.y)) {
+    for (const int x : IndexRange(size.x)) {
+      for (const int channel : IndexRange(buffer.get_num_channels())) {
+        buffer.get_elem(x, y)[channel] = rng.get_float();
+      }
+    }
+  }
+  return buffer;
+}
+
+/* Direct convolution of a single pixel, following the definition of #fft_convolve. */
+static float convolve_direct(const MemoryBuffer &input,
+                             const MemoryBuffer &kernel,
+                             const int x,
+                             const int y,
+                             const int channel)
+{
+  const int2 kernel_size = int2(kernel.get_width(), kernel.get_height());
+  const int2 kernel_center = kernel_size / 2;
+  const int kernel_channel = kernel.get_num_channels() == 1 ? 0 : channel;
+  double sum = 0.0;
+  for (const int j : IndexRange(kernel_size.y)) {
+    for (const int i : IndexRange(kernel_size.x)) {
+      const float input_value = input.get_elem_clamped(x + i - kernel_center.x,
+                                                       y + j - kernel_center.y)[channel];
+      sum += double(kernel.get_elem(i, j)[kernel_channel]) * double(input_value);
+    }
+  }
+  return float(sum);
+}
+
+TEST_P(FFTConvolutionTestP, MatchesDirectConvolution)
+{
+  const FFTConvolutionParams params = GetParam();
+
+  const MemoryBuffer input = random_buffer(DataType::Color, params.image_size, 1);
+  MemoryBuffer kernel = random_buffer(
+      params.single_channel_kernel ? DataType::Value : DataType::Color, params.kernel_size, 2);
+  /* Normalize the kernel like the operations do, so that the result stays in the range of the
+   * input and a fixed tolerance can be used. */
+  const int64_t kernel_pixels_count = int64_t(params.kernel_size.x) * params.kernel_size.y;
+  for (const int y : IndexRange(params.kernel_size.y)) {
+    for (const int x : IndexRange(params.kernel_size.x)) {
+      for (const int channel : IndexRange(kernel.get_num_channels())) {
+        kernel.get_elem(x, y)[channel] *= 2.0f / float(kernel_pixels_count);
+      }
+    }
+  }
+
+  rcti image_rect;
+  BLI_rcti_init(&image_rect, 0, params.image_size.x, 0, params.image_size.y);
+  MemoryBuffer output(DataType::Color, image_rect);
+  if (!fft_convolve(input, kernel, output, params.area)) {
+    GTEST_SKIP() << "Built without FFTW";
+  }
+
+  for (int y = params.area.ymin; y < params.area.ymax; y++) {
+    for (int x = params.area.xmin; x < params.area.xmax; x++) {
+      for (const int channel : IndexRange(4)) {
+        EXPECT_NEAR(output.get_elem(x, y)[channel],
+                    convolve_direct(input, kernel, x, y, channel),
+                    1e-4f)
+            << "at (" << x << ", " << y << "), channel " << channel;
+      }
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(SmallKernel,
+                         FFTConvolutionTestP,
+                         testing::Values(FFTConvolutionParams{
+                             int2(20, 17), int2(3, 3), false, rcti{0, 20, 0, 17}}));
+
+INSTANTIATE_TEST_SUITE_P(NonSquareSingleChannelKernel,
+                         FFTConvolutionTestP,
+                         testing::Values(FFTConvolutionParams{
+                             int2(20, 17), int2(7, 3), true, rcti{0, 20, 0, 17}}));
+
+INSTANTIATE_TEST_SUITE_P(KernelLargerThanImage,
+                         FFTConvolutionTestP,
+                         testing::Values(FFTConvolutionParams{
+                             int2(9, 6), int2(13, 11), false, rcti{0, 9, 0, 6}}));
+
+/* The borders of the area are inside the image, so the input around the area is read. */
+INSTANTIATE_TEST_SUITE_P(InteriorArea,
+                         FFTConvolutionTestP,
+                         testing::Values(FFTConvolutionParams{
+                             int2(24, 19), int2(5, 9), false, rcti{3, 17, 4, 15}}));
+
+/* The area touches the right and top borders of the image, where the input is clamped. */
+INSTANTIATE_TEST_SUITE_P(BorderArea,
+                         FFTConvolutionTestP,
+                         testing::Values(FFTConvolutionParams{
+                             int2(24, 19), int2(9, 5), true, rcti{10, 24, 12, 19}}));
+
+/* Large enough for the area to be split into multiple tiles, with a kernel size that is used for
+ * bokeh blurs. */
+INSTANTIATE_TEST_SUITE_P(MultipleTiles,
+                         FFTConvolutionTestP,
+                         testing::Values(FFTConvolutionParams{
+                             int2(270, 37), int2(17, 17), false, rcti{0, 270, 0, 37}}));
+
+}  // namespace blender::compositor::tests
@@ -0,0 +1,186 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BLI_rand.hh"
+
+#include "COM_FusedRowOperation.h"
+#include "COM_MultiThreadedRowOperation.h"
+
+namespace blender::compositor::tests {
+
+static const rcti canvas = {0, 13, 0, 7};
+
+/** Operation without inputs, standing in for the operations that can't be fused. */
+class SourceOperation : public NodeOperation {
+ public:
+  SourceOperation(const DataType data_type)
+  {
+    add_output_socket(data_type);
+    set_canvas(canvas);
+  }
+};
+
+/**
+ * Per-pixel operation writing the scaled sum of its inputs, standing in for the row operations of
+ * the compositor nodes.
+ */
+class SumOperation : public MultiThreadedRowOperation {
+ private:
+  float scale_;
+
+ public:
+  SumOperation(Span<DataType> input_types, const DataType output_type, const float scale)
+      : scale_(scale)
+  {
+    for (const DataType input_type : input_types) {
+      add_input_socket(input_type);
+    }
+    add_output_socket(output_type);
+    set_canvas(canvas);
+  }
+
+  void link(const int input_index, NodeOperation &input)
+  {
+    get_input_socket(input_index)->set_link(input.get_output_socket());
+  }
+
+  /** Compute a pixel from the pixels of the inputs, single channel inputs are broadcast. */
+  void evaluate(Span<const float *> inputs, float *output)
+  {
+    const int num_channels = COM_data_type_num_channels(get_output_socket()->get_data_type());
+    for (const int channel : IndexRange(num_channels)) {
+      float sum = float(channel);
+      for (const int i : inputs.index_range()) {
+        const int input_channels = COM_data_type_num_channels(
+            get_input_socket(i)->get_data_type());
+        sum += inputs[i][std::min(channel, input_channels - 1)];
+      }
+      output[channel] = sum * scale_;
+    }
+  }
+
+  void update_memory_buffer_row(PixelCursor &p) override
+  {
+    for (; p.out < p.row_end; p.next()) {
+      evaluate(p.ins, p.out);
+    }
+  }
+};
+
+/** Makes the partial update of the fused operation available to the tests. */
+class TestFusedRowOperation : public FusedRowOperation {
+ public:
+  using FusedRowOperation::FusedRowOperation;
+  using FusedRowOperation::update_memory_buffer_partial;
+};
+
+static MemoryBuffer random_buffer(const DataType data_type, const uint32_t seed)
+{
+  MemoryBuffer buffer(data_type, canvas);
+  RandomNumberGenerator rng(seed);
+  for (int y = canvas.ymin; y < canvas.ymax; y++) {
+    for (int x = canvas.xmin; x < canvas.xmax; x++) {
+      for (const int channel : IndexRange(buffer.get_num_channels())) {
+        buffer.get_elem(x, y)[channel] = rng.get_float();
+      }
+    }
+  }
+  return buffer;
+}
+
+/* Render an operation without fusing it, writing its whole result to a buffer. */
+static MemoryBuffer render_unfused(SumOperation &operation, Span<const MemoryBuffer *> inputs)
+{
+  MemoryBuffer output(operation.get_output_socket()->get_data_type(), canvas);
+  Vector<const float *> pixel_inputs(inputs.size());
+  for (int y = canvas.ymin; y < canvas.ymax; y++) {
+    for (int x = canvas.xmin; x < canvas.xmax; x++) {
+      for (const int i : inputs.index_range()) {
+        pixel_inputs[i] = inputs[i]->get_elem(x, y);
+      }
+      operation.evaluate(pixel_inputs, output.get_elem(x, y));
+    }
+  }
+  return output;
+}
+
+TEST(FusedRowOperation, matches_unfused)
+{
+  SourceOperation image_source(DataType::Color);
+  SourceOperation mask_source(DataType::Value);
+  MemoryBuffer image = random_buffer(DataType::Color, 1);
+  MemoryBuffer mask = random_buffer(DataType::Value, 2);
+
+  /* The fused operation takes ownership of the steps. */
+  SumOperation *first = new SumOperation({DataType::Color}, DataType::Color, 0.5f);
+  SumOperation *second = new SumOperation(
+      {DataType::Color, DataType::Value}, DataType::Value, 0.25f);
+  SumOperation *third = new SumOperation(
+      {DataType::Color, DataType::Value}, DataType::Color, 2.0f);
+  first->link(0, image_source);
+  second->link(0, *first);
+  second->link(1, mask_source);
+  /* The previous step isn't the first input, and the image is also read by another step. */
+  third->link(0, image_source);
+  third->link(1, *second);
+
+  const MemoryBuffer first_result = render_unfused(*first, {&image});
+  const MemoryBuffer second_result = render_unfused(*second, {&first_result, &mask});
+  const MemoryBuffer third_result = render_unfused(*third, {&image, &second_result});
+
+  TestFusedRowOperation fused({first, second, third});
+  const Vector<NodeOperationInput *> external_inputs = fused.get_step_external_inputs();
+  ASSERT_EQ(external_inputs.size(), 3);
+  EXPECT_EQ(external_inputs[0], first->get_input_socket(0));
+  EXPECT_EQ(external_inputs[1], second->get_input_socket(1));
+  EXPECT_EQ(external_inputs[2], third->get_input_socket(0));
+  EXPECT_EQ(fused.get_output_socket()->get_data_type(), DataType::Color);
+
+  /* Render an area not starting at the origin, like a tile or a part of a multi-threaded
+   * render. */
+  const rcti area = {2, 11, 1, 6};
+  MemoryBuffer output(DataType::Color, canvas);
+  fused.update_memory_buffer_partial(&output, area, {&image, &mask, &image});
+
+  for (int y = area.ymin; y < area.ymax; y++) {
+    for (int x = area.xmin; x < area.xmax; x++) {
+      for (const int channel : IndexRange(4)) {
+        EXPECT_EQ(output.get_elem(x, y)[channel], third_result.get_elem(x, y)[channel])
+            << "at (" << x << ", " << y << "), channel " << channel;
+      }
+    }
+  }
+}
+
+TEST(FusedRowOperation, find_chains)
+{
+  SourceOperation source(DataType::Color);
+  SumOperation first({DataType::Color}, DataType::Color, 1.0f);
+  SumOperation multi_user({DataType::Color}, DataType::Color, 1.0f);
+  SumOperation left({DataType::Color}, DataType::Color, 1.0f);
+  SumOperation right({DataType::Color}, DataType::Color, 1.0f);
+  SumOperation join({DataType::Color, DataType::Color}, DataType::Color, 1.0f);
+  SumOperation other_canvas({DataType::Color}, DataType::Color, 1.0f);
+  other_canvas.set_canvas({0, 5, 0, 5});
+  first.link(0, source);
+  multi_user.link(0, first);
+  left.link(0, multi_user);
+  right.link(0, multi_user);
+  join.link(0, left);
+  join.link(1, right);
+  other_canvas.link(0, join);
+
+  const Vector<Vector<MultiThreadedOperation *>> chains = FusedRowOperation::find_chains(
+      {&source, &first, &multi_user, &left, &right, &join, &other_canvas});
+
+  /* The output of the operation read by two others must be rendered, so it ends a chain. A step
+   * joining two branches is fused with one of them only. */
+  ASSERT_EQ(chains.size(), 2);
+  EXPECT_EQ(chains[0].as_span(), Span<MultiThreadedOperation *>({&first, &multi_user}));
+  EXPECT_EQ(chains[1].as_span(), Span<MultiThreadedOperation *>({&left, &join}));
+}
+
+}  // namespace blender::compositor::tests
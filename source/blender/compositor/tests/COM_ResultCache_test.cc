@@ -0,0 +1,401 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+
+#include "BKE_image.h"
+#include "BKE_node.hh"
+
+#include "DNA_camera_types.h"
+#include "DNA_genfile.h"
+#include "DNA_image_types.h"
+#include "DNA_node_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+#include "DNA_userdef_types.h"
+
+#include "COM_CompositorContext.h"
+#include "COM_ConvertDepthToRadiusOperation.h"
+#include "COM_ImageOperation.h"
+#include "COM_RenderLayersProg.h"
+#include "COM_ResultCache.h"
+#include "COM_SetValueOperation.h"
+
+namespace blender::compositor::tests {
+
+class ResultCacheTest : public testing::Test {
+ private:
+  int memcachelimit_;
+
+ protected:
+  void SetUp() override
+  {
+    memcachelimit_ = U.memcachelimit;
+    /* A quarter of it is used by the result cache. */
+    U.memcachelimit = 1;
+    ResultCache::clear();
+  }
+
+  void TearDown() override
+  {
+    ResultCache::clear();
+    U.memcachelimit = memcachelimit_;
+  }
+};
+
+/* A buffer of 100 KiB, with all values set to the given value. */
+static MemoryBuffer create_buffer(const float value)
+{
+  MemoryBuffer buffer(DataType::Value, rcti{0, 160, 0, 160});
+  buffer.fill(buffer.get_rect(), &value);
+  return buffer;
+}
+
+TEST_F(ResultCacheTest, add_lookup_clear)
+{
+  ResultCache::add(1, create_buffer(1.0f));
+  ResultCache::add(2, create_buffer(2.0f));
+
+  const std::shared_ptr<const MemoryBuffer> result = ResultCache::lookup(1);
+  ASSERT_NE(result, nullptr);
+  EXPECT_EQ(result->get_width(), 160);
+  EXPECT_EQ(result->get_height(), 160);
+  EXPECT_EQ(*result->get_elem(10, 20), 1.0f);
+  EXPECT_EQ(*ResultCache::lookup(2)->get_elem(10, 20), 2.0f);
+  EXPECT_EQ(ResultCache::lookup(3), nullptr);
+
+  /* A result that is still referenced stays valid when the cache is cleared. */
+  ResultCache::clear();
+  EXPECT_EQ(ResultCache::lookup(1), nullptr);
+  EXPECT_EQ(*result->get_elem(10, 20), 1.0f);
+}
+
+TEST_F(ResultCacheTest, least_recently_used_freed)
+{
+  /* Two of the three buffers fit in the 256 KiB limit. */
+  ResultCache::add(1, create_buffer(1.0f));
+  ResultCache::add(2, create_buffer(2.0f));
+  EXPECT_NE(ResultCache::lookup(1), nullptr);
+  ResultCache::add(3, create_buffer(3.0f));
+
+  EXPECT_NE(ResultCache::lookup(1), nullptr);
+  EXPECT_EQ(ResultCache::lookup(2), nullptr);
+  EXPECT_NE(ResultCache::lookup(3), nullptr);
+
+  /* Results larger than the limit are not cached at all. */
+  MemoryBuffer large_buffer(DataType::Color, rcti{0, 160, 0, 160});
+  ResultCache::add(4, large_buffer);
+  EXPECT_EQ(ResultCache::lookup(4), nullptr);
+  EXPECT_NE(ResultCache::lookup(1), nullptr);
+}
+
+class ResultCacheHashTest : public testing::Test {
+ protected:
+  static void SetUpTestSuite()
+  {
+    DNA_sdna_current_init();
+  }
+
+  static void TearDownTestSuite()
+  {
+    DNA_sdna_current_free();
+  }
+};
+
+TEST_F(ResultCacheHashTest, node_settings)
+{
+  bke::bNodeType node_type{};
+  STRNCPY(node_type.storagename, "NodeBlurData");
+  NodeBlurData storage{};
+  bNodeSocketValueFloat socket_value{};
+  bNodeSocket socket{};
+  socket.type = SOCK_FLOAT;
+  socket.default_value = &socket_value;
+  bNode node{};
+  node.type = CMP_NODE_BLUR;
+  node.typeinfo = &node_type;
+  node.storage = &storage;
+  BLI_addtail(&node.inputs, &socket);
+
+  const std::optional<size_t> hash = ResultCache::hash_node_settings(node);
+  ASSERT_TRUE(hash.has_value());
+  EXPECT_EQ(ResultCache::hash_node_settings(node), hash);
+
+  node.custom1 = 1;
+  EXPECT_NE(ResultCache::hash_node_settings(node), hash);
+  node.custom1 = 0;
+  EXPECT_EQ(ResultCache::hash_node_settings(node), hash);
+
+  storage.sizex = 10;
+  EXPECT_NE(ResultCache::hash_node_settings(node), hash);
+  storage.sizex = 0;
+  /* The last member of the storage, to make sure the whole struct is hashed. */
+  storage.image_in_height = 100;
+  EXPECT_NE(ResultCache::hash_node_settings(node), hash);
+  storage.image_in_height = 0;
+
+  socket_value.value = 0.5f;
+  EXPECT_NE(ResultCache::hash_node_settings(node), hash);
+  socket_value.value = 0.0f;
+  EXPECT_EQ(ResultCache::hash_node_settings(node), hash);
+
+  /* Data-blocks can change without the node changing. */
+  ID id{};
+  node.id = &id;
+  EXPECT_FALSE(ResultCache::hash_node_settings(node).has_value());
+  node.id = nullptr;
+
+  /* Image operations hash the image themselves. */
+  node.type = CMP_NODE_IMAGE;
+  node.id = &id;
+  STRNCPY(node_type.storagename, "ImageUser");
+  EXPECT_TRUE(ResultCache::hash_node_settings(node).has_value());
+  node.type = CMP_NODE_BLUR;
+  node.id = nullptr;
+
+  /* Storage with pointers can change without the storage itself changing. */
+  STRNCPY(node_type.storagename, "CurveMapping");
+  EXPECT_FALSE(ResultCache::hash_node_settings(node).has_value());
+}
+
+TEST_F(ResultCacheHashTest, context)
+{
+  RenderData render_data{};
+  CompositorContext context;
+  context.set_render_data(&render_data);
+  context.set_rendering(false);
+  context.set_view_name("");
+
+  const size_t hash = ResultCache::hash_context(context);
+  EXPECT_EQ(ResultCache::hash_context(context), hash);
+
+  render_data.cfra = 2;
+  EXPECT_NE(ResultCache::hash_context(context), hash);
+  render_data.cfra = 0;
+  render_data.size = 50;
+  EXPECT_NE(ResultCache::hash_context(context), hash);
+  render_data.size = 0;
+  EXPECT_EQ(ResultCache::hash_context(context), hash);
+
+  context.set_view_name("left");
+  EXPECT_NE(ResultCache::hash_context(context), hash);
+}
+
+/** Operation with a value input, standing in for the operations converted from a node. */
+class HashedOperation : public NodeOperation {
+ public:
+  HashedOperation(const std::optional<size_t> node_settings_hash)
+  {
+    add_input_socket(DataType::Value);
+    add_output_socket(DataType::Value);
+    set_canvas({0, 10, 0, 10});
+    set_node_settings_hash(node_settings_hash);
+  }
+
+  void link(NodeOperation &input)
+  {
+    get_input_socket(0)->set_link(input.get_output_socket());
+  }
+};
+
+/** Operation reading data from outside of the node tree, like a render result. */
+class ExternalDataOperation : public NodeOperation {
+ public:
+  int external_data = 0;
+
+  ExternalDataOperation()
+  {
+    add_output_socket(DataType::Value);
+    set_canvas({0, 10, 0, 10});
+    set_node_settings_hash(0);
+  }
+
+ protected:
+  bool hash_external_data(size_t &r_hash) override
+  {
+    combine_hashes(r_hash, external_data);
+    return true;
+  }
+};
+
+/* Compute the content hashes like #NodeOperationBuilder, inputs before the operations reading
+ * them. */
+static void compute_content_hashes(Span<NodeOperation *> operations)
+{
+  for (NodeOperation *operation : operations) {
+    operation->set_content_hash(operation->generate_content_hash());
+  }
+}
+
+TEST(ResultCacheContentHash, input_changes_propagate)
+{
+  ExternalDataOperation source;
+  HashedOperation first(1);
+  HashedOperation second(2);
+  first.link(source);
+  second.link(first);
+
+  compute_content_hashes({&source, &first, &second});
+  const std::optional<size_t> source_hash = source.get_content_hash();
+  const std::optional<size_t> first_hash = first.get_content_hash();
+  const std::optional<size_t> second_hash = second.get_content_hash();
+  ASSERT_TRUE(source_hash.has_value());
+  ASSERT_TRUE(first_hash.has_value());
+  ASSERT_TRUE(second_hash.has_value());
+  EXPECT_NE(first_hash, second_hash);
+
+  /* A new render result changes everything downstream. */
+  source.external_data = 1;
+  compute_content_hashes({&source, &first, &second});
+  EXPECT_NE(source.get_content_hash(), source_hash);
+  EXPECT_NE(first.get_content_hash(), first_hash);
+  EXPECT_NE(second.get_content_hash(), second_hash);
+  source.external_data = 0;
+
+  /* Changed node settings only change the operation and the ones reading it. */
+  first.set_node_settings_hash(3);
+  compute_content_hashes({&source, &first, &second});
+  EXPECT_EQ(source.get_content_hash(), source_hash);
+  EXPECT_NE(first.get_content_hash(), first_hash);
+  EXPECT_NE(second.get_content_hash(), second_hash);
+  first.set_node_settings_hash(1);
+
+  /* Changed canvas. */
+  first.set_canvas({0, 20, 0, 10});
+  compute_content_hashes({&source, &first, &second});
+  EXPECT_NE(first.get_content_hash(), first_hash);
+  EXPECT_NE(second.get_content_hash(), second_hash);
+  first.set_canvas({0, 10, 0, 10});
+
+  compute_content_hashes({&source, &first, &second});
+  EXPECT_EQ(second.get_content_hash(), second_hash);
+
+  /* An operation that can't be hashed makes everything downstream uncacheable. */
+  first.set_node_settings_hash(std::nullopt);
+  compute_content_hashes({&source, &first, &second});
+  EXPECT_FALSE(first.get_content_hash().has_value());
+  EXPECT_FALSE(second.get_content_hash().has_value());
+}
+
+TEST(ResultCacheContentHash, constant_input_changes_propagate)
+{
+  SetValueOperation value;
+  value.set_value(1.0f);
+  HashedOperation operation(1);
+  operation.link(value);
+
+  compute_content_hashes({&value, &operation});
+  const std::optional<size_t> hash = operation.get_content_hash();
+  ASSERT_TRUE(hash.has_value());
+
+  value.set_value(2.0f);
+  compute_content_hashes({&value, &operation});
+  EXPECT_NE(operation.get_content_hash(), hash);
+
+  value.set_value(1.0f);
+  compute_content_hashes({&value, &operation});
+  EXPECT_EQ(operation.get_content_hash(), hash);
+}
+
+TEST(ResultCacheContentHash, render_result)
+{
+  RenderLayersProg operation("Combined", DataType::Color, 4);
+  operation.set_view_name("");
+  RenderResult render_result{};
+  render_result.session_uid = 1;
+  const size_t hash = operation.hash_render_result(render_result);
+  EXPECT_EQ(operation.hash_render_result(render_result), hash);
+
+  /* A new render. */
+  RenderResult new_render_result{};
+  new_render_result.session_uid = 2;
+  EXPECT_NE(operation.hash_render_result(new_render_result), hash);
+
+  /* Another layer or pass of the same render. */
+  operation.set_layer_id(1);
+  EXPECT_NE(operation.hash_render_result(render_result), hash);
+  operation.set_layer_id(0);
+  RenderLayersProg depth_operation("Depth", DataType::Value, 1);
+  depth_operation.set_view_name("");
+  EXPECT_NE(depth_operation.hash_render_result(render_result), hash);
+}
+
+TEST(ResultCacheContentHash, image)
+{
+  Image image{};
+  image.id.session_uid = 1;
+  image.type = IMA_TYPE_IMAGE;
+  ImageOperation operation;
+  operation.set_image(&image);
+  operation.set_image_user(ImageUser{});
+  operation.set_node_settings_hash(0);
+  const std::optional<size_t> hash = operation.generate_content_hash();
+  ASSERT_TRUE(hash.has_value());
+  EXPECT_EQ(operation.generate_content_hash(), hash);
+
+  /* Another frame of a movie or an image sequence. */
+  ImageUser image_user{};
+  image_user.framenr = 2;
+  operation.set_image_user(image_user);
+  EXPECT_NE(operation.generate_content_hash(), hash);
+  operation.set_image_user(ImageUser{});
+  EXPECT_EQ(operation.generate_content_hash(), hash);
+
+  /* Another image. */
+  image.id.session_uid = 2;
+  EXPECT_NE(operation.generate_content_hash(), hash);
+  image.id.session_uid = 1;
+
+  /* The image is edited, like when painted or reloaded. */
+  BKE_image_partial_update_mark_full_update(&image);
+  EXPECT_NE(operation.generate_content_hash(), hash);
+  BKE_image_partial_update_register_free(&image);
+
+  /* Render results and viewer images are written without being tagged. */
+  image.type = IMA_TYPE_R_RESULT;
+  EXPECT_FALSE(operation.generate_content_hash().has_value());
+}
+
+TEST(ResultCacheContentHash, defocus_camera)
+{
+  Camera camera{};
+  camera.lens = 50.0f;
+  camera.sensor_x = 36.0f;
+  camera.sensor_y = 24.0f;
+  camera.dof.focus_distance = 10.0f;
+  Object camera_object{};
+  camera_object.type = OB_CAMERA;
+  camera_object.data = &camera;
+  Scene scene{};
+  scene.camera = &camera_object;
+  NodeDefocus data{};
+
+  ConvertDepthToRadiusOperation operation;
+  operation.set_data(&data);
+  operation.set_scene(&scene);
+  operation.set_node_settings_hash(0);
+  const std::optional<size_t> hash = operation.generate_content_hash();
+  ASSERT_TRUE(hash.has_value());
+  EXPECT_EQ(operation.generate_content_hash(), hash);
+
+  camera.lens = 35.0f;
+  EXPECT_NE(operation.generate_content_hash(), hash);
+  camera.lens = 50.0f;
+  camera.dof.focus_distance = 5.0f;
+  EXPECT_NE(operation.generate_content_hash(), hash);
+  camera.dof.focus_distance = 10.0f;
+  camera.sensor_fit = CAMERA_SENSOR_FIT_VERT;
+  EXPECT_NE(operation.generate_content_hash(), hash);
+  camera.sensor_fit = CAMERA_SENSOR_FIT_AUTO;
+  EXPECT_EQ(operation.generate_content_hash(), hash);
+
+  /* No camera. */
+  scene.camera = nullptr;
+  EXPECT_NE(operation.generate_content_hash(), hash);
+}
+
+}  // namespace blender::compositor::tests
@@ -50,6 +50,27 @@ void DEG_debug_stats_gnuplot(const Depsgraph *graph,
                              const char *label,
                              const char *output_filename);
 
+/* ************************************************ */
+/* Evaluation Timeline Tracing */
+
+/**
+ * Start recording spans of work done during evaluation. The recorded timeline is written to
+ * the given file in the Chrome trace event format (readable by `chrome://tracing` and Perfetto)
+ * by #DEG_debug_trace_end.
+ */
+void DEG_debug_trace_begin(const char *filepath);
+bool DEG_debug_trace_is_enabled();
+/**
+ * Record a span of work done by the calling thread.
+ * Times are in seconds, as returned by #BLI_time_now_seconds.
+ */
+void DEG_debug_trace_add_span(const char *category,
+                              const char *name,
+                              double start_time,
+                              double end_time);
+/** Stop recording and write the trace file. Returns false if tracing was not active or failed. */
+bool DEG_debug_trace_end();
+
 /* ************************************************ */
 
 /** Compare two dependency graphs. */
@@ -16,8 +16,10 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_array.hh"
 #include "BLI_blenlib.h"
 #include "BLI_span.hh"
+#include "BLI_task.hh"
 #include "BLI_utildefines.h"
 
 #include "DNA_action_types.h"
@@ -3453,8 +3455,19 @@ void DepsgraphRelationBuilder::build_vfont(VFont *vfont)
 
 void DepsgraphRelationBuilder::build_copy_on_write_relations()
 {
-  for (IDNode *id_node : graph_->id_nodes) {
-    build_copy_on_write_relations(id_node);
+  /* Relations of every ID only depend on the nodes of that ID, so they are gathered in parallel.
+   * They are added to the graph in the order of ID nodes, keeping the build deterministic. */
+  const Span<IDNode *> id_nodes = graph_->id_nodes;
+  Array<Vector<StagedRelation>> relations_per_id(id_nodes.size());
+  threading::parallel_for(id_nodes.index_range(), 64, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      build_copy_on_write_relations(id_nodes[i], relations_per_id[i]);
+    }
+  });
+  for (const Span<StagedRelation> relations : relations_per_id) {
+    for (const StagedRelation &relation : relations) {
+      graph_->add_new_relation(relation.from, relation.to, relation.description, relation.flags);
+    }
   }
 }
 
@@ -3494,7 +3507,8 @@ void DepsgraphRelationBuilder::build_nested_shapekey(ID *owner, Key *key)
   build_nested_datablock(owner, &key->id, true);
 }
 
-void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
+void DepsgraphRelationBuilder::build_copy_on_write_relations(const IDNode *id_node,
+                                                             Vector<StagedRelation> &r_relations)
 {
   ID *id_orig = id_node->id_orig;
 
@@ -3509,8 +3523,7 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
   // add_relation(time_source_key, copy_on_write_key, "Fluxgate capacitor hack");
   /* Resat of code is using rather low level trickery, so need to get some
    * explicit pointers. */
-  Node *node_cow = find_node(copy_on_write_key);
-  OperationNode *op_cow = node_cow->get_exit_operation();
+  OperationNode *op_cow = find_node(copy_on_write_key);
   /* Plug any other components to this one. */
   for (ComponentNode *comp_node : id_node->components.values()) {
     if (comp_node->type == NodeType::COPY_ON_EVAL) {
@@ -3558,8 +3571,7 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
      * copy of ID. */
     OperationNode *op_entry = comp_node->get_entry_operation();
     if (op_entry != nullptr) {
-      Relation *rel = graph_->add_new_relation(op_cow, op_entry, "Copy-on-Eval Dependency");
-      rel->flag |= rel_flag;
+      r_relations.append({op_cow, op_entry, "Copy-on-Eval Dependency", rel_flag});
     }
     /* All dangling operations should also be executed after copy-on-evaluation. */
     for (OperationNode *op_node : comp_node->operations_map->values()) {
@@ -3567,8 +3579,7 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
         continue;
       }
       if (op_node->inlinks.is_empty()) {
-        Relation *rel = graph_->add_new_relation(op_cow, op_node, "Copy-on-Eval Dependency");
-        rel->flag |= rel_flag;
+        r_relations.append({op_cow, op_node, "Copy-on-Eval Dependency", rel_flag});
       }
       else {
         bool has_same_comp_dependency = false;
@@ -3583,8 +3594,7 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
           }
         }
         if (!has_same_comp_dependency) {
-          Relation *rel = graph_->add_new_relation(op_cow, op_node, "Copy-on-Eval Dependency");
-          rel->flag |= rel_flag;
+          r_relations.append({op_cow, op_node, "Copy-on-Eval Dependency", rel_flag});
         }
       }
     }
@@ -3605,8 +3615,12 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
       if (deg_eval_copy_is_needed(object_data_id)) {
         OperationKey data_copy_on_write_key(
             object_data_id, NodeType::COPY_ON_EVAL, OperationCode::COPY_ON_EVAL);
-        add_relation(
-            data_copy_on_write_key, copy_on_write_key, "Eval Order", RELATION_FLAG_GODMODE);
+        /* The operation is looked up directly rather than through the component, as the latter
+         * caches its exit operation, and the component might be shared with other threads. */
+        OperationNode *op_data_cow = get_node(data_copy_on_write_key);
+        if (op_data_cow != nullptr) {
+          r_relations.append({op_data_cow, op_cow, "Eval Order", RELATION_FLAG_GODMODE});
+        }
       }
     }
     else {
@@ -20,6 +20,7 @@
 #include "BLI_span.hh"
 #include "BLI_string.h"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "intern/builder/deg_builder.h"
 #include "intern/builder/deg_builder_key.h"
@@ -83,6 +84,15 @@ struct TimeSourceNode;
 
 class DepsgraphRelationBuilder : public DepsgraphBuilder {
  public:
+  /* Relation which is found while building relations of multiple IDs in parallel. It is added to
+   * the graph after all threads are done, so that the graph is the same as with serial build. */
+  struct StagedRelation {
+    OperationNode *from;
+    OperationNode *to;
+    const char *description;
+    int flags;
+  };
+
   DepsgraphRelationBuilder(Main *bmain, Depsgraph *graph, DepsgraphBuilderCache *cache);
 
   void begin_build();
@@ -277,7 +287,8 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
                                          const char *name);
 
   virtual void build_copy_on_write_relations();
-  virtual void build_copy_on_write_relations(IDNode *id_node);
+  virtual void build_copy_on_write_relations(const IDNode *id_node,
+                                             Vector<StagedRelation> &r_relations);
   virtual void build_driver_relations();
   virtual void build_driver_relations(IDNode *id_node);
 
@@ -0,0 +1,156 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup depsgraph
+ *
+ * Recording of the evaluation timeline in the Chrome trace event format.
+ */
+
+#include "DEG_depsgraph_debug.hh"
+
+#include <atomic>
+#include <mutex>
+
+#include "BLI_fileops.h"
+#include "BLI_string_ref.hh"
+#include "BLI_vector.hh"
+
+#include "intern/depsgraph_type.hh"
+
+namespace blender::deg {
+namespace {
+
+struct TraceSpan {
+  string category;
+  string name;
+  int thread_id;
+  double start_time;
+  double end_time;
+};
+
+struct TraceState {
+  std::atomic<bool> is_enabled = false;
+  string filepath;
+  std::mutex mutex;
+  Vector<TraceSpan> spans;
+  /* Time of the first span, so that the timeline starts at zero. */
+  double start_time = 0.0;
+};
+
+TraceState &trace_state()
+{
+  static TraceState state;
+  return state;
+}
+
+/* Small sequential identifiers are easier to read in the trace viewer than native ones. */
+int current_thread_id()
+{
+  static std::atomic<int> next_thread_id = 1;
+  thread_local const int thread_id = next_thread_id.fetch_add(1);
+  return thread_id;
+}
+
+void write_json_string(FILE *file, StringRef str)
+{
+  fputc('"', file);
+  for (const char c : str) {
+    if (ELEM(c, '"', '\\')) {
+      fputc('\\', file);
+      fputc(c, file);
+    }
+    else if (uchar(c) < 0x20) {
+      fprintf(file, "\\u%04x", c);
+    }
+    else {
+      fputc(c, file);
+    }
+  }
+  fputc('"', file);
+}
+
+void write_trace(FILE *file, const TraceState &state)
+{
+  fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+  bool is_first = true;
+  for (const TraceSpan &span : state.spans) {
+    if (!is_first) {
+      fprintf(file, ",\n");
+    }
+    is_first = false;
+    fprintf(file, "{\"name\": ");
+    write_json_string(file, span.name);
+    fprintf(file, ", \"cat\": ");
+    write_json_string(file, span.category);
+    /* Complete events, with time-stamps and durations in microseconds. */
+    fprintf(file,
+            ", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}",
+            span.thread_id,
+            (span.start_time - state.start_time) * 1e6,
+            (span.end_time - span.start_time) * 1e6);
+  }
+  fprintf(file, "\n]}\n");
+}
+
+}  // namespace
+}  // namespace blender::deg
+
+namespace deg = blender::deg;
+
+void DEG_debug_trace_begin(const char *filepath)
+{
+  deg::TraceState &state = deg::trace_state();
+  std::lock_guard lock(state.mutex);
+  state.filepath = filepath;
+  state.spans.clear();
+  state.start_time = 0.0;
+  state.is_enabled = true;
+}
+
+bool DEG_debug_trace_is_enabled()
+{
+  return deg::trace_state().is_enabled.load(std::memory_order_relaxed);
+}
+
+void DEG_debug_trace_add_span(const char *category,
+                              const char *name,
+                              const double start_time,
+                              const double end_time)
+{
+  deg::TraceState &state = deg::trace_state();
+  if (!state.is_enabled) {
+    return;
+  }
+  const int thread_id = deg::current_thread_id();
+  std::lock_guard lock(state.mutex);
+  if (state.spans.is_empty() || start_time < state.start_time) {
+    state.start_time = start_time;
+  }
+  state.spans.append({category, name, thread_id, start_time, end_time});
+}
+
+bool DEG_debug_trace_end()
+{
+  deg::TraceState &state = deg::trace_state();
+  std::lock_guard lock(state.mutex);
+  if (!state.is_enabled) {
+    return false;
+  }
+  state.is_enabled = false;
+
+  FILE *file = BLI_fopen(state.filepath.c_str(), "w");
+  if (file == nullptr) {
+    fprintf(stderr, "Error opening depsgraph trace file '%s'\n", state.filepath.c_str());
+    return false;
+  }
+  deg::write_trace(file, state);
+  fclose(file);
+
+  printf("Depsgraph trace with %d spans written to '%s'\n",
+         int(state.spans.size()),
+         state.filepath.c_str());
+  state.spans.clear_and_shrink();
+  return true;
+}
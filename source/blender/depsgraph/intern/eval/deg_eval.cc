@@ -10,12 +10,17 @@
 
 #include "intern/eval/deg_eval.h"
 
+#include <algorithm>
+#include <mutex>
+
 #include "BLI_compiler_attrs.h"
 #include "BLI_function_ref.hh"
 #include "BLI_gsqueue.h"
+#include "BLI_heap.h"
 #include "BLI_task.h"
 #include "BLI_time.h"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "BKE_global.hh"
 
@@ -24,6 +29,7 @@
 #include "DNA_scene_types.h"
 
 #include "DEG_depsgraph.hh"
+#include "DEG_depsgraph_debug.hh"
 #include "DEG_depsgraph_query.hh"
 
 #ifdef WITH_PYTHON
@@ -83,6 +89,11 @@ struct DepsgraphEvalState {
   EvaluationStage stage;
   bool need_update_pending_parents = true;
   bool need_single_thread_pass = false;
+
+  /* Operations which are ready to be evaluated, ordered by their critical path time. Every task
+   * pushed to the pool evaluates the operation with the longest critical path at that time. */
+  Heap *ready_queue = nullptr;
+  std::mutex ready_queue_mutex;
 };
 
 void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_node)
@@ -91,14 +102,18 @@ void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_nod
 
   /* Sanity checks. */
   BLI_assert_msg(!operation_node->is_noop(), "NOOP nodes should not actually be scheduled");
-  /* Perform operation. */
+  /* Perform operation. It is always timed, as the average time is used for scheduling. */
+  const double start_time = BLI_time_now_seconds();
+  operation_node->evaluate(depsgraph);
+  const double end_time = BLI_time_now_seconds();
+  const double time = end_time - start_time;
+  operation_node->stats.accumulate_average_time(time);
   if (state->do_stats) {
-    const double start_time = BLI_time_now_seconds();
-    operation_node->evaluate(depsgraph);
-    operation_node->stats.current_time += BLI_time_now_seconds() - start_time;
+    operation_node->stats.current_time += time;
   }
-  else {
-    operation_node->evaluate(depsgraph);
+  if (DEG_debug_trace_is_enabled()) {
+    DEG_debug_trace_add_span(
+        "operation", operation_node->full_identifier().c_str(), start_time, end_time);
   }
 
   /* Clear the flag early on, allowing partial updates without re-evaluating the same node multiple
@@ -108,18 +123,36 @@ void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_nod
   operation_node->flag &= ~DEPSOP_FLAG_CLEAR_ON_EVAL;
 }
 
-void deg_task_run_func(TaskPool *pool, void *taskdata)
+void schedule_node_to_pool(DepsgraphEvalState *state, TaskPool *pool, OperationNode *node)
+{
+  {
+    std::lock_guard lock(state->ready_queue_mutex);
+    /* The heap pops the smallest value first. */
+    BLI_heap_insert(state->ready_queue, -float(node->critical_path_time), node);
+  }
+  BLI_task_pool_push(pool, deg_task_run_func, nullptr, false, nullptr);
+}
+
+void deg_task_run_func(TaskPool *pool, void * /*taskdata*/)
 {
   void *userdata_v = BLI_task_pool_user_data(pool);
   DepsgraphEvalState *state = (DepsgraphEvalState *)userdata_v;
 
+  /* Every task has pushed one operation to the queue, so it is never empty here. The popped
+   * operation is not necessarily the one pushed along with this task. */
+  OperationNode *operation_node;
+  {
+    std::lock_guard lock(state->ready_queue_mutex);
+    BLI_assert(!BLI_heap_is_empty(state->ready_queue));
+    operation_node = static_cast<OperationNode *>(BLI_heap_pop_min(state->ready_queue));
+  }
+
   /* Evaluate node. */
-  OperationNode *operation_node = reinterpret_cast<OperationNode *>(taskdata);
   evaluate_node(state, operation_node);
 
   /* Schedule children. */
   schedule_children(state, operation_node, [&](OperationNode *node) {
-    BLI_task_pool_push(pool, deg_task_run_func, node, false, nullptr);
+    schedule_node_to_pool(state, pool, node);
   });
 }
 
@@ -186,6 +219,58 @@ void calculate_pending_parents_if_needed(DepsgraphEvalState *state)
   state->need_update_pending_parents = false;
 }
 
+/* Calculate the critical path time of all operations which are to be evaluated: the average
+ * time of the operation itself plus the longest critical path time of the operations depending
+ * on it. This is done with an iterative depth-first traversal, as chains of operations can be
+ * very long. */
+void calculate_critical_path_times(Depsgraph *graph)
+{
+  enum { NOT_VISITED = 0, VISITING = 1, VISITED = 2 };
+
+  for (OperationNode *node : graph->operations) {
+    node->custom_flags = NOT_VISITED;
+    node->critical_path_time = 0.0;
+  }
+
+  Vector<OperationNode *> stack;
+  for (OperationNode *root : graph->operations) {
+    if (root->custom_flags != NOT_VISITED || (root->flag & DEPSOP_FLAG_NEEDS_UPDATE) == 0) {
+      continue;
+    }
+    stack.append(root);
+    while (!stack.is_empty()) {
+      OperationNode *node = stack.last();
+      if (node->custom_flags == VISITED) {
+        stack.remove_last();
+        continue;
+      }
+      if (node->custom_flags == NOT_VISITED) {
+        node->custom_flags = VISITING;
+        for (Relation *rel : node->outlinks) {
+          OperationNode *child = (OperationNode *)rel->to;
+          if ((rel->flag & RELATION_FLAG_CYCLIC) == 0 && child->custom_flags == NOT_VISITED &&
+              (child->flag & DEPSOP_FLAG_NEEDS_UPDATE))
+          {
+            stack.append(child);
+          }
+        }
+        continue;
+      }
+      /* All children are visited now, except those on a cycle which do not contribute. */
+      double children_time = 0.0;
+      for (Relation *rel : node->outlinks) {
+        const OperationNode *child = (OperationNode *)rel->to;
+        if ((rel->flag & RELATION_FLAG_CYCLIC) == 0 && child->custom_flags == VISITED) {
+          children_time = std::max(children_time, child->critical_path_time);
+        }
+      }
+      node->critical_path_time = node->stats.average_time + children_time;
+      node->custom_flags = VISITED;
+      stack.remove_last();
+    }
+  }
+}
+
 void initialize_execution(DepsgraphEvalState *state, Depsgraph *graph)
 {
   /* Clear tags and other things which needs to be clear. */
@@ -317,10 +402,11 @@ void evaluate_graph_threaded_stage(DepsgraphEvalState *state,
 
   calculate_pending_parents_if_needed(state);
 
-  schedule_graph(state, [&](OperationNode *node) {
-    BLI_task_pool_push(task_pool, deg_task_run_func, node, false, nullptr);
-  });
+  schedule_graph(state,
+                 [&](OperationNode *node) { schedule_node_to_pool(state, task_pool, node); });
   BLI_task_pool_work_and_wait(task_pool);
+
+  BLI_assert(BLI_heap_is_empty(state->ready_queue));
 }
 
 /* Evaluate remaining operations of the dependency graph in a single threaded manner. */
@@ -405,6 +491,8 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
 
   /* Prepare all nodes for evaluation. */
   initialize_execution(&state, graph);
+  calculate_critical_path_times(graph);
+  state.ready_queue = BLI_heap_new();
 
   /* Evaluation happens in several incremental steps:
    *
@@ -447,6 +535,8 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   evaluate_graph_threaded_stage(&state, task_pool, EvaluationStage::THREADED_EVALUATION);
 
   BLI_task_pool_free(task_pool);
+  BLI_heap_free(state.ready_queue, nullptr);
+  state.ready_queue = nullptr;
 
   evaluate_graph_single_threaded_if_needed(&state);
 
@@ -274,6 +274,7 @@ Node::Stats::Stats()
 void Node::Stats::reset()
 {
   current_time = 0.0;
+  average_time = 0.0;
 }
 
 void Node::Stats::reset_current()
@@ -281,6 +282,18 @@ void Node::Stats::reset_current()
   current_time = 0.0;
 }
 
+void Node::Stats::accumulate_average_time(const double time)
+{
+  /* Exponential moving average, so that the estimate follows changes in the scene without
+   * jumping around on a single slow evaluation. */
+  if (average_time == 0.0) {
+    average_time = time;
+  }
+  else {
+    average_time += (time - average_time) * 0.25;
+  }
+}
+
 /*******************************************************************************
  * Node itself.
  */
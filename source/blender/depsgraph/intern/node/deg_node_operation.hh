@@ -281,6 +281,10 @@ struct OperationNode : public Node {
   uint32_t num_links_pending;
   bool scheduled;
 
+  /* Estimated time needed to evaluate this operation and the longest chain of operations
+   * depending on it. Ready operations with the longest estimate are evaluated first. */
+  double critical_path_time;
+
   /* Identifier for the operation being performed. */
   OperationCode opcode;
   int name_tag;
@@ -479,6 +479,7 @@ static void switch_keys_direction(Curve *cu, Nurb *actnu)
   int a;
 
   LISTBASE_FOREACH (KeyBlock *, currkey, &cu->key->block) {
+    BKE_keyblock_data_ensure_mutable(currkey);
     fp = static_cast<float *>(currkey->data);
 
     LISTBASE_FOREACH (Nurb *, nu, nubase) {
@@ -880,9 +881,7 @@ static void calc_shapeKeys(Object *obedit, ListBase *newnurbs)
     }
 
     currkey->totelem = totvert;
-    if (currkey->data) {
-      MEM_freeN(currkey->data);
-    }
+    BKE_keyblock_data_free(currkey);
     currkey->data = newkey;
   }
 
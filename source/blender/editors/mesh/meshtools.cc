@@ -427,9 +427,7 @@ int ED_mesh_join_objects_exec(bContext *C, wmOperator *op)
 
     /* for all keys in old block, clear data-arrays */
     LISTBASE_FOREACH (KeyBlock *, kb, &key->block) {
-      if (kb->data) {
-        MEM_freeN(kb->data);
-      }
+      BKE_keyblock_data_free(kb);
       kb->data = MEM_callocN(sizeof(float[3]) * totvert, "join_shapekey");
       kb->totelem = totvert;
     }
@@ -188,6 +188,7 @@ static bool object_shape_key_mirror(
   if (kb) {
     char *tag_elem = static_cast<char *>(
         MEM_callocN(sizeof(char) * kb->totelem, "shape_key_mirror"));
+    BKE_keyblock_data_ensure_mutable(kb);
 
     if (ob->type == OB_MESH) {
       Mesh *mesh = static_cast<Mesh *>(ob->data);
@@ -82,8 +82,6 @@ typedef struct CacheFile {
   /** The frame offset to subtract. */
   float frame_offset;
 
-  char _pad[4];
-
   /** Animation flag. */
   short flag;
 
@@ -105,6 +103,12 @@ typedef struct CacheFile {
   /** Size in megabytes for the prefetch cache used by the Cycles Procedural. */
   int prefetch_cache_size;
 
+  /**
+   * Number of frames from the current one to keep in the prefetch cache of the Cycles Procedural,
+   * reading the next ones in the background. Zero loads all frames at once.
+   */
+  int prefetch_frames;
+
   /** Index of the currently selected layer in the UI, starts at 1. */
   int active_layer;
 
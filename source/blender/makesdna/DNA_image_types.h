@@ -134,6 +134,10 @@ typedef struct Image_Runtime {
   /** \brief Partial update user for GPUTextures stored inside the Image. */
   struct PartialUpdateUser *partial_update_user;
 
+  /** Incremented when the image is marked as updated, to detect changes of its buffers. */
+  int update_count;
+  char _pad0[4];
+
   /* Compositor viewer might be translated, and that translation will be stored in this runtime
    * vector by the compositor so that the editor draw code can draw the image translated. */
   float backdrop_offset[2];
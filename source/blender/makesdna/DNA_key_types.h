@@ -15,6 +15,8 @@
 #include "DNA_defs.h"
 #include "DNA_listBase.h"
 
+#include "BLI_implicit_sharing.h"
+
 struct AnimData;
 struct Ipo;
 
@@ -45,6 +47,11 @@ typedef struct KeyBlock {
 
   /** array of shape key values, size is `(Key->elemsize * KeyBlock->totelem)` */
   void *data;
+  /**
+   * Run-time data that allows sharing `data` with evaluated copies of the key.
+   * Null when the array has never been shared.
+   */
+  const ImplicitSharingInfoHandle *data_sharing_info;
   /** MAX_NAME (unique name, user assigned) */
   char name[64];
   /** MAX_VGROUP_NAME (optional vertex group), array gets allocated into 'weights' when set */
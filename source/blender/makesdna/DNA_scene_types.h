@@ -829,8 +829,15 @@ typedef struct RenderData {
   /** Device to use for compositor engine. */
   int compositor_device; /* eCompositorDevice */
 
-  /** Precision used by the GPU execution of the compositor tree. */
+  /** Precision used by the execution of the compositor tree. */
   int compositor_precision; /* eCompositorPrecision */
+
+  /**
+   * Memory budget in megabytes for the intermediate results of the CPU execution of the
+   * compositor tree, above which images are processed in tiles. Zero for no limit.
+   */
+  int compositor_memory_limit;
+  char _pad10[4];
 } RenderData;
 
 /** #RenderData::quality_flag */
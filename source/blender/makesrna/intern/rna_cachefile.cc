@@ -307,6 +307,16 @@ static void rna_def_cachefile(BlenderRNA *brna)
       "fit within the limit, rendering is aborted");
   RNA_def_property_update(prop, 0, "rna_CacheFile_update");
 
+  prop = RNA_def_property(srna, "prefetch_frames", PROP_INT, PROP_NONE);
+  RNA_def_property_range(prop, 0, MAXFRAME);
+  RNA_def_property_ui_range(prop, 0, 1000, 1, -1);
+  RNA_def_property_ui_text(
+      prop,
+      "Prefetch Frames",
+      "Number of frames from the current frame that the Cycles Procedural keeps in its cache, "
+      "loading the next frames in the background within the cache size (0 to load all frames)");
+  RNA_def_property_update(prop, 0, "rna_CacheFile_update");
+
   /* ----------------- Axis Conversion ----------------- */
 
   prop = RNA_def_property(srna, "forward_axis", PROP_ENUM, PROP_NONE);
@@ -569,6 +569,9 @@ static void rna_ShapeKey_data_begin(CollectionPropertyIterator *iter, PointerRNA
   KeyBlock *kb = (KeyBlock *)ptr->data;
   int tot = kb->totelem, size = key->elemsize;
 
+  /* Points give write access to the data, it can't be shared anymore. */
+  BKE_keyblock_data_ensure_mutable(kb);
+
   if (GS(key->from->name) == ID_CU_LEGACY && tot > 0) {
     Curve *cu = (Curve *)key->from;
     StructRNA *type = nullptr;
@@ -640,6 +643,7 @@ bool rna_ShapeKey_data_lookup_int(PointerRNA *ptr, int index, PointerRNA *r_ptr)
   Key *key = rna_ShapeKey_find_key(ptr->owner_id);
   KeyBlock *kb = (KeyBlock *)ptr->data;
   int elemsize = key->elemsize;
+  BKE_keyblock_data_ensure_mutable(kb);
   char *databuf = static_cast<char *>(kb->data);
 
   memset(r_ptr, 0, sizeof(*r_ptr));
@@ -679,6 +683,7 @@ static void rna_ShapeKey_points_begin(CollectionPropertyIterator *iter, PointerR
     /* Legacy curves have only curve points and bezier points. */
     tot = 0;
   }
+  BKE_keyblock_data_ensure_mutable(kb);
   rna_iterator_array_begin(iter, (void *)kb->data, key->elemsize, tot, 0, nullptr);
 }
 
@@ -701,6 +706,7 @@ bool rna_ShapeKey_points_lookup_int(PointerRNA *ptr, int index, PointerRNA *r_pt
   Key *key = rna_ShapeKey_find_key(ptr->owner_id);
   KeyBlock *kb = (KeyBlock *)ptr->data;
   int elemsize = key->elemsize;
+  BKE_keyblock_data_ensure_mutable(kb);
   char *databuf = static_cast<char *>(kb->data);
 
   memset(r_ptr, 0, sizeof(*r_ptr));
@@ -7499,6 +7499,17 @@ static void rna_def_scene_render_data(BlenderRNA *brna)
       prop, "Compositor Precision", "The precision of compositor intermediate result");
   RNA_def_property_update(prop, NC_NODE | ND_DISPLAY, "rna_Scene_compositor_update");
 
+  prop = RNA_def_property(srna, "compositor_memory_limit", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, nullptr, "compositor_memory_limit");
+  RNA_def_property_range(prop, 0, INT_MAX);
+  RNA_def_property_ui_range(prop, 0, 1024 * 1024, 256, -1);
+  RNA_def_property_ui_text(
+      prop,
+      "Compositor Memory Limit",
+      "Maximum memory in megabytes used by intermediate results of the CPU compositor, images "
+      "needing more are processed in tiles (0 for no limit)");
+  RNA_def_property_update(prop, NC_NODE | ND_DISPLAY, "rna_Scene_compositor_update");
+
   /* Nestled Data. */
   /* *** Non-Animated *** */
   RNA_define_animate_sdna(false);
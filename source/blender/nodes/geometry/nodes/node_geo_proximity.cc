@@ -213,53 +213,87 @@ class ProximityFunction : public mf::MultiFunction {
     MutableSpan<bool> is_valid_span = params.uninitialized_single_output_if_required<bool>(
         4, "Is Valid");
 
-    mask.foreach_index([&](const int i) {
-      const float3 sample_position = sample_positions[i];
-      const int sample_id = sample_ids[i];
-      const int group_index = group_indices_.index_of_try(sample_id);
-      if (group_index == -1) {
-        if (!positions.is_empty()) {
-          positions[i] = float3(0, 0, 0);
-        }
-        if (!is_valid_span.is_empty()) {
-          is_valid_span[i] = false;
-        }
-        if (!distances.is_empty()) {
-          distances[i] = 0.0f;
-        }
-        return;
-      }
-      const BVHTrees &trees = bvh_trees_[group_index];
-      BVHTreeNearest nearest;
-      /* Take mesh and pointcloud bvh tree into account. The final result is the closer of the two.
-       * First first bvhtree query will set `nearest.dist_sq` which is then passed into the second
-       * query as a maximum distance. */
-      nearest.dist_sq = FLT_MAX;
-      if (trees.mesh_bvh.tree != nullptr) {
-        BLI_bvhtree_find_nearest(trees.mesh_bvh.tree,
-                                 sample_position,
-                                 &nearest,
-                                 trees.mesh_bvh.nearest_callback,
-                                 const_cast<BVHTreeFromMesh *>(&trees.mesh_bvh));
-      }
-      if (trees.pointcloud_bvh.tree != nullptr) {
-        BLI_bvhtree_find_nearest(trees.pointcloud_bvh.tree,
-                                 sample_position,
-                                 &nearest,
-                                 trees.pointcloud_bvh.nearest_callback,
-                                 const_cast<BVHTreeFromPointCloud *>(&trees.pointcloud_bvh));
-      }
+    /* Group the samples by tree, the last group contains the samples with an unknown id. */
+    IndexMaskMemory memory;
+    Array<IndexMask> group_masks(bvh_trees_.size() + 1);
+    if (const std::optional<int> sample_id = sample_ids.get_if_single()) {
+      const int group_index = group_indices_.index_of_try(*sample_id);
+      group_masks[group_index == -1 ? bvh_trees_.size() : group_index] = mask;
+    }
+    else {
+      IndexMask::from_groups<int>(
+          mask,
+          memory,
+          [&](const int i) {
+            const int group_index = group_indices_.index_of_try(sample_ids[i]);
+            return group_index == -1 ? int(bvh_trees_.size()) : group_index;
+          },
+          group_masks);
+    }
 
+    group_masks.last().foreach_index([&](const int i) {
       if (!positions.is_empty()) {
-        positions[i] = nearest.co;
+        positions[i] = float3(0, 0, 0);
       }
       if (!is_valid_span.is_empty()) {
-        is_valid_span[i] = true;
+        is_valid_span[i] = false;
       }
       if (!distances.is_empty()) {
-        distances[i] = std::sqrt(nearest.dist_sq);
+        distances[i] = 0.0f;
       }
     });
+
+    Array<BVHTreeNearest> nearest;
+    for (const int group_index : bvh_trees_.index_range()) {
+      const IndexMask &group_mask = group_masks[group_index];
+      if (group_mask.is_empty()) {
+        continue;
+      }
+      const BVHTrees &trees = bvh_trees_[group_index];
+      nearest.reinitialize(group_mask.size());
+      for (BVHTreeNearest &item : nearest) {
+        item.dist_sq = FLT_MAX;
+      }
+      /* Take mesh and pointcloud bvh tree into account. The final result is the closer of the
+       * two. The first query sets `nearest.dist_sq` which is then used by the second query as a
+       * maximum distance. */
+      if (trees.mesh_bvh.tree != nullptr) {
+        BKE_bvhtree_find_nearest_batch(trees.mesh_bvh.tree,
+                                       trees.mesh_bvh.nearest_callback,
+                                       const_cast<BVHTreeFromMesh *>(&trees.mesh_bvh),
+                                       group_mask,
+                                       sample_positions,
+                                       nearest);
+      }
+      if (trees.pointcloud_bvh.tree != nullptr) {
+        BKE_bvhtree_find_nearest_batch(trees.pointcloud_bvh.tree,
+                                       trees.pointcloud_bvh.nearest_callback,
+                                       const_cast<BVHTreeFromPointCloud *>(&trees.pointcloud_bvh),
+                                       group_mask,
+                                       sample_positions,
+                                       nearest);
+      }
+
+      group_mask.foreach_index([&](const int i, const int pos) {
+        if (!positions.is_empty()) {
+          positions[i] = nearest[pos].co;
+        }
+        if (!is_valid_span.is_empty()) {
+          is_valid_span[i] = true;
+        }
+        if (!distances.is_empty()) {
+          distances[i] = std::sqrt(nearest[pos].dist_sq);
+        }
+      });
+    }
+  }
+
+  ExecutionHints get_execution_hints() const override
+  {
+    /* Don't slice the mask, the batched nearest queries are sorted together and threaded. */
+    ExecutionHints hints;
+    hints.min_grain_size = std::numeric_limits<int64_t>::max();
+    return hints;
   }
 };
 
@@ -109,22 +109,19 @@ static void raycast_to_mesh(const IndexMask &mask,
   /* We shouldn't be rebuilding the BVH tree when calling this function in parallel. */
   BLI_assert(tree_data.cached);
 
-  mask.foreach_index([&](const int i) {
-    const float ray_length = ray_lengths[i];
-    const float3 ray_origin = ray_origins[i];
-    const float3 ray_direction = ray_directions[i];
-
-    BVHTreeRayHit hit;
-    hit.index = -1;
-    hit.dist = ray_length;
-    if (BLI_bvhtree_ray_cast(tree_data.tree,
-                             ray_origin,
-                             ray_direction,
-                             0.0f,
-                             &hit,
+  Array<BVHTreeRayHit> hits(mask.size());
+  mask.foreach_index([&](const int i, const int pos) { hits[pos].dist = ray_lengths[i]; });
+  BKE_bvhtree_ray_cast_batch(tree_data.tree,
                              tree_data.raycast_callback,
-                             &tree_data) != -1)
-    {
+                             &tree_data,
+                             mask,
+                             ray_origins,
+                             ray_directions,
+                             hits);
+
+  mask.foreach_index([&](const int i, const int pos) {
+    const BVHTreeRayHit &hit = hits[pos];
+    if (hit.index != -1) {
       if (!r_hit.is_empty()) {
         r_hit[i] = hit.index >= 0;
       }
@@ -156,7 +153,7 @@ static void raycast_to_mesh(const IndexMask &mask,
         r_hit_normals[i] = float3(0.0f, 0.0f, 0.0f);
       }
       if (!r_hit_distances.is_empty()) {
-        r_hit_distances[i] = ray_length;
+        r_hit_distances[i] = ray_lengths[i];
       }
     }
   });
@@ -202,6 +199,14 @@ class RaycastFunction : public mf::MultiFunction {
                     params.uninitialized_single_output_if_required<float3>(5, "Hit Normal"),
                     params.uninitialized_single_output_if_required<float>(6, "Distance"));
   }
+
+  ExecutionHints get_execution_hints() const override
+  {
+    /* Pass all rays at once, the batched ray-cast sorts and threads them itself. */
+    ExecutionHints hints;
+    hints.min_grain_size = std::numeric_limits<int64_t>::max();
+    return hints;
+  }
 };
 
 static void node_geo_exec(GeoNodeExecParams params)
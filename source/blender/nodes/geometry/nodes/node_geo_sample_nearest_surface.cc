@@ -147,35 +147,64 @@ class SampleNearestSurfaceFunction : public mf::MultiFunction {
     MutableSpan<bool> is_valid_span = params.uninitialized_single_output_if_required<bool>(
         4, "Is Valid");
 
-    mask.foreach_index([&](const int i) {
-      const float3 position = positions[i];
-      const int sample_id = sample_ids[i];
-      const int group_index = group_indices_.index_of_try(sample_id);
-      if (group_index == -1) {
-        triangle_index[i] = -1;
-        sample_position[i] = float3(0, 0, 0);
-        if (!is_valid_span.is_empty()) {
-          is_valid_span[i] = false;
-        }
-        return;
-      }
-      const BVHTreeFromMesh &bvh = bvh_trees_[group_index];
-      BVHTreeNearest nearest;
-      nearest.dist_sq = FLT_MAX;
-      BLI_bvhtree_find_nearest(
-          bvh.tree, position, &nearest, bvh.nearest_callback, const_cast<BVHTreeFromMesh *>(&bvh));
-      triangle_index[i] = nearest.index;
-      sample_position[i] = nearest.co;
+    /* Group the samples by tree, the last group contains the samples with an unknown id. */
+    IndexMaskMemory memory;
+    Array<IndexMask> group_masks(bvh_trees_.size() + 1);
+    if (const std::optional<int> sample_id = sample_ids.get_if_single()) {
+      const int group_index = group_indices_.index_of_try(*sample_id);
+      group_masks[group_index == -1 ? bvh_trees_.size() : group_index] = mask;
+    }
+    else {
+      IndexMask::from_groups<int>(
+          mask,
+          memory,
+          [&](const int i) {
+            const int group_index = group_indices_.index_of_try(sample_ids[i]);
+            return group_index == -1 ? int(bvh_trees_.size()) : group_index;
+          },
+          group_masks);
+    }
+
+    group_masks.last().foreach_index([&](const int i) {
+      triangle_index[i] = -1;
+      sample_position[i] = float3(0, 0, 0);
       if (!is_valid_span.is_empty()) {
-        is_valid_span[i] = true;
+        is_valid_span[i] = false;
       }
     });
+
+    Array<BVHTreeNearest> nearest;
+    for (const int group_index : bvh_trees_.index_range()) {
+      const IndexMask &group_mask = group_masks[group_index];
+      if (group_mask.is_empty()) {
+        continue;
+      }
+      const BVHTreeFromMesh &bvh = bvh_trees_[group_index];
+      nearest.reinitialize(group_mask.size());
+      for (BVHTreeNearest &item : nearest) {
+        item.dist_sq = FLT_MAX;
+      }
+      BKE_bvhtree_find_nearest_batch(bvh.tree,
+                                     bvh.nearest_callback,
+                                     const_cast<BVHTreeFromMesh *>(&bvh),
+                                     group_mask,
+                                     positions,
+                                     nearest);
+      group_mask.foreach_index([&](const int i, const int pos) {
+        triangle_index[i] = nearest[pos].index;
+        sample_position[i] = nearest[pos].co;
+        if (!is_valid_span.is_empty()) {
+          is_valid_span[i] = true;
+        }
+      });
+    }
   }
 
   ExecutionHints get_execution_hints() const override
   {
+    /* The batched queries sort the whole mask spatially and run in parallel themselves. */
     ExecutionHints hints;
-    hints.min_grain_size = 512;
+    hints.min_grain_size = std::numeric_limits<int64_t>::max();
     return hints;
   }
 };
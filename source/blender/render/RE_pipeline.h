@@ -112,6 +112,10 @@ typedef struct RenderResult {
    * TODO: Make it atomic. Currently it is not to allow shallow copying. */
   int user_counter;
 
+  /* Identifier of the result within the session, new results get a new identifier. Used to detect
+   * whether the result changed, since its memory address may be reused. */
+  uint64_t session_uid;
+
   /* target image size */
   int rectx, recty;
 
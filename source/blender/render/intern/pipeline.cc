@@ -912,6 +912,7 @@ void RE_InitState(Render *re,
     /* make empty render result, so display callbacks can initialize */
     render_result_free(re->result);
     re->result = MEM_cnew<RenderResult>("new render result");
+    re->result->session_uid = render_result_session_uid_generate();
     re->result->rectx = re->rectx;
     re->result->recty = re->recty;
     render_result_view_new(re->result, "");
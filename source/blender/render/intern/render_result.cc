@@ -6,6 +6,7 @@
  * \ingroup render
  */
 
+#include <atomic>
 #include <cerrno>
 #include <cstdio>
 #include <cstdlib>
@@ -271,6 +272,12 @@ RenderPass *render_layer_add_pass(RenderResult *rr,
   return rpass;
 }
 
+uint64_t render_result_session_uid_generate()
+{
+  static std::atomic<uint64_t> last_session_uid = 0;
+  return ++last_session_uid;
+}
+
 RenderResult *render_result_new(Render *re,
                                 const rcti *partrct,
                                 const char *layername,
@@ -288,6 +295,7 @@ RenderResult *render_result_new(Render *re,
   }
 
   rr = MEM_cnew<RenderResult>("new render result");
+  rr->session_uid = render_result_session_uid_generate();
   rr->rectx = rectx;
   rr->recty = recty;
 
@@ -708,6 +716,7 @@ RenderResult *render_result_new_from_exr(
     void *exrhandle, const char *colorspace, bool predivide, int rectx, int recty)
 {
   RenderResult *rr = MEM_cnew<RenderResult>(__func__);
+  rr->session_uid = render_result_session_uid_generate();
   const char *to_colorspace = IMB_colormanagement_role_colorspace_name_get(
       COLOR_ROLE_SCENE_LINEAR);
   const char *data_colorspace = IMB_colormanagement_role_colorspace_name_get(COLOR_ROLE_DATA);
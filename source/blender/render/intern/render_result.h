@@ -66,6 +66,11 @@ void render_result_merge(struct RenderResult *rr, struct RenderResult *rrpart);
 
 void render_result_clone_passes(struct Render *re, struct RenderResult *rr, const char *viewname);
 
+/**
+ * Generate a new #RenderResult.session_uid.
+ */
+uint64_t render_result_session_uid_generate();
+
 /* Free */
 
 void render_result_free(struct RenderResult *rr);
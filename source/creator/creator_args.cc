@@ -35,6 +35,7 @@
 #  endif
 
 #  include "BKE_appdir.hh"
+#  include "BKE_blender.hh"
 #  include "BKE_blender_cli_command.hh"
 #  include "BKE_blender_version.h"
 #  include "BKE_blendfile.hh"
@@ -69,6 +70,7 @@
 #  endif
 
 #  include "DEG_depsgraph.hh"
+#  include "DEG_depsgraph_debug.hh"
 
 #  include "WM_types.hh"
 
@@ -737,6 +739,7 @@ static void print_help(bArgs *ba, bool all)
     BLI_args_print_arg_doc(ba, "--debug-cycles");
   }
   BLI_args_print_arg_doc(ba, "--debug-memory");
+  BLI_args_print_arg_doc(ba, "--debug-memory-profile");
   BLI_args_print_arg_doc(ba, "--debug-jobs");
   BLI_args_print_arg_doc(ba, "--debug-python");
   BLI_args_print_arg_doc(ba, "--debug-depsgraph");
@@ -747,6 +750,7 @@ static void print_help(bArgs *ba, bool all)
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-time");
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-pretty");
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-uid");
+  BLI_args_print_arg_doc(ba, "--debug-depsgraph-trace");
   BLI_args_print_arg_doc(ba, "--debug-ghost");
   BLI_args_print_arg_doc(ba, "--debug-wintab");
   BLI_args_print_arg_doc(ba, "--debug-gpu");
@@ -784,6 +788,8 @@ static void print_help(bArgs *ba, bool all)
   BLI_args_print_arg_doc(ba, "--app-template");
   BLI_args_print_arg_doc(ba, "--factory-startup");
   BLI_args_print_arg_doc(ba, "--enable-event-simulate");
+  BLI_args_print_arg_doc(ba, "--memory-huge-pages");
+  BLI_args_print_arg_doc(ba, "--memory-numa-interleave");
   PRINT("\n");
   BLI_args_print_arg_doc(ba, "--env-system-datafiles");
   BLI_args_print_arg_doc(ba, "--env-system-scripts");
@@ -1304,6 +1310,23 @@ static int arg_handle_debug_mode_generic_set(int /*argc*/, const char ** /*argv*
   return 0;
 }
 
+static const char arg_handle_debug_depsgraph_trace_doc[] =
+    "<filepath>\n"
+    "\tRecord the time spent evaluating dependency graph operations and modifiers on each "
+    "thread.\n"
+    "\tThe trace is written on exit in the Chrome trace event format (viewable with Perfetto).";
+static int arg_handle_debug_depsgraph_trace(int argc, const char **argv, void * /*data*/)
+{
+  const char *arg_id = "--debug-depsgraph-trace";
+  if (argc > 1) {
+    DEG_debug_trace_begin(argv[1]);
+    BKE_blender_atexit_register([](void * /*user_data*/) { DEG_debug_trace_end(); }, nullptr);
+    return 1;
+  }
+  fprintf(stderr, "\nError: '%s' no args given.\n", arg_id);
+  return 0;
+}
+
 static const char arg_handle_debug_mode_io_doc[] =
     "\n\t"
     "Enable debug messages for I/O (Collada, ...).";
@@ -1359,6 +1382,24 @@ static int arg_handle_debug_mode_memory_set(int /*argc*/, const char ** /*argv*/
   return 0;
 }
 
+static const char arg_handle_debug_mode_memory_profile_set_doc[] =
+    "<filepath>\n"
+    "\tSample allocations to estimate memory usage per allocation name, with little overhead.\n"
+    "\tThe 'Memory Statistics' operator prints the estimate, and writes a heap profile\n"
+    "\tfor 'pprof' to <filepath> (Linux and macOS only).";
+static int arg_handle_debug_mode_memory_profile_set(int argc,
+                                                    const char **argv,
+                                                    void * /*data*/)
+{
+  if (argc > 1) {
+    /* Sample about every 512 KiB, which gives a good estimate of large allocations. */
+    MEM_sampling_profiler_start(512 * 1024, argv[1]);
+    return 1;
+  }
+  fprintf(stderr, "\nError: you must specify a filepath after '%s'.\n", argv[0]);
+  return 0;
+}
+
 static const char arg_handle_debug_value_set_doc[] =
     "<value>\n"
     "\tSet debug value of <value> on startup.";
@@ -1948,6 +1989,30 @@ static int arg_handle_threads_set(int argc, const char **argv, void * /*data*/)
   return 0;
 }
 
+static const char arg_handle_memory_large_allocation_set_doc_huge_pages[] =
+    "\n\t"
+    "Back large memory allocations with transparent huge pages (Linux only).\n"
+    "\tThis can speed up processing of large meshes and images.";
+static const char arg_handle_memory_large_allocation_set_doc_numa_interleave[] =
+    "\n\t"
+    "Spread the pages of large memory allocations over all NUMA nodes (Linux only).\n"
+    "\tThis can speed up multi-threaded processing on systems with multiple CPU sockets.";
+static int arg_handle_memory_large_allocation_set(int /*argc*/,
+                                                  const char **argv,
+                                                  void * /*data*/)
+{
+  static bool use_huge_pages = false;
+  static bool use_numa_interleave = false;
+  if (STREQ(argv[0], "--memory-huge-pages")) {
+    use_huge_pages = true;
+  }
+  else {
+    use_numa_interleave = true;
+  }
+  MEM_use_large_allocation_advice(use_huge_pages, use_numa_interleave);
+  return 0;
+}
+
 static const char arg_handle_verbosity_set_doc[] =
     "<verbose>\n"
     "\tSet the logging verbosity level for debug messages that support it.";
@@ -2554,6 +2619,16 @@ void main_args_setup(bContext *C, bArgs *ba, bool all)
                nullptr);
 
   BLI_args_add(ba, "-t", "--threads", CB(arg_handle_threads_set), nullptr);
+  BLI_args_add(ba,
+               nullptr,
+               "--memory-huge-pages",
+               CB_EX(arg_handle_memory_large_allocation_set, huge_pages),
+               nullptr);
+  BLI_args_add(ba,
+               nullptr,
+               "--memory-numa-interleave",
+               CB_EX(arg_handle_memory_large_allocation_set, numa_interleave),
+               nullptr);
 
   /* Include in the environment pass so it's possible display errors initializing subsystems,
    * especially `bpy.appdir` since it's useful to show errors finding paths on startup. */
@@ -2667,6 +2742,11 @@ void main_args_setup(bContext *C, bArgs *ba, bool all)
     BLI_args_add(ba, nullptr, "--debug-cycles", CB(arg_handle_debug_mode_cycles), nullptr);
   }
   BLI_args_add(ba, nullptr, "--debug-memory", CB(arg_handle_debug_mode_memory_set), nullptr);
+  BLI_args_add(ba,
+               nullptr,
+               "--debug-memory-profile",
+               CB(arg_handle_debug_mode_memory_profile_set),
+               nullptr);
 
   BLI_args_add(ba, nullptr, "--debug-value", CB(arg_handle_debug_value_set), nullptr);
   BLI_args_add(ba,
@@ -2726,6 +2806,8 @@ void main_args_setup(bContext *C, bArgs *ba, bool all)
                "--debug-depsgraph-uid",
                CB_EX(arg_handle_debug_mode_generic_set, depsgraph_uid),
                (void *)G_DEBUG_DEPSGRAPH_UID);
+  BLI_args_add(
+      ba, nullptr, "--debug-depsgraph-trace", CB(arg_handle_debug_depsgraph_trace), nullptr);
   BLI_args_add(ba,
                nullptr,
                "--debug-gpu-force-workarounds",
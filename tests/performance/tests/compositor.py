@@ -0,0 +1,241 @@
+# SPDX-FileCopyrightText: 2024 Blender Authors
+#
+# SPDX-License-Identifier: Apache-2.0
+
+import api
+
+RESOLUTIONS = ((1280, 720), (1920, 1080), (3840, 2160))
+
+OPERATIONS_LOG = "compositor.operations"
+
+
+def _run(args):
+    import bpy
+    import os
+    import tempfile
+    import time
+
+    scene = bpy.context.scene
+    scene.render.resolution_x, scene.render.resolution_y = args['resolution']
+    scene.render.resolution_percentage = 100
+    scene.render.compositor_device = 'CPU'
+    scene.use_nodes = True
+
+    tree = scene.node_tree
+    nodes = tree.nodes
+    links = tree.links
+
+    def clear_tree():
+        nodes.clear()
+        return nodes.new('CompositorNodeComposite')
+
+    def new_image_node(generated_type):
+        # Generated images don't need any file, and are rendered once at the render size.
+        image = bpy.data.images.new(generated_type, *args['resolution'], alpha=True, float_buffer=True)
+        image.generated_type = generated_type
+        node = nodes.new('CompositorNodeImage')
+        node.image = image
+        return node
+
+    def build_blur_stack(composite):
+        image = new_image_node('COLOR_GRID')
+
+        blur = nodes.new('CompositorNodeBlur')
+        blur.filter_type = 'GAUSS'
+        blur.size_x = blur.size_y = 30
+        links.new(image.outputs['Image'], blur.inputs['Image'])
+
+        fast_blur = nodes.new('CompositorNodeBlur')
+        fast_blur.filter_type = 'FAST_GAUSS'
+        fast_blur.size_x = fast_blur.size_y = 60
+        links.new(blur.outputs['Image'], fast_blur.inputs['Image'])
+
+        bokeh_image = nodes.new('CompositorNodeBokehImage')
+        bokeh_blur = nodes.new('CompositorNodeBokehBlur')
+        bokeh_blur.inputs['Size'].default_value = 2.0
+        links.new(fast_blur.outputs['Image'], bokeh_blur.inputs['Image'])
+        links.new(bokeh_image.outputs['Image'], bokeh_blur.inputs['Bokeh'])
+
+        glare = nodes.new('CompositorNodeGlare')
+        glare.glare_type = 'FOG_GLOW'
+        glare.size = 8
+        links.new(bokeh_blur.outputs['Image'], glare.inputs['Image'])
+
+        links.new(glare.outputs['Image'], composite.inputs['Image'])
+
+    def build_keying(composite):
+        foreground = new_image_node('COLOR_GRID')
+        background = new_image_node('UV_GRID')
+
+        keying = nodes.new('CompositorNodeKeying')
+        keying.inputs['Key Color'].default_value = (0.0, 1.0, 0.0, 1.0)
+        keying.blur_pre = 2
+        keying.blur_post = 2
+        keying.dilate_distance = 1
+        keying.feather_distance = 3
+        links.new(foreground.outputs['Image'], keying.inputs['Image'])
+
+        alpha_over = nodes.new('CompositorNodeAlphaOver')
+        links.new(background.outputs['Image'], alpha_over.inputs[1])
+        links.new(keying.outputs['Image'], alpha_over.inputs[2])
+
+        links.new(alpha_over.outputs['Image'], composite.inputs['Image'])
+
+    def build_defocus(composite):
+        image = new_image_node('COLOR_GRID')
+
+        # Use a channel of the image as depth, it varies a lot over the image.
+        separate = nodes.new('CompositorNodeSeparateColor')
+        links.new(image.outputs['Image'], separate.inputs['Image'])
+        depth = nodes.new('CompositorNodeMath')
+        depth.operation = 'MULTIPLY_ADD'
+        depth.inputs[1].default_value = 20.0
+        depth.inputs[2].default_value = 1.0
+        links.new(separate.outputs['Red'], depth.inputs[0])
+
+        defocus = nodes.new('CompositorNodeDefocus')
+        defocus.use_zbuffer = True
+        defocus.use_preview = False
+        defocus.f_stop = 2.0
+        defocus.blur_max = 64.0
+        links.new(image.outputs['Image'], defocus.inputs['Image'])
+        links.new(depth.outputs['Value'], defocus.inputs['Z'])
+
+        links.new(defocus.outputs['Image'], composite.inputs['Image'])
+
+    def build_multilayer_exr_merge(composite):
+        # Write a multi-layer EXR with several passes first, then benchmark merging them.
+        base_path = os.path.join(tempfile.mkdtemp(), "passes_")
+        pass_sources = {'Diffuse': 'COLOR_GRID', 'Glossy': 'UV_GRID', 'Emission': 'BLANK', 'Depth': 'COLOR_GRID'}
+
+        file_output = nodes.new('CompositorNodeOutputFile')
+        file_output.format.file_format = 'OPEN_EXR_MULTILAYER'
+        file_output.format.color_depth = '32'
+        file_output.base_path = base_path
+        file_output.layer_slots.clear()
+        for pass_name, generated_type in pass_sources.items():
+            file_output.layer_slots.new(pass_name)
+            links.new(new_image_node(generated_type).outputs['Image'], file_output.inputs[pass_name])
+        bpy.ops.render.render()
+
+        composite = clear_tree()
+        image = nodes.new('CompositorNodeImage')
+        image.image = bpy.data.images.load(base_path + "%04d.exr" % scene.frame_current)
+        diffuse, glossy, emission, depth = (image.outputs[name] for name in pass_sources)
+
+        add = nodes.new('CompositorNodeMixRGB')
+        add.blend_type = 'ADD'
+        links.new(diffuse, add.inputs[1])
+        links.new(glossy, add.inputs[2])
+
+        screen = nodes.new('CompositorNodeMixRGB')
+        screen.blend_type = 'SCREEN'
+        links.new(add.outputs['Image'], screen.inputs[1])
+        links.new(emission, screen.inputs[2])
+
+        z_combine = nodes.new('CompositorNodeZcombine')
+        links.new(screen.outputs['Image'], z_combine.inputs[0])
+        links.new(depth, z_combine.inputs[1])
+        links.new(glossy, z_combine.inputs[2])
+        links.new(diffuse, z_combine.inputs[3])
+
+        links.new(z_combine.outputs['Image'], composite.inputs['Image'])
+
+    builders = {
+        'blur_stack': build_blur_stack,
+        'keying': build_keying,
+        'defocus': build_defocus,
+        'multilayer_exr_merge': build_multilayer_exr_merge,
+    }
+    builders[args['tree']](clear_tree())
+
+    # Render once first, so that images are loaded and generated.
+    bpy.ops.render.render()
+
+    test_time_start = time.time()
+    measured_times = []
+
+    min_measurements = 3
+    max_measurements = 20
+    timeout = 10
+
+    while True:
+        start_time = time.time()
+        bpy.ops.render.render()
+        elapsed_time = time.time() - start_time
+        measured_times.append(elapsed_time)
+
+        if len(measured_times) >= min_measurements and test_time_start + timeout < time.time():
+            break
+        if len(measured_times) >= max_measurements:
+            break
+
+    average_time = sum(measured_times) / len(measured_times)
+    # Include the first render, the operations are logged for all of them.
+    result = {'time': average_time, 'num_renders': len(measured_times) + 1}
+    return result
+
+
+def _parse_peak_memory(lines):
+    # Render stats are printed in background mode, with the peak memory of guarded allocations in
+    # the process: "Fra:1 Mem:12.00M (Peak 40.00M) | Time:00:00.10 | Compositing".
+    prefix = "(Peak "
+    peak_memory = None
+    for line in lines:
+        offset = line.find(prefix)
+        if offset == -1:
+            continue
+        megabytes = float(line[offset + len(prefix):].split('M')[0])
+        peak_memory = max(peak_memory or 0.0, megabytes * 1024 * 1024)
+    return peak_memory
+
+
+def _parse_operation_times(lines, num_renders):
+    # Operations render times from the compositor log:
+    # "INFO (compositor.operations): file:line function: Class | Node | 1920x1080 | 1.234 ms".
+    prefix = f"({OPERATIONS_LOG}):"
+    times = {}
+    for line in lines:
+        offset = line.find(prefix)
+        if offset == -1:
+            continue
+        tokens = line[offset + len(prefix):].split(' | ')
+        if len(tokens) != 4:
+            continue
+        class_name = tokens[0].split(': ')[-1].strip()
+        milliseconds = float(tokens[3].split()[0])
+        times[class_name] = times.get(class_name, 0.0) + milliseconds / 1000.0
+
+    # Average time per render for each type of operation.
+    return {'time_' + class_name: time / num_renders for class_name, time in times.items()}
+
+
+class CompositorTest(api.Test):
+    def __init__(self, tree, resolution):
+        self.tree = tree
+        self.resolution = resolution
+
+    def name(self):
+        return f"{self.tree}_{self.resolution[1]}p"
+
+    def category(self):
+        return "compositor"
+
+    def run(self, env, device_id):
+        args = {'tree': self.tree, 'resolution': self.resolution}
+        blender_args = ['--log', OPERATIONS_LOG, '--log-level', '1']
+        result, lines = env.run_in_blender(_run, args, blender_args)
+        if not result:
+            return result
+
+        num_renders = result.pop('num_renders')
+        peak_memory = _parse_peak_memory(lines)
+        if peak_memory:
+            result['peak_memory'] = peak_memory
+        result.update(_parse_operation_times(lines, num_renders))
+        return result
+
+
+def generate(env):
+    trees = ('blur_stack', 'keying', 'defocus', 'multilayer_exr_merge')
+    return [CompositorTest(tree, resolution) for tree in trees for resolution in RESOLUTIONS]
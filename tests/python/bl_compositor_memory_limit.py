@@ -0,0 +1,90 @@
+# SPDX-FileCopyrightText: 2024 Blender Authors
+#
+# SPDX-License-Identifier: Apache-2.0
+
+# ./blender.bin --background --python tests/python/bl_compositor_memory_limit.py -- --verbose
+import bpy
+import os
+import tempfile
+import unittest
+
+
+class TestCompositorMemoryLimit(unittest.TestCase):
+    """
+    Compare the output of the CPU compositor rendered in tiles because of the memory limit with
+    the output rendered in full frame.
+    """
+
+    def setUp(self):
+        bpy.ops.wm.read_factory_settings(use_empty=True)
+        self.tempdir = tempfile.TemporaryDirectory()
+
+        scene = bpy.context.scene
+        scene.render.resolution_x = 640
+        scene.render.resolution_y = 480
+        scene.render.resolution_percentage = 100
+        scene.render.compositor_device = 'CPU'
+        scene.render.image_settings.file_format = 'OPEN_EXR'
+        scene.render.image_settings.color_depth = '32'
+        scene.use_nodes = True
+
+        image = bpy.data.images.new("Input", 640, 480, float_buffer=True)
+        image.generated_type = 'COLOR_GRID'
+
+        tree = scene.node_tree
+        tree.nodes.clear()
+        image_node = tree.nodes.new("CompositorNodeImage")
+        image_node.image = image
+
+        # Not tiled, so it is rendered in full before the tiles that read it.
+        blur = tree.nodes.new("CompositorNodeBlur")
+        blur.size_x = 7
+        blur.size_y = 5
+
+        # Row and mix operations, which are tiled.
+        gamma = tree.nodes.new("CompositorNodeGamma")
+        gamma.inputs["Gamma"].default_value = 1.8
+        mix = tree.nodes.new("CompositorNodeMixRGB")
+        mix.blend_type = 'MULTIPLY'
+        mix.inputs["Fac"].default_value = 0.75
+        exposure = tree.nodes.new("CompositorNodeExposure")
+        exposure.inputs["Exposure"].default_value = 0.5
+
+        composite = tree.nodes.new("CompositorNodeComposite")
+
+        tree.links.new(image_node.outputs["Image"], blur.inputs["Image"])
+        tree.links.new(image_node.outputs["Image"], gamma.inputs["Image"])
+        tree.links.new(blur.outputs["Image"], mix.inputs[1])
+        tree.links.new(gamma.outputs["Image"], mix.inputs[2])
+        tree.links.new(mix.outputs["Image"], exposure.inputs["Image"])
+        tree.links.new(exposure.outputs["Image"], composite.inputs["Image"])
+
+    def tearDown(self):
+        self.tempdir.cleanup()
+
+    def render(self, memory_limit):
+        scene = bpy.context.scene
+        scene.render.compositor_memory_limit = memory_limit
+        bpy.ops.render.render()
+
+        filepath = os.path.join(self.tempdir.name, "memory_limit_{:d}.exr".format(memory_limit))
+        bpy.data.images["Render Result"].save_render(filepath, scene=scene)
+        image = bpy.data.images.load(filepath)
+        pixels = image.pixels[:]
+        bpy.data.images.remove(image)
+        return pixels
+
+    def test_tiled_matches_full_frame(self):
+        full_frame = self.render(0)
+        self.assertEqual(len(full_frame), 640 * 480 * 4)
+        # A row of every tiled buffer takes 10 KiB, so these limits give tiles of a few rows up
+        # to a few tens of rows, with a last tile that is smaller than the others.
+        for memory_limit in (1, 3):
+            with self.subTest(memory_limit=memory_limit):
+                self.assertEqual(self.render(memory_limit), full_frame)
+
+
+if __name__ == "__main__":
+    import sys
+    sys.argv = [__file__] + (sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else [])
+    unittest.main()